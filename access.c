@@ -0,0 +1,197 @@
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "predict.h"
+#include "parallel.h"
+
+/**
+ * Access window as found by one thread, before it is stored by column.
+ **/
+struct access_window {
+	uint32_t observer;
+	predict_julian_date_t aos;
+	predict_julian_date_t los;
+	predict_julian_date_t max_elevation_time;
+	double max_elevation;
+};
+
+/**
+ * Access windows found by one thread, those of each satellite in a row.
+ **/
+struct access_thread {
+	struct access_window *windows;
+	size_t num_windows;
+	size_t capacity;
+	bool out_of_memory;
+};
+
+/**
+ * Satellites, observers and results of predict_access_matrix(), shared between the threads.
+ **/
+struct access_context {
+	const predict_orbital_elements_t *orbital_elements;
+	const predict_observer_t *observers;
+	size_t num_observers;
+	predict_julian_date_t start_time;
+	predict_julian_date_t end_time;
+	struct access_thread *threads;
+	///Thread that found the windows of each satellite
+	int *satellite_thread;
+	///First window of each satellite in the windows of its thread
+	size_t *satellite_first;
+	///Number of windows of each satellite
+	size_t *satellite_count;
+};
+
+/**
+ * Find the access windows of a range of satellites over all observers.
+ *
+ * \param context Access context
+ * \param begin First satellite
+ * \param end One past the last satellite
+ * \param thread Calling thread
+ **/
+static void access_satellite_range(void *context, size_t begin, size_t end, int thread)
+{
+	struct access_context *ctx = (struct access_context*)context;
+	struct access_thread *found = &ctx->threads[thread];
+	predict_passes_t *passes = malloc(ctx->num_observers*sizeof(predict_passes_t));
+	found->out_of_memory = found->out_of_memory || (passes == NULL);
+
+	for (size_t s=begin; (s < end) && !found->out_of_memory; s++) {
+		ctx->satellite_thread[s] = thread;
+		ctx->satellite_first[s] = found->num_windows;
+		ctx->satellite_count[s] = 0;
+
+		//observers the satellite never rises over are left out by predict_passes_observers()
+		if (!predict_passes_observers(ctx->observers, ctx->num_observers, &ctx->orbital_elements[s], ctx->start_time, ctx->end_time, passes)) {
+			found->out_of_memory = true;
+			break;
+		}
+		size_t num_passes = 0;
+		for (size_t o=0; o < ctx->num_observers; o++) {
+			num_passes += passes[o].num_passes;
+		}
+		if (found->num_windows + num_passes > found->capacity) {
+			size_t capacity = (found->capacity > 0) ? found->capacity : 256;
+			while (capacity < found->num_windows + num_passes) {
+				capacity *= 2;
+			}
+			struct access_window *resized = realloc(found->windows, capacity*sizeof(struct access_window));
+			if (resized == NULL) {
+				found->out_of_memory = true;
+			} else {
+				found->windows = resized;
+				found->capacity = capacity;
+			}
+		}
+		for (size_t o=0; o < ctx->num_observers; o++) {
+			for (size_t p=0; !found->out_of_memory && (p < passes[o].num_passes); p++) {
+				const struct predict_pass *pass = &passes[o].passes[p];
+				struct access_window *window = &found->windows[found->num_windows++];
+				window->observer = o;
+				window->aos = pass->aos.time;
+				window->los = pass->los.time;
+				window->max_elevation_time = pass->max_elevation.time;
+				window->max_elevation = pass->max_elevation.elevation;
+			}
+			predict_destroy_passes(&passes[o]);
+		}
+		ctx->satellite_count[s] = found->out_of_memory ? 0 : num_passes;
+	}
+	free(passes);
+}
+
+bool predict_access_matrix(predict_access_t *access, const predict_orbital_elements_t *orbital_elements, size_t num_satellites, const predict_observer_t *observers, size_t num_observers, predict_julian_date_t start_time, predict_julian_date_t end_time, int num_threads)
+{
+	access->num_satellites = num_satellites;
+	access->num_windows = 0;
+	access->satellite_offsets = calloc(num_satellites + 1, sizeof(size_t));
+	access->observer = NULL;
+	access->aos = NULL;
+	access->los = NULL;
+	access->max_elevation_time = NULL;
+	access->max_elevation = NULL;
+	if (access->satellite_offsets == NULL) {
+		return false;
+	}
+	if ((num_satellites == 0) || (num_observers == 0)) {
+		return true;
+	}
+
+	if (num_threads <= 0) {
+		num_threads = parallel_default_threads();
+	}
+	struct access_context context;
+	context.orbital_elements = orbital_elements;
+	context.observers = observers;
+	context.num_observers = num_observers;
+	context.start_time = start_time;
+	context.end_time = end_time;
+	context.threads = calloc(num_threads, sizeof(struct access_thread));
+	context.satellite_thread = malloc(num_satellites*sizeof(int));
+	context.satellite_first = malloc(num_satellites*sizeof(size_t));
+	context.satellite_count = malloc(num_satellites*sizeof(size_t));
+	bool success = (context.threads != NULL) && (context.satellite_thread != NULL) && (context.satellite_first != NULL) && (context.satellite_count != NULL);
+	if (success) {
+		parallel_for(num_satellites, 1, num_threads, access_satellite_range, &context);
+		for (int t=0; t < num_threads; t++) {
+			success = success && !context.threads[t].out_of_memory;
+		}
+	}
+
+	//gather the windows of each thread into columns, in order of satellite
+	if (success) {
+		for (size_t s=0; s < num_satellites; s++) {
+			access->satellite_offsets[s + 1] = access->satellite_offsets[s] + context.satellite_count[s];
+		}
+		size_t num_windows = access->satellite_offsets[num_satellites];
+		access->observer = malloc((num_windows + 1)*sizeof(uint32_t));
+		access->aos = malloc((num_windows + 1)*sizeof(predict_julian_date_t));
+		access->los = malloc((num_windows + 1)*sizeof(predict_julian_date_t));
+		access->max_elevation_time = malloc((num_windows + 1)*sizeof(predict_julian_date_t));
+		access->max_elevation = malloc((num_windows + 1)*sizeof(double));
+		success = (access->observer != NULL) && (access->aos != NULL) && (access->los != NULL) && (access->max_elevation_time != NULL) && (access->max_elevation != NULL);
+		for (size_t s=0; success && (s < num_satellites); s++) {
+			const struct access_window *windows = &context.threads[context.satellite_thread[s]].windows[context.satellite_first[s]];
+			for (size_t w=0; w < context.satellite_count[s]; w++) {
+				size_t i = access->satellite_offsets[s] + w;
+				access->observer[i] = windows[w].observer;
+				access->aos[i] = windows[w].aos;
+				access->los[i] = windows[w].los;
+				access->max_elevation_time[i] = windows[w].max_elevation_time;
+				access->max_elevation[i] = windows[w].max_elevation;
+			}
+		}
+		access->num_windows = success ? num_windows : 0;
+	}
+
+	for (int t=0; (context.threads != NULL) && (t < num_threads); t++) {
+		free(context.threads[t].windows);
+	}
+	free(context.threads);
+	free(context.satellite_thread);
+	free(context.satellite_first);
+	free(context.satellite_count);
+	if (!success) {
+		predict_destroy_access(access);
+	}
+	return success;
+}
+
+void predict_destroy_access(predict_access_t *access)
+{
+	free(access->satellite_offsets);
+	free(access->observer);
+	free(access->aos);
+	free(access->los);
+	free(access->max_elevation_time);
+	free(access->max_elevation);
+	access->satellite_offsets = NULL;
+	access->observer = NULL;
+	access->aos = NULL;
+	access->los = NULL;
+	access->max_elevation_time = NULL;
+	access->max_elevation = NULL;
+	access->num_windows = 0;
+}
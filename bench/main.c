@@ -0,0 +1,344 @@
+#include <stdio.h>
+#include <math.h>
+#include <unistd.h>
+#include <stdlib.h>
+#include <time.h>
+#include <string.h>
+#include <ctype.h>
+
+#include "../predict.h"
+#include "../unsorted.h"
+#include "../sgp4.h"
+#include "../sdp4.h"
+
+/* Speed of the orbit models, observations, pass search and TLE parsing. */
+/* Results are written to stdout as CSV, one benchmark per line, for comparing releases: */
+/*   benchmark,parameter,calls,ns_per_call,calls_per_second */
+/* Comment lines start with '#'. */
+
+#ifndef BUILD_VERSION
+#define BUILD_VERSION "unknown"
+#endif
+#ifndef BUILD_DATE
+#define BUILD_DATE "unknown"
+#endif
+
+/* each benchmark runs at least this long, in seconds */
+#define BENCH_MIN_TIME 0.25
+
+/* number of TLEs in the bulk parsing benchmarks */
+#define BENCH_NUM_TLES 20000
+
+const char* iss_tle[2] = {
+  "1 25544U 98067A   15129.86961041  .00015753  00000-0  23097-3 0  9998",
+  "2 25544  51.6459 275.1962 0006103 329.4680 153.4522 15.55705328942633"
+};
+
+/* Deep-space orbits: without resonance, and with the 12 hour resonance of a Molniya orbit */
+const char* sdp4_tle[2] = {
+  "1 11801U          80230.29629788  .01431103  00000-0  14311-1       2",
+  "2 11801U 46.7916 230.4354 7318036  47.4722  10.4117  2.28537848     2"
+};
+const char* molniya_tle[2] = {
+  "1 40001U 98067A   17001.00000000  .00000100  00000-0  10000-4 0  9990",
+  "2 40001  63.4000 100.0000 7200000 270.0000  10.0000  2.00600000360131"
+};
+
+/* keeps the compiler from dropping the benchmarked calls */
+static volatile double bench_sink;
+
+/* Function benchmarked: one call of the measured code per iteration */
+typedef void (*bench_func)(void *context, size_t iteration);
+
+static double bench_now(void)
+{
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return now.tv_sec + now.tv_nsec*1e-9;
+}
+
+/* Run a benchmark for at least BENCH_MIN_TIME and print its line. Each call handles items_per_call items, */
+/* such as TLEs, and the rates are given per item. */
+static void bench_run(const char *name, const char *parameter, size_t items_per_call, bench_func func, void *context)
+{
+  size_t calls = 1;
+  double elapsed;
+  while(true)
+  {
+    double start = bench_now();
+    for(size_t i = 0; i < calls; i++)
+      func(context, i);
+    elapsed = bench_now() - start;
+    if(elapsed >= BENCH_MIN_TIME)
+      break;
+    /* aim a little beyond the minimum time, from the rate so far */
+    size_t next = (elapsed > 0.0) ? (size_t)(1.2*calls*BENCH_MIN_TIME/elapsed) + 1 : 10*calls;
+    calls = (next > 10*calls) ? 10*calls : ((next > calls) ? next : calls + 1);
+  }
+  double items = (double)calls*items_per_call;
+  printf("%s,%s,%.0f,%.1f,%.1f\n", name, parameter, items, elapsed/items*1e9, items/elapsed);
+  fflush(stdout);
+}
+
+
+/* Orbit models */
+struct bench_model {
+  predict_orbital_elements_t elements;
+  struct predict_sgp4 sgp;
+  struct predict_sdp4 sdp;
+  /* time since epoch of the first call, and between calls, in minutes */
+  double tsince;
+  double tsince_step;
+  struct predict_sdp4_resonance resonance;
+  double epoch;
+};
+
+static void bench_parse(struct bench_model *model, const char *tle[2])
+{
+  memset(model, 0, sizeof(struct bench_model));
+  if(!predict_parse_tle(&model->elements, tle[0], tle[1], &model->sgp, &model->sdp))
+  {
+    fprintf(stderr, "Could not parse TLE %s\n", tle[0]);
+    exit(1);
+  }
+  model->epoch = Julian_Date_of_Epoch((1000.0*model->elements.epoch_year) + model->elements.epoch_day);
+}
+
+static void bench_sgp4_predict(void *context, size_t iteration)
+{
+  struct bench_model *model = (struct bench_model*)context;
+  struct model_output output;
+  sgp4_predict(&model->sgp, model->tsince + (iteration % 1000)*model->tsince_step, &output);
+  bench_sink = output.pos[0];
+}
+
+static void bench_sdp4_predict(void *context, size_t iteration)
+{
+  struct bench_model *model = (struct bench_model*)context;
+  struct model_output output;
+  sdp4_predict(&model->sdp, model->tsince + (iteration % 1000)*model->tsince_step, &output);
+  bench_sink = output.pos[0];
+}
+
+static void bench_sdp4_predict_resonant(void *context, size_t iteration)
+{
+  struct bench_model *model = (struct bench_model*)context;
+  struct model_output output;
+  sdp4_predict_resonant(&model->sdp, &model->resonance, model->tsince + iteration*model->tsince_step, &output);
+  bench_sink = output.pos[0];
+}
+
+static void bench_predict_orbit(void *context, size_t iteration)
+{
+  struct bench_model *model = (struct bench_model*)context;
+  struct predict_position orbit;
+  predict_orbit(&model->elements, &orbit, model->epoch + (model->tsince + (iteration % 1000)*model->tsince_step)/1440.0);
+  bench_sink = orbit.position[0];
+}
+
+
+/* Observations and pass search */
+struct bench_observer {
+  struct bench_model model;
+  predict_observer_t observer;
+  struct predict_position orbits[1000];
+  /* time between the start times of the pass search, in days */
+  double time_step;
+};
+
+static void bench_observe_orbit(void *context, size_t iteration)
+{
+  struct bench_observer *bench = (struct bench_observer*)context;
+  struct predict_observation obs;
+  predict_observe_orbit(&bench->observer, &bench->orbits[iteration % 1000], &obs);
+  bench_sink = obs.elevation;
+}
+
+static void bench_next_aos(void *context, size_t iteration)
+{
+  struct bench_observer *bench = (struct bench_observer*)context;
+  struct predict_observation obs = predict_next_aos(&bench->observer, &bench->model.elements, bench->model.epoch + (iteration % 1000)*bench->time_step);
+  bench_sink = obs.time;
+}
+
+static void bench_next_los(void *context, size_t iteration)
+{
+  struct bench_observer *bench = (struct bench_observer*)context;
+  struct predict_observation obs = predict_next_los(&bench->observer, &bench->model.elements, bench->model.epoch + (iteration % 1000)*bench->time_step);
+  bench_sink = obs.time;
+}
+
+static void bench_at_max_elevation(void *context, size_t iteration)
+{
+  struct bench_observer *bench = (struct bench_observer*)context;
+  struct predict_observation obs = predict_at_max_elevation(&bench->observer, &bench->model.elements, bench->model.epoch + (iteration % 1000)*bench->time_step);
+  bench_sink = obs.time;
+}
+
+
+/* Bulk TLE parsing */
+struct bench_tles {
+  char (*lines)[2][70];
+  size_t num_tles;
+  const char *filename;
+  int num_threads;
+};
+
+/* Replace the checksum of a TLE line by the correct one */
+static void bench_fix_checksum(char *line)
+{
+  int sum = 0;
+  for(int i = 0; i < 68; i++)
+  {
+    if(isdigit((unsigned char)line[i])) sum += line[i] - '0';
+    else if(line[i] == '-') sum++;
+  }
+  line[68] = '0' + sum % 10;
+}
+
+/* Catalog of ISS-like satellites with varying satellite number and mean anomaly, */
+/* with every tenth a deep-space orbit */
+static void bench_create_tles(struct bench_tles *tles, size_t num_tles)
+{
+  tles->lines = malloc(num_tles*sizeof(*tles->lines));
+  tles->num_tles = num_tles;
+  if(tles->lines == NULL)
+  {
+    fprintf(stderr, "Out of memory\n");
+    exit(1);
+  }
+  for(size_t i = 0; i < num_tles; i++)
+  {
+    const char **tle = (i % 10 == 9) ? molniya_tle : iss_tle;
+    char number[6], anomaly[9];
+    strcpy(tles->lines[i][0], tle[0]);
+    strcpy(tles->lines[i][1], tle[1]);
+    snprintf(number, sizeof(number), "%05zu", 10000 + i % 90000);
+    snprintf(anomaly, sizeof(anomaly), "%8.4f", fmod(i*7.31, 360.0));
+    memcpy(tles->lines[i][0] + 2, number, 5);
+    memcpy(tles->lines[i][1] + 2, number, 5);
+    memcpy(tles->lines[i][1] + 43, anomaly, 8);
+    bench_fix_checksum(tles->lines[i][0]);
+    bench_fix_checksum(tles->lines[i][1]);
+  }
+}
+
+static void bench_parse_tle(void *context, size_t iteration)
+{
+  struct bench_tles *tles = (struct bench_tles*)context;
+  predict_orbital_elements_t elements;
+  struct predict_sgp4 sgp;
+  struct predict_sdp4 sdp;
+  size_t i = iteration % tles->num_tles;
+  predict_parse_tle(&elements, tles->lines[i][0], tles->lines[i][1], &sgp, &sdp);
+  bench_sink = elements.mean_motion;
+}
+
+static void bench_decode_tle(void *context, size_t iteration)
+{
+  struct bench_tles *tles = (struct bench_tles*)context;
+  predict_orbital_elements_t elements;
+  size_t i = iteration % tles->num_tles;
+  predict_tle_decode(&elements, tles->lines[i][0], tles->lines[i][1], NULL);
+  bench_sink = elements.mean_motion;
+}
+
+static void bench_load_file(void *context, size_t iteration)
+{
+  (void)iteration;
+  struct bench_tles *tles = (struct bench_tles*)context;
+  predict_catalog_t catalog;
+  predict_create_catalog(&catalog, tles->num_tles);
+  if(predict_catalog_load_file(&catalog, tles->filename, tles->num_threads, NULL, 0, NULL) != (long)tles->num_tles)
+  {
+    fprintf(stderr, "Could not load %s\n", tles->filename);
+    exit(1);
+  }
+  bench_sink = catalog.elements[0].mean_motion;
+  predict_destroy_catalog(&catalog);
+}
+
+
+int main(void)
+{
+  char parameter[64];
+
+  printf("# libpredict benchmarks, version %s, built %s\n", BUILD_VERSION, BUILD_DATE);
+  printf("benchmark,parameter,calls,ns_per_call,calls_per_second\n");
+
+  /* orbit models, over the first day from epoch */
+  struct bench_model model;
+  bench_parse(&model, iss_tle);
+  model.tsince_step = 1.44;
+  bench_run("sgp4_predict", "iss", 1, bench_sgp4_predict, &model);
+
+  bench_parse(&model, sdp4_tle);
+  model.tsince_step = 1.44;
+  bench_run("sdp4_predict", "11801", 1, bench_sdp4_predict, &model);
+
+  /* the resonance integrator steps from epoch on every call, so the cost grows with the time since epoch */
+  const double days[] = {0, 1, 10, 100, 1000};
+  bench_parse(&model, molniya_tle);
+  for(size_t i = 0; i < sizeof(days)/sizeof(days[0]); i++)
+  {
+    model.tsince = days[i]*1440.0;
+    model.tsince_step = 0.01;
+    snprintf(parameter, sizeof(parameter), "molniya tsince_days=%g", days[i]);
+    bench_run("sdp4_predict", parameter, 1, bench_sdp4_predict, &model);
+  }
+  /* continuing the integrator from the previous call, one minute later each call */
+  model.tsince = days[sizeof(days)/sizeof(days[0]) - 1]*1440.0;
+  model.tsince_step = 1.0;
+  snprintf(parameter, sizeof(parameter), "molniya tsince_days=%g", days[sizeof(days)/sizeof(days[0]) - 1]);
+  bench_run("sdp4_predict_resonant", parameter, 1, bench_sdp4_predict_resonant, &model);
+
+  /* end to end */
+  bench_parse(&model, iss_tle);
+  model.tsince_step = 1.44;
+  bench_run("predict_orbit", "iss", 1, bench_predict_orbit, &model);
+  bench_parse(&model, molniya_tle);
+  model.tsince_step = 1.44;
+  bench_run("predict_orbit", "molniya", 1, bench_predict_orbit, &model);
+
+  /* observation and pass search from Trondheim */
+  static struct bench_observer observer;
+  bench_parse(&observer.model, iss_tle);
+  predict_create_observer(&observer.observer, "Trondheim", 63.42*M_PI/180.0, 10.39*M_PI/180.0, 0);
+  for(size_t i = 0; i < 1000; i++)
+    predict_orbit(&observer.model.elements, &observer.orbits[i], observer.model.epoch + i/1000.0);
+  bench_run("predict_observe_orbit", "iss", 1, bench_observe_orbit, &observer);
+  observer.time_step = 0.0731;
+  bench_run("predict_next_aos", "iss", 1, bench_next_aos, &observer);
+  bench_run("predict_next_los", "iss", 1, bench_next_los, &observer);
+  bench_run("predict_at_max_elevation", "iss", 1, bench_at_max_elevation, &observer);
+
+  /* bulk TLE parsing, per TLE */
+  struct bench_tles tles;
+  bench_create_tles(&tles, BENCH_NUM_TLES);
+  bench_run("predict_parse_tle", "mixed", 1, bench_parse_tle, &tles);
+  bench_run("predict_tle_decode", "mixed", 1, bench_decode_tle, &tles);
+
+  char filename[] = "/tmp/libpredict_bench_XXXXXX";
+  int fd = mkstemp(filename);
+  FILE *file = (fd < 0) ? NULL : fdopen(fd, "w");
+  if(file == NULL)
+  {
+    fprintf(stderr, "Could not create %s\n", filename);
+    exit(1);
+  }
+  for(size_t i = 0; i < tles.num_tles; i++)
+    fprintf(file, "SAT %zu\n%s\n%s\n", i, tles.lines[i][0], tles.lines[i][1]);
+  fclose(file);
+  tles.filename = filename;
+  const int threads[] = {1, 0};
+  for(size_t i = 0; i < sizeof(threads)/sizeof(threads[0]); i++)
+  {
+    tles.num_threads = threads[i];
+    snprintf(parameter, sizeof(parameter), "mixed 3le threads=%d", threads[i]);
+    bench_run("predict_catalog_load_file", parameter, tles.num_tles, bench_load_file, &tles);
+  }
+  unlink(filename);
+  free(tles.lines);
+
+  return 0;
+}
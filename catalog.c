@@ -0,0 +1,651 @@
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "predict.h"
+#include "parallel.h"
+
+//alignment of model parameter structs in the arena
+#define CATALOG_ALIGNMENT (_Alignof(struct predict_sdp4) > _Alignof(struct predict_sgp4) ? _Alignof(struct predict_sdp4) : _Alignof(struct predict_sgp4))
+
+static size_t catalog_align(size_t size)
+{
+	return (size + CATALOG_ALIGNMENT - 1)/CATALOG_ALIGNMENT*CATALOG_ALIGNMENT;
+}
+
+/**
+ * Resize the allocation of the catalog. The elements are kept at the start and the arena is moved behind them,
+ * and the model parameter pointers of the elements are rebased to the new location of the arena.
+ *
+ * \param catalog Catalog
+ * \param capacity New number of elements there is room for, at least the current capacity
+ * \param arena_size New size of arena, at least the current size
+ * \return false if out of memory, in which case the catalog is unchanged
+ **/
+static bool catalog_resize(predict_catalog_t *catalog, size_t capacity, size_t arena_size)
+{
+	size_t old_arena_offset = catalog_align(catalog->capacity*sizeof(predict_orbital_elements_t));
+	size_t new_arena_offset = catalog_align(capacity*sizeof(predict_orbital_elements_t));
+	uintptr_t old_arena = (uintptr_t)catalog->arena;
+
+	//the catalog only grows, so the arena stays in place or moves up
+	unsigned char *block;
+	if (catalog->mapping != NULL) {
+		//mapped from a binary catalog file, which has the same layout
+		block = malloc(new_arena_offset + arena_size);
+		if (block == NULL) {
+			return false;
+		}
+		memcpy(block, catalog->elements, old_arena_offset + catalog->arena_used);
+	} else {
+		block = realloc(catalog->elements, new_arena_offset + arena_size);
+		if (block == NULL) {
+			return false;
+		}
+	}
+	memmove(block + new_arena_offset, block + old_arena_offset, catalog->arena_used);
+
+	catalog->elements = (predict_orbital_elements_t*)block;
+	catalog->arena = block + new_arena_offset;
+	catalog->capacity = capacity;
+	catalog->arena_size = arena_size;
+
+	for (size_t i=0; i < catalog->num_elements; i++) {
+		uintptr_t offset = (uintptr_t)catalog->elements[i].ephemeris_data - old_arena;
+		catalog->elements[i].ephemeris_data = catalog->arena + offset;
+	}
+
+	if (catalog->mapping != NULL) {
+		munmap(catalog->mapping, catalog->mapping_size);
+		catalog->mapping = NULL;
+		catalog->mapping_size = 0;
+	}
+	return true;
+}
+
+bool predict_create_catalog(predict_catalog_t *catalog, size_t capacity)
+{
+	catalog->elements = NULL;
+	catalog->num_elements = 0;
+	catalog->capacity = 0;
+	catalog->arena = NULL;
+	catalog->arena_used = 0;
+	catalog->arena_size = 0;
+	catalog->mapping = NULL;
+	catalog->mapping_size = 0;
+
+	if (capacity == 0) {
+		capacity = 1;
+	}
+
+	//most catalogued objects are near-earth
+	return catalog_resize(catalog, capacity, capacity*catalog_align(sizeof(struct predict_sgp4)));
+}
+
+bool predict_catalog_add_tle(predict_catalog_t *catalog, const char *tle_line_1, const char *tle_line_2)
+{
+	predict_orbital_elements_t elements;
+	struct predict_sgp4 sgp4;
+	struct predict_sdp4 sdp4;
+	if (!predict_parse_tle(&elements, tle_line_1, tle_line_2, &sgp4, &sdp4)) {
+		return false;
+	}
+
+	const void *model = elements.ephemeris_data;
+	size_t model_size = (elements.ephemeris == EPHEMERIS_SDP4) ? sizeof(struct predict_sdp4) : sizeof(struct predict_sgp4);
+
+	//grow geometrically to keep adding amortized constant time
+	size_t capacity = catalog->capacity;
+	if (catalog->num_elements == capacity) {
+		capacity *= 2;
+	}
+	size_t arena_size = catalog->arena_size;
+	while (catalog->arena_used + catalog_align(model_size) > arena_size) {
+		arena_size *= 2;
+	}
+	if ((capacity != catalog->capacity) || (arena_size != catalog->arena_size)) {
+		if (!catalog_resize(catalog, capacity, arena_size)) {
+			return false;
+		}
+	}
+
+	unsigned char *model_copy = catalog->arena + catalog->arena_used;
+	memcpy(model_copy, model, model_size);
+	catalog->arena_used += catalog_align(model_size);
+
+	elements.ephemeris_data = model_copy;
+	catalog->elements[catalog->num_elements++] = elements;
+	return true;
+}
+
+void predict_destroy_catalog(predict_catalog_t *catalog)
+{
+	if (catalog->mapping != NULL) {
+		munmap(catalog->mapping, catalog->mapping_size);
+	} else {
+		free(catalog->elements);
+	}
+	catalog->mapping = NULL;
+	catalog->mapping_size = 0;
+	catalog->elements = NULL;
+	catalog->arena = NULL;
+	catalog->num_elements = 0;
+	catalog->capacity = 0;
+	catalog->arena_used = 0;
+	catalog->arena_size = 0;
+}
+
+//length of a TLE line without line ending
+#define CATALOG_TLE_LINE_LENGTH 69
+
+//number of records a thread parses at a time
+#define CATALOG_PARSE_GRAIN 64
+
+/**
+ * Line of a TLE file, pointing into the mapped file.
+ **/
+struct catalog_line {
+	const char *start;
+	size_t length;
+};
+
+/**
+ * Record found in a TLE file, with its outcome.
+ **/
+struct catalog_record {
+	///Line 1 and line 2, or a lone line for a format error
+	struct catalog_line lines[2];
+	///Outcome of parsing, with the line number of the first line in the file
+	struct predict_tle_error error;
+};
+
+/**
+ * Space for the model parameters of a record before they are packed into the arena.
+ **/
+union catalog_model {
+	struct predict_sgp4 sgp4;
+	struct predict_sdp4 sdp4;
+};
+
+/**
+ * Get the next line of the file, without line ending.
+ *
+ * \param pos Position in file, advanced past the line
+ * \param end End of file
+ * \param line Returned line
+ * \return false at end of file
+ **/
+static bool catalog_next_line(const char **pos, const char *end, struct catalog_line *line)
+{
+	if (*pos >= end) {
+		return false;
+	}
+
+	const char *newline = memchr(*pos, '\n', end - *pos);
+	const char *line_end = (newline != NULL) ? newline : end;
+	line->start = *pos;
+	line->length = line_end - *pos;
+	if ((line->length > 0) && (line->start[line->length - 1] == '\r')) {
+		line->length--;
+	}
+	*pos = (newline != NULL) ? newline + 1 : end;
+	return true;
+}
+
+/**
+ * Check whether a line looks like a TLE line with the given line number.
+ **/
+static bool catalog_is_tle_line(const struct catalog_line *line, char number)
+{
+	return (line->length >= 2) && (line->start[0] == number) && (line->start[1] == ' ');
+}
+
+/**
+ * Find the TLE records of a file in one pass. Lines that do not start like
+ * TLE lines are taken as names of 3LE records and skipped.
+ *
+ * \param data File contents
+ * \param size File size
+ * \param num_records Returned number of records
+ * \return Allocated array of records, or NULL if out of memory
+ **/
+static struct catalog_record *catalog_index_records(const char *data, size_t size, size_t *num_records)
+{
+	//every record takes at least two full lines
+	size_t capacity = size/(2*CATALOG_TLE_LINE_LENGTH) + 1;
+	struct catalog_record *records = malloc(capacity*sizeof(struct catalog_record));
+	if (records == NULL) {
+		return NULL;
+	}
+
+	const char *pos = data;
+	const char *end = data + size;
+	size_t line_number = 0;
+	size_t count = 0;
+	struct catalog_line line, next_line;
+	bool have_line = catalog_next_line(&pos, end, &line);
+	while (have_line) {
+		line_number++;
+		bool have_next = catalog_next_line(&pos, end, &next_line);
+
+		if (!catalog_is_tle_line(&line, '1') && !catalog_is_tle_line(&line, '2')) {
+			//name line or blank line
+			line = next_line;
+			have_line = have_next;
+			continue;
+		}
+
+		if (count == capacity) {
+			//only reachable with short TLE lines
+			capacity *= 2;
+			struct catalog_record *grown = realloc(records, capacity*sizeof(struct catalog_record));
+			if (grown == NULL) {
+				free(records);
+				return NULL;
+			}
+			records = grown;
+		}
+
+		struct catalog_record *record = &records[count++];
+		memset(&record->error, 0, sizeof(record->error));
+		record->error.line = line_number;
+		record->lines[0] = line;
+		if (catalog_is_tle_line(&line, '1') && have_next && catalog_is_tle_line(&next_line, '2')) {
+			//short lines are left to the decoder, which reports where they end
+			record->lines[1] = next_line;
+			record->error.status = PREDICT_TLE_OK;
+
+			line_number++;
+			have_line = catalog_next_line(&pos, end, &line);
+		} else {
+			//line 1 without line 2, or line 2 without line 1
+			record->lines[1].start = NULL;
+			record->lines[1].length = 0;
+			record->error.status = PREDICT_TLE_FORMAT_ERROR;
+
+			line = next_line;
+			have_line = have_next;
+		}
+	}
+
+	*num_records = count;
+	return records;
+}
+
+/**
+ * Arguments of the parallel parsing in predict_catalog_load_file().
+ **/
+struct catalog_parse_context {
+	struct catalog_record *records;
+	///Parsed elements of each record
+	predict_orbital_elements_t *elements;
+	///Parsed model parameters of each record
+	union catalog_model *models;
+};
+
+/**
+ * Parse a range of records of a TLE file.
+ **/
+static void catalog_parse_range(void *context, size_t begin, size_t end, int thread)
+{
+	(void)thread;
+	struct catalog_parse_context *ctx = (struct catalog_parse_context*)context;
+
+	for (size_t i=begin; i < end; i++) {
+		struct catalog_record *record = &ctx->records[i];
+		if (record->error.status != PREDICT_TLE_OK) {
+			continue;
+		}
+
+		//the parser needs terminated strings, the lines in the file are not
+		char lines[2][CATALOG_TLE_LINE_LENGTH + 1];
+		for (int j=0; j < 2; j++) {
+			size_t length = record->lines[j].length < CATALOG_TLE_LINE_LENGTH ? record->lines[j].length : CATALOG_TLE_LINE_LENGTH;
+			memcpy(lines[j], record->lines[j].start, length);
+			lines[j][length] = '\0';
+		}
+
+		if (!predict_parse_tle(&ctx->elements[i], lines[0], lines[1], &ctx->models[i].sgp4, &ctx->models[i].sdp4)) {
+			//decode again to find out where the record is broken
+			size_t line_number = record->error.line;
+			predict_tle_decode(&ctx->elements[i], lines[0], lines[1], &record->error);
+			record->error.line = line_number;
+		}
+	}
+}
+
+/**
+ * Arguments of the parallel packing of model parameters in predict_catalog_load_file().
+ **/
+struct catalog_pack_context {
+	predict_catalog_t *catalog;
+	const union catalog_model *models;
+	///Index of the record of each new satellite
+	const size_t *record_index;
+	///Arena offset of each new satellite
+	const size_t *arena_offset;
+	///Index of the first new satellite in the catalog
+	size_t first;
+};
+
+/**
+ * Copy the model parameters of a range of new satellites into the arena.
+ **/
+static void catalog_pack_range(void *context, size_t begin, size_t end, int thread)
+{
+	(void)thread;
+	struct catalog_pack_context *ctx = (struct catalog_pack_context*)context;
+
+	for (size_t i=begin; i < end; i++) {
+		predict_orbital_elements_t *elements = &ctx->catalog->elements[ctx->first + i];
+		size_t model_size = (elements->ephemeris == EPHEMERIS_SDP4) ? sizeof(struct predict_sdp4) : sizeof(struct predict_sgp4);
+		unsigned char *model = ctx->catalog->arena + ctx->arena_offset[i];
+		memcpy(model, &ctx->models[ctx->record_index[i]], model_size);
+		elements->ephemeris_data = model;
+	}
+}
+
+long predict_catalog_load_file(predict_catalog_t *catalog, const char *filename, int num_threads, struct predict_tle_error *errors, size_t max_errors, size_t *num_errors)
+{
+	if (num_errors != NULL) {
+		*num_errors = 0;
+	}
+
+	int fd = open(filename, O_RDONLY);
+	if (fd < 0) {
+		return -1;
+	}
+	struct stat file_stat;
+	if (fstat(fd, &file_stat) < 0) {
+		close(fd);
+		return -1;
+	}
+	size_t size = file_stat.st_size;
+	if (size == 0) {
+		close(fd);
+		return 0;
+	}
+	const char *data = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (data == MAP_FAILED) {
+		return -1;
+	}
+	madvise((void*)data, size, MADV_SEQUENTIAL);
+
+	long ret = -1;
+	size_t num_records = 0;
+	struct catalog_record *records = catalog_index_records(data, size, &num_records);
+	predict_orbital_elements_t *elements = malloc(num_records*sizeof(predict_orbital_elements_t) + 1);
+	union catalog_model *models = malloc(num_records*sizeof(union catalog_model) + 1);
+	size_t *record_index = malloc(num_records*sizeof(size_t) + 1);
+	size_t *arena_offset = malloc(num_records*sizeof(size_t) + 1);
+	if ((records == NULL) || (elements == NULL) || (models == NULL) || (record_index == NULL) || (arena_offset == NULL)) {
+		goto cleanup;
+	}
+
+	struct catalog_parse_context parse_context = {records, elements, models};
+	parallel_for(num_records, CATALOG_PARSE_GRAIN, num_threads, catalog_parse_range, &parse_context);
+
+	//lay out the parsed satellites in file order, and report the rest
+	size_t num_added = 0;
+	size_t arena_used = catalog->arena_used;
+	for (size_t i=0; i < num_records; i++) {
+		if (records[i].error.status != PREDICT_TLE_OK) {
+			if ((errors != NULL) && (num_errors != NULL) && (*num_errors < max_errors)) {
+				errors[*num_errors] = records[i].error;
+			}
+			if (num_errors != NULL) {
+				(*num_errors)++;
+			}
+			continue;
+		}
+
+		size_t model_size = (elements[i].ephemeris == EPHEMERIS_SDP4) ? sizeof(struct predict_sdp4) : sizeof(struct predict_sgp4);
+		record_index[num_added] = i;
+		arena_offset[num_added] = arena_used;
+		arena_used += catalog_align(model_size);
+		num_added++;
+	}
+
+	size_t capacity = catalog->capacity;
+	while (capacity < catalog->num_elements + num_added) {
+		capacity *= 2;
+	}
+	size_t arena_size = catalog->arena_size;
+	while (arena_size < arena_used) {
+		arena_size *= 2;
+	}
+	if ((capacity != catalog->capacity) || (arena_size != catalog->arena_size)) {
+		if (!catalog_resize(catalog, capacity, arena_size)) {
+			goto cleanup;
+		}
+	}
+
+	size_t first = catalog->num_elements;
+	for (size_t i=0; i < num_added; i++) {
+		catalog->elements[first + i] = elements[record_index[i]];
+	}
+	struct catalog_pack_context pack_context = {catalog, models, record_index, arena_offset, first};
+	parallel_for(num_added, CATALOG_PARSE_GRAIN, num_threads, catalog_pack_range, &pack_context);
+	catalog->num_elements += num_added;
+	catalog->arena_used = arena_used;
+	ret = num_added;
+
+cleanup:
+	free(records);
+	free(elements);
+	free(models);
+	free(record_index);
+	free(arena_offset);
+	munmap((void*)data, size);
+	return ret;
+}
+
+//identifies a binary catalog file
+static const char catalog_file_magic[8] = {'P', 'R', 'E', 'D', 'C', 'A', 'T', '\0'};
+
+//version of the binary catalog file, to be increased when its layout or the initialization of the models changes
+#define CATALOG_FILE_VERSION 1
+
+//written in native byte order, reads differently on a platform of other endianness
+#define CATALOG_FILE_BYTE_ORDER 0x01020304
+
+/**
+ * Header of a binary catalog file. The elements follow at elements_offset, with the arena offset
+ * of their model parameters in place of the pointer, and the arena follows behind them in the
+ * same layout as in an allocated catalog.
+ **/
+struct catalog_file_header {
+	char magic[8];
+	uint32_t byte_order;
+	uint32_t version;
+	///Sizes of the structs stored in the file
+	uint32_t elements_size;
+	uint32_t sgp4_size;
+	uint32_t sdp4_size;
+	uint32_t alignment;
+	///Stamp of the source the catalog was made from
+	uint64_t source_stamp;
+	uint64_t num_elements;
+	uint64_t arena_used;
+	///Offset of the elements from the start of the file
+	uint64_t elements_offset;
+};
+
+/**
+ * Fill in the fields of the header that describe this version of the library and platform.
+ **/
+static void catalog_file_header_init(struct catalog_file_header *header)
+{
+	memset(header, 0, sizeof(*header));
+	memcpy(header->magic, catalog_file_magic, sizeof(catalog_file_magic));
+	header->byte_order = CATALOG_FILE_BYTE_ORDER;
+	header->version = CATALOG_FILE_VERSION;
+	header->elements_size = sizeof(predict_orbital_elements_t);
+	header->sgp4_size = sizeof(struct predict_sgp4);
+	header->sdp4_size = sizeof(struct predict_sdp4);
+	header->alignment = CATALOG_ALIGNMENT;
+	header->elements_offset = catalog_align(sizeof(struct catalog_file_header));
+}
+
+uint64_t predict_catalog_source_stamp(const char *filename)
+{
+	struct stat file_stat;
+	if (stat(filename, &file_stat) < 0) {
+		return 0;
+	}
+
+	//FNV-1a over the properties that change when the file is rewritten
+	uint64_t values[] = {file_stat.st_size, file_stat.st_mtim.tv_sec, file_stat.st_mtim.tv_nsec, file_stat.st_ino, file_stat.st_dev};
+	uint64_t stamp = 0xcbf29ce484222325ULL;
+	for (size_t i=0; i < sizeof(values)/sizeof(values[0]); i++) {
+		for (int j=0; j < 64; j += 8) {
+			stamp ^= (values[i] >> j) & 0xff;
+			stamp *= 0x100000001b3ULL;
+		}
+	}
+	return (stamp == 0) ? 1 : stamp;
+}
+
+/**
+ * Write zero bytes to the file up to the given offset.
+ **/
+static bool catalog_file_pad(FILE *file, size_t offset)
+{
+	static const unsigned char zeros[CATALOG_ALIGNMENT] = {0};
+	long position = ftell(file);
+	if ((position < 0) || ((size_t)position > offset)) {
+		return false;
+	}
+	return fwrite(zeros, 1, offset - position, file) == offset - (size_t)position;
+}
+
+bool predict_catalog_save(const predict_catalog_t *catalog, const char *filename, uint64_t source_stamp)
+{
+	size_t filename_length = strlen(filename);
+	char *temporary_filename = malloc(filename_length + sizeof(".tmp"));
+	if (temporary_filename == NULL) {
+		return false;
+	}
+	memcpy(temporary_filename, filename, filename_length);
+	memcpy(temporary_filename + filename_length, ".tmp", sizeof(".tmp"));
+
+	FILE *file = fopen(temporary_filename, "wb");
+	if (file == NULL) {
+		free(temporary_filename);
+		return false;
+	}
+
+	struct catalog_file_header header;
+	catalog_file_header_init(&header);
+	header.source_stamp = source_stamp;
+	header.num_elements = catalog->num_elements;
+	header.arena_used = catalog->arena_used;
+	size_t arena_offset = header.elements_offset + catalog_align(catalog->num_elements*sizeof(predict_orbital_elements_t));
+
+	bool written = (fwrite(&header, sizeof(header), 1, file) == 1) && catalog_file_pad(file, header.elements_offset);
+	for (size_t i=0; written && (i < catalog->num_elements); i++) {
+		predict_orbital_elements_t elements = catalog->elements[i];
+		elements.ephemeris_data = (void*)((unsigned char*)elements.ephemeris_data - catalog->arena);
+		written = fwrite(&elements, sizeof(elements), 1, file) == 1;
+	}
+	written = written && catalog_file_pad(file, arena_offset);
+	written = written && (fwrite(catalog->arena, 1, catalog->arena_used, file) == catalog->arena_used);
+	written = (fclose(file) == 0) && written;
+
+	written = written && (rename(temporary_filename, filename) == 0);
+	if (!written) {
+		unlink(temporary_filename);
+	}
+	free(temporary_filename);
+	return written;
+}
+
+enum predict_catalog_status predict_catalog_map(predict_catalog_t *catalog, const char *filename, uint64_t source_stamp)
+{
+	if (!predict_create_catalog(catalog, 1)) {
+		return PREDICT_CATALOG_IO_ERROR;
+	}
+
+	int fd = open(filename, O_RDONLY);
+	if (fd < 0) {
+		return PREDICT_CATALOG_IO_ERROR;
+	}
+	struct stat file_stat;
+	if (fstat(fd, &file_stat) < 0) {
+		close(fd);
+		return PREDICT_CATALOG_IO_ERROR;
+	}
+	size_t size = file_stat.st_size;
+	if (size < sizeof(struct catalog_file_header)) {
+		close(fd);
+		return PREDICT_CATALOG_FORMAT_ERROR;
+	}
+
+	//private and writable, so that setting the pointers of the elements does not change the file
+	unsigned char *data = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (data == MAP_FAILED) {
+		return PREDICT_CATALOG_IO_ERROR;
+	}
+
+	struct catalog_file_header expected, header;
+	catalog_file_header_init(&expected);
+	memcpy(&header, data, sizeof(header));
+
+	enum predict_catalog_status status = PREDICT_CATALOG_OK;
+	size_t arena_offset = 0;
+	if (memcmp(header.magic, expected.magic, sizeof(expected.magic)) != 0) {
+		status = PREDICT_CATALOG_FORMAT_ERROR;
+	} else if ((header.byte_order != expected.byte_order) || (header.version != expected.version)
+		|| (header.elements_size != expected.elements_size) || (header.sgp4_size != expected.sgp4_size)
+		|| (header.sdp4_size != expected.sdp4_size) || (header.alignment != expected.alignment)
+		|| (header.elements_offset != expected.elements_offset)) {
+		status = PREDICT_CATALOG_INCOMPATIBLE;
+	} else if (header.source_stamp != source_stamp) {
+		status = PREDICT_CATALOG_STALE;
+	} else if (header.num_elements > (size - header.elements_offset)/sizeof(predict_orbital_elements_t)) {
+		status = PREDICT_CATALOG_FORMAT_ERROR;
+	} else {
+		arena_offset = header.elements_offset + catalog_align(header.num_elements*sizeof(predict_orbital_elements_t));
+		if ((arena_offset > size) || (header.arena_used > size - arena_offset)) {
+			status = PREDICT_CATALOG_FORMAT_ERROR;
+		}
+	}
+
+	//point the elements at their model parameters
+	predict_orbital_elements_t *elements = (predict_orbital_elements_t*)(data + header.elements_offset);
+	unsigned char *arena = data + arena_offset;
+	for (size_t i=0; (status == PREDICT_CATALOG_OK) && (i < header.num_elements); i++) {
+		uintptr_t offset = (uintptr_t)elements[i].ephemeris_data;
+		size_t model_size = (elements[i].ephemeris == EPHEMERIS_SDP4) ? sizeof(struct predict_sdp4) : sizeof(struct predict_sgp4);
+		if (((elements[i].ephemeris != EPHEMERIS_SGP4) && (elements[i].ephemeris != EPHEMERIS_SDP4))
+			|| (offset % CATALOG_ALIGNMENT != 0) || (offset > header.arena_used) || (model_size > header.arena_used - offset)) {
+			status = PREDICT_CATALOG_FORMAT_ERROR;
+			break;
+		}
+		elements[i].ephemeris_data = arena + offset;
+	}
+
+	if ((status != PREDICT_CATALOG_OK) || (header.num_elements == 0)) {
+		//an empty catalog stays allocated, so that it can grow
+		munmap(data, size);
+		return status;
+	}
+
+	free(catalog->elements);
+	catalog->elements = elements;
+	catalog->num_elements = header.num_elements;
+	catalog->capacity = header.num_elements;
+	catalog->arena = arena;
+	catalog->arena_used = header.arena_used;
+	catalog->arena_size = header.arena_used;
+	catalog->mapping = data;
+	catalog->mapping_size = size;
+	return PREDICT_CATALOG_OK;
+}
@@ -0,0 +1,400 @@
+#include <math.h>
+#include <stdlib.h>
+
+#include "predict.h"
+#include "unsorted.h"
+#include "defs.h"
+#include "sun.h"
+#include "moon.h"
+
+#define CHEBYSHEV_N PREDICT_CHEBYSHEV_COEFFICIENTS
+
+//shortest segment tried before giving up on the tolerance, in days
+#define CHEBYSHEV_MIN_SEGMENT_LENGTH (1.0/MINUTES_PER_DAY)
+
+//first segment length of the sun and moon table, and the shortest one tried, in days
+#define CHEBYSHEV_EPHEMERIS_SEGMENT_LENGTH 4.0
+#define CHEBYSHEV_EPHEMERIS_MIN_SEGMENT_LENGTH (1.0/24.0)
+
+//step of the deep-space resonance integrator, in days
+#define CHEBYSHEV_RESONANCE_STEP (720.0/MINUTES_PER_DAY)
+
+//samples per segment: the fit points, and a check point between each pair of them
+#define CHEBYSHEV_SAMPLES (2*CHEBYSHEV_N - 1)
+
+/**
+ * Position of the fit points and check points of a segment, scaled to [-1, 1] and in increasing order.
+ * Even samples are the Chebyshev nodes, odd samples lie halfway between neighbouring nodes.
+ *
+ * \param sample Sample index, 0 to CHEBYSHEV_SAMPLES-1
+ * \return Position in segment
+ **/
+static double chebyshev_sample_point(int sample)
+{
+	double k = sample/2.0;
+	return -cos(M_PI*(k + 0.5)/CHEBYSHEV_N);
+}
+
+/**
+ * Evaluate Chebyshev series and their derivatives for the three components.
+ *
+ * \param coefficients CHEBYSHEV_N coefficients of each component
+ * \param x Position in segment, [-1, 1]
+ * \param value Returned value of each component
+ * \param derivative Returned derivative with respect to x of each component. May be NULL
+ **/
+static void chebyshev_evaluate(const double *coefficients, double x, double value[3], double derivative[3])
+{
+	//T_j(x) by the recurrence of the first kind, and T_j'(x) = j*U_{j-1}(x) by that of the second kind
+	double t_previous = 1.0, t = x;
+	double u_previous = 0.0, u = 1.0;
+	for (int c=0; c < 3; c++) {
+		value[c] = coefficients[c*CHEBYSHEV_N] + coefficients[c*CHEBYSHEV_N + 1]*x;
+		if (derivative != NULL) {
+			derivative[c] = coefficients[c*CHEBYSHEV_N + 1];
+		}
+	}
+	for (int j=2; j < CHEBYSHEV_N; j++) {
+		double t_next = 2.0*x*t - t_previous;
+		double u_next = 2.0*x*u - u_previous;
+		t_previous = t;
+		t = t_next;
+		u_previous = u;
+		u = u_next;
+		for (int c=0; c < 3; c++) {
+			value[c] += coefficients[c*CHEBYSHEV_N + j]*t;
+			if (derivative != NULL) {
+				derivative[c] += coefficients[c*CHEBYSHEV_N + j]*j*u;
+			}
+		}
+	}
+}
+
+/**
+ * Calculate the matrix that takes the values at the Chebyshev nodes to the coefficients of the series.
+ *
+ * \param basis Returned matrix
+ **/
+static void chebyshev_basis(double basis[CHEBYSHEV_N][CHEBYSHEV_N])
+{
+	//c_j = 2/N sum_k f(x_k) T_j(x_k), with c_0 halved. Node k is at x = -cos(pi*(k + 1/2)/N).
+	for (int j=0; j < CHEBYSHEV_N; j++) {
+		for (int k=0; k < CHEBYSHEV_N; k++) {
+			basis[j][k] = ((j == 0) ? 1.0 : 2.0)/CHEBYSHEV_N*cos(M_PI*j*(CHEBYSHEV_N - k - 0.5)/CHEBYSHEV_N);
+		}
+	}
+}
+
+/**
+ * Fit Chebyshev series to the three components of a function.
+ *
+ * \param basis Matrix from chebyshev_basis()
+ * \param nodes Values at the Chebyshev nodes, the even samples of chebyshev_sample_point()
+ * \param coefficients Returned CHEBYSHEV_N coefficients of each component
+ **/
+static void chebyshev_coefficients(double basis[CHEBYSHEV_N][CHEBYSHEV_N], double nodes[CHEBYSHEV_N][3], double *coefficients)
+{
+	for (int c=0; c < 3; c++) {
+		for (int j=0; j < CHEBYSHEV_N; j++) {
+			double sum = 0.0;
+			for (int k=0; k < CHEBYSHEV_N; k++) {
+				sum += basis[j][k]*nodes[k][c];
+			}
+			coefficients[c*CHEBYSHEV_N + j] = sum;
+		}
+	}
+}
+
+/**
+ * Fit the segments of the approximation and check them against the orbit model.
+ *
+ * \param chebyshev Approximation with span and number of segments set. Coefficients and errors are filled in
+ * \param orbital_elements Orbital elements
+ * \return false if the orbit could not be predicted or out of memory
+ **/
+static bool chebyshev_fit(predict_chebyshev_t *chebyshev, const predict_orbital_elements_t *orbital_elements)
+{
+	size_t num_samples = chebyshev->num_segments*CHEBYSHEV_SAMPLES;
+	predict_julian_date_t *times = malloc(num_samples*sizeof(predict_julian_date_t));
+	struct predict_position *samples = malloc(num_samples*sizeof(struct predict_position));
+	double *coefficients = malloc(chebyshev->num_segments*3*CHEBYSHEV_N*sizeof(double));
+	if ((times == NULL) || (samples == NULL) || (coefficients == NULL)) {
+		free(times);
+		free(samples);
+		free(coefficients);
+		return false;
+	}
+
+	for (size_t i=0; i < chebyshev->num_segments; i++) {
+		double segment_start = chebyshev->start_time + i*chebyshev->segment_length;
+		for (int k=0; k < CHEBYSHEV_SAMPLES; k++) {
+			times[i*CHEBYSHEV_SAMPLES + k] = segment_start + 0.5*chebyshev->segment_length*(chebyshev_sample_point(k) + 1.0);
+		}
+	}
+	//one satellite over times in increasing order, on the calling thread
+	if (predict_orbit_parallel(orbital_elements, 1, times, num_samples, PREDICT_ORBIT_ECI, 1, samples) != 0) {
+		free(times);
+		free(samples);
+		free(coefficients);
+		return false;
+	}
+
+	double basis[CHEBYSHEV_N][CHEBYSHEV_N];
+	chebyshev_basis(basis);
+
+	double max_position_error = 0.0;
+	double max_velocity_error = 0.0;
+	double velocity_scale = 2.0/(chebyshev->segment_length*SECONDS_PER_DAY);
+	for (size_t i=0; i < chebyshev->num_segments; i++) {
+		const struct predict_position *segment_samples = &samples[i*CHEBYSHEV_SAMPLES];
+		double *segment_coefficients = &coefficients[i*3*CHEBYSHEV_N];
+		double nodes[CHEBYSHEV_N][3];
+		for (int k=0; k < CHEBYSHEV_N; k++) {
+			for (int c=0; c < 3; c++) {
+				nodes[k][c] = segment_samples[2*k].position[c];
+			}
+		}
+		chebyshev_coefficients(basis, nodes, segment_coefficients);
+
+		for (int k=1; k < CHEBYSHEV_SAMPLES; k += 2) {
+			double position[3], velocity[3];
+			chebyshev_evaluate(segment_coefficients, chebyshev_sample_point(k), position, velocity);
+			double position_error = 0.0, velocity_error = 0.0;
+			for (int c=0; c < 3; c++) {
+				position_error += pow(position[c] - segment_samples[k].position[c], 2);
+				velocity_error += pow(velocity[c]*velocity_scale - segment_samples[k].velocity[c], 2);
+			}
+			max_position_error = fmax(max_position_error, sqrt(position_error));
+			max_velocity_error = fmax(max_velocity_error, sqrt(velocity_error));
+		}
+	}
+
+	free(times);
+	free(samples);
+	free(chebyshev->coefficients);
+	chebyshev->coefficients = coefficients;
+	chebyshev->max_position_error = max_position_error;
+	chebyshev->max_velocity_error = max_velocity_error;
+	return true;
+}
+
+bool predict_create_chebyshev(predict_chebyshev_t *chebyshev, const predict_orbital_elements_t *orbital_elements, predict_julian_date_t start_time, predict_julian_date_t end_time, double tolerance)
+{
+	chebyshev->start_time = start_time;
+	chebyshev->end_time = end_time;
+	chebyshev->coefficients = NULL;
+	chebyshev->max_position_error = 0.0;
+	chebyshev->max_velocity_error = 0.0;
+
+	double span = end_time - start_time;
+	if (!(span > 0.0) || !(orbital_elements->mean_motion > 0.0)) {
+		return false;
+	}
+
+	//the resonance integrator steps from epoch, leaving small jumps in position that a polynomial cannot follow.
+	//Widen the span to whole integration steps, so that every jump falls on a segment boundary.
+	const struct predict_sdp4 *sdp4 = (const struct predict_sdp4*)orbital_elements->ephemeris_data;
+	if ((orbital_elements->ephemeris == EPHEMERIS_SDP4) && sdp4->resonanceFlag) {
+		double epoch = Julian_Date_of_Epoch(1000.0*orbital_elements->epoch_year + orbital_elements->epoch_day);
+		double first_step = floor((start_time - epoch)/CHEBYSHEV_RESONANCE_STEP);
+		double last_step = ceil((end_time - epoch)/CHEBYSHEV_RESONANCE_STEP);
+		chebyshev->start_time = epoch + first_step*CHEBYSHEV_RESONANCE_STEP;
+		chebyshev->end_time = epoch + last_step*CHEBYSHEV_RESONANCE_STEP;
+		chebyshev->num_segments = last_step - first_step;
+	} else {
+		//start at half an orbit, which a circular orbit fits to well below a millimetre
+		double period = 1.0/orbital_elements->mean_motion;
+		chebyshev->num_segments = ceil(span/(0.5*period));
+	}
+
+	span = chebyshev->end_time - chebyshev->start_time;
+	while (true) {
+		chebyshev->segment_length = span/chebyshev->num_segments;
+		if (!chebyshev_fit(chebyshev, orbital_elements)) {
+			predict_destroy_chebyshev(chebyshev);
+			return false;
+		}
+		if ((chebyshev->max_position_error <= tolerance) || (chebyshev->segment_length < 2.0*CHEBYSHEV_MIN_SEGMENT_LENGTH)) {
+			return true;
+		}
+		chebyshev->num_segments *= 2;
+	}
+}
+
+/**
+ * Find the segment a time falls in.
+ *
+ * \param start_time Start of the first segment
+ * \param segment_length Length of each segment
+ * \param num_segments Number of segments
+ * \param time Time, within the segments
+ * \param x Returned position in the segment, [-1, 1]
+ * \return Segment index
+ **/
+static size_t chebyshev_segment(double start_time, double segment_length, size_t num_segments, double time, double *x)
+{
+	double offset = (time - start_time)/segment_length;
+	size_t segment = offset;
+	if (segment >= num_segments) {
+		segment = num_segments - 1;
+	}
+	*x = 2.0*(offset - segment) - 1.0;
+	return segment;
+}
+
+int predict_chebyshev_position(const predict_chebyshev_t *chebyshev, predict_julian_date_t time, double position[3], double velocity[3])
+{
+	if (!(time >= chebyshev->start_time) || !(time <= chebyshev->end_time)) {
+		return -1;
+	}
+
+	double x;
+	size_t segment = chebyshev_segment(chebyshev->start_time, chebyshev->segment_length, chebyshev->num_segments, time, &x);
+	const double *coefficients = &chebyshev->coefficients[segment*3*CHEBYSHEV_N];
+	chebyshev_evaluate(coefficients, x, position, velocity);
+	if (velocity != NULL) {
+		double velocity_scale = 2.0/(chebyshev->segment_length*SECONDS_PER_DAY);
+		for (int c=0; c < 3; c++) {
+			velocity[c] *= velocity_scale;
+		}
+	}
+	return 0;
+}
+
+void predict_destroy_chebyshev(predict_chebyshev_t *chebyshev)
+{
+	free(chebyshev->coefficients);
+	chebyshev->coefficients = NULL;
+	chebyshev->num_segments = 0;
+}
+
+/**
+ * Position of the moon as a vector, from its equatorial coordinates.
+ *
+ * \param time Julian date in UTC
+ * \param vector Returned vector along the direction of the moon, as long as its range approximation
+ **/
+static void chebyshev_moon_vector(predict_julian_date_t time, double vector[3])
+{
+	double right_ascension, declination, sidereal_time, range;
+	moon_equatorial(time, &right_ascension, &declination, &sidereal_time, &range);
+	vector[0] = range*cos(declination)*cos(right_ascension);
+	vector[1] = range*cos(declination)*sin(right_ascension);
+	vector[2] = range*sin(declination);
+}
+
+/**
+ * Fit the segments of the sun and moon table and check them against the series.
+ *
+ * \param ephemeris Table with span and number of segments set. Coefficients and errors are filled in
+ * \return false if out of memory
+ **/
+static bool chebyshev_ephemeris_fit(predict_ephemeris_t *ephemeris)
+{
+	double *coefficients = malloc(ephemeris->num_segments*6*CHEBYSHEV_N*sizeof(double));
+	if (coefficients == NULL) {
+		return false;
+	}
+
+	double basis[CHEBYSHEV_N][CHEBYSHEV_N];
+	chebyshev_basis(basis);
+
+	double max_sun_error = 0.0;
+	double max_moon_error = 0.0;
+	for (size_t i=0; i < ephemeris->num_segments; i++) {
+		double segment_start = ephemeris->start_time + i*ephemeris->segment_length;
+		double sun[CHEBYSHEV_SAMPLES][3], moon[CHEBYSHEV_SAMPLES][3];
+		for (int k=0; k < CHEBYSHEV_SAMPLES; k++) {
+			double time = segment_start + 0.5*ephemeris->segment_length*(chebyshev_sample_point(k) + 1.0);
+			sun_predict(time, sun[k]);
+			chebyshev_moon_vector(time, moon[k]);
+		}
+
+		double sun_nodes[CHEBYSHEV_N][3], moon_nodes[CHEBYSHEV_N][3];
+		for (int k=0; k < CHEBYSHEV_N; k++) {
+			for (int c=0; c < 3; c++) {
+				sun_nodes[k][c] = sun[2*k][c];
+				moon_nodes[k][c] = moon[2*k][c];
+			}
+		}
+		double *segment_coefficients = &coefficients[i*6*CHEBYSHEV_N];
+		chebyshev_coefficients(basis, sun_nodes, segment_coefficients);
+		chebyshev_coefficients(basis, moon_nodes, &segment_coefficients[3*CHEBYSHEV_N]);
+
+		for (int k=1; k < CHEBYSHEV_SAMPLES; k += 2) {
+			double sun_fit[3], moon_fit[3], sun_difference[3], moon_difference[3];
+			chebyshev_evaluate(segment_coefficients, chebyshev_sample_point(k), sun_fit, NULL);
+			chebyshev_evaluate(&segment_coefficients[3*CHEBYSHEV_N], chebyshev_sample_point(k), moon_fit, NULL);
+			vec3_sub(sun_fit, sun[k], sun_difference);
+			vec3_sub(moon_fit, moon[k], moon_difference);
+			max_sun_error = fmax(max_sun_error, vec3_length(sun_difference)/vec3_length(sun[k]));
+			max_moon_error = fmax(max_moon_error, vec3_length(moon_difference)/vec3_length(moon[k]));
+		}
+	}
+
+	free(ephemeris->coefficients);
+	ephemeris->coefficients = coefficients;
+	ephemeris->max_sun_error = max_sun_error;
+	ephemeris->max_moon_error = max_moon_error;
+	return true;
+}
+
+bool predict_create_ephemeris(predict_ephemeris_t *ephemeris, predict_julian_date_t start_time, predict_julian_date_t end_time, double tolerance)
+{
+	ephemeris->start_time = start_time;
+	ephemeris->end_time = end_time;
+	ephemeris->coefficients = NULL;
+	ephemeris->max_sun_error = 0.0;
+	ephemeris->max_moon_error = 0.0;
+
+	double span = end_time - start_time;
+	if (!(span > 0.0)) {
+		return false;
+	}
+
+	ephemeris->num_segments = ceil(span/CHEBYSHEV_EPHEMERIS_SEGMENT_LENGTH);
+	while (true) {
+		ephemeris->segment_length = span/ephemeris->num_segments;
+		if (!chebyshev_ephemeris_fit(ephemeris)) {
+			predict_destroy_ephemeris(ephemeris);
+			return false;
+		}
+		if ((fmax(ephemeris->max_sun_error, ephemeris->max_moon_error) <= tolerance) || (ephemeris->segment_length < 2.0*CHEBYSHEV_EPHEMERIS_MIN_SEGMENT_LENGTH)) {
+			return true;
+		}
+		ephemeris->num_segments *= 2;
+	}
+}
+
+void predict_create_time_context_ephemeris(predict_time_context_t *context, const predict_ephemeris_t *ephemeris, predict_julian_date_t time, bool moon)
+{
+	if (!(time >= ephemeris->start_time) || !(time <= ephemeris->end_time)) {
+		predict_create_time_context(context, time, moon);
+		return;
+	}
+
+	double x;
+	size_t segment = chebyshev_segment(ephemeris->start_time, ephemeris->segment_length, ephemeris->num_segments, time, &x);
+	const double *coefficients = &ephemeris->coefficients[segment*6*CHEBYSHEV_N];
+	context->time = time;
+	context->gmst = ThetaG_JD(time);
+	chebyshev_evaluate(coefficients, x, context->sun_position, NULL);
+	context->has_moon = moon;
+	if (moon) {
+		double vector[3];
+		chebyshev_evaluate(&coefficients[3*CHEBYSHEV_N], x, vector, NULL);
+		double range = vec3_length(vector);
+		double right_ascension = atan2(vector[1], vector[0]);
+		context->moon_right_ascension = (right_ascension < 0.0) ? right_ascension + 2.0*M_PI : right_ascension;
+		context->moon_declination = asin(vector[2]/range);
+		context->moon_sidereal_time = moon_sidereal_time(time);
+		context->moon_range = range;
+	}
+}
+
+void predict_destroy_ephemeris(predict_ephemeris_t *ephemeris)
+{
+	free(ephemeris->coefficients);
+	ephemeris->coefficients = NULL;
+	ephemeris->num_segments = 0;
+}
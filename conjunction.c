@@ -0,0 +1,620 @@
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "predict.h"
+#include "unsorted.h"
+#include "defs.h"
+#include "parallel.h"
+
+//coarse time step of the proximity pass, in days
+#define CONJUNCTION_TIME_STEP (60.0/SECONDS_PER_DAY)
+
+//tolerance on the time of closest approach, in days
+#define CONJUNCTION_TIME_TOLERANCE (1.0e-3/SECONDS_PER_DAY)
+
+//margin on the perigee and apogee from the mean elements for the short-periodic and
+//lunar-solar terms of the models, in km and relative to the apogee radius
+#define CONJUNCTION_SIEVE_MARGIN 20.0
+#define CONJUNCTION_SIEVE_RELATIVE_MARGIN 0.01
+
+//gravitational acceleration at the surface of the earth, in km/s^2
+#define CONJUNCTION_SURFACE_GRAVITY 9.81e-3
+
+/**
+ * Candidate close approach from the proximity pass: two satellites that may
+ * come within the threshold distance during a coarse time step.
+ **/
+struct conjunction_candidate {
+	uint32_t primary;
+	uint32_t secondary;
+	uint32_t step;
+};
+
+/**
+ * Growable array of candidates, one per thread.
+ **/
+struct conjunction_candidates {
+	struct conjunction_candidate *candidates;
+	size_t num_candidates;
+	size_t capacity;
+};
+
+/**
+ * Satellite in the spatial hash of the proximity pass.
+ **/
+struct conjunction_point {
+	double position[3];
+	double velocity[3];
+	int64_t cell[3];
+	///Radial range of the satellite for the sieve
+	double min_radius;
+	double max_radius;
+	uint32_t index;
+};
+
+/**
+ * Per-thread buffers of the proximity pass.
+ **/
+struct conjunction_thread {
+	double *position_x, *position_y, *position_z;
+	double *velocity_x, *velocity_y, *velocity_z;
+	///Hash bucket of each satellite, or UINT32_MAX if it could not be propagated
+	uint32_t *bucket;
+	///Start of each hash bucket in points, num_buckets + 1 entries
+	uint32_t *bucket_start;
+	///Satellites sorted by hash bucket
+	struct conjunction_point *points;
+	struct conjunction_candidates candidates;
+	bool out_of_memory;
+};
+
+/**
+ * Arguments of the proximity pass, shared read-only between the threads.
+ **/
+struct conjunction_context {
+	///Satellites that passed the sieve
+	const predict_orbital_elements_t *elements;
+	size_t num_elements;
+	///Radial range (km from the center of the earth) of each satellite, padded by the sieve margin
+	const double *min_radius;
+	const double *max_radius;
+	predict_julian_date_t start_time;
+	predict_julian_date_t end_time;
+	double threshold;
+	size_t num_buckets;
+	struct conjunction_thread *threads;
+};
+
+/**
+ * Append a candidate.
+ *
+ * \param candidates Candidates
+ * \param candidate Candidate to append
+ * \return false if out of memory
+ **/
+static bool conjunction_candidates_append(struct conjunction_candidates *candidates, struct conjunction_candidate candidate)
+{
+	if (candidates->num_candidates == candidates->capacity) {
+		size_t capacity = (candidates->capacity > 0) ? 2*candidates->capacity : 1024;
+		struct conjunction_candidate *resized = realloc(candidates->candidates, capacity*sizeof(struct conjunction_candidate));
+		if (resized == NULL) {
+			return false;
+		}
+		candidates->candidates = resized;
+		candidates->capacity = capacity;
+	}
+	candidates->candidates[candidates->num_candidates++] = candidate;
+	return true;
+}
+
+/**
+ * Time of a coarse step of the proximity pass.
+ **/
+static predict_julian_date_t conjunction_step_time(const struct conjunction_context *ctx, size_t step)
+{
+	return fmin(ctx->start_time + step*CONJUNCTION_TIME_STEP, ctx->end_time);
+}
+
+/**
+ * Hash bucket of a spatial hash cell.
+ **/
+static size_t conjunction_bucket(int64_t x, int64_t y, int64_t z, size_t num_buckets)
+{
+	uint64_t hash = (uint64_t)x*0x9E3779B97F4A7C15u + (uint64_t)y*0xC2B2AE3D27D4EB4Fu + (uint64_t)z*0x165667B19E3779F9u;
+	hash ^= hash >> 29;
+	hash *= 0xBF58476D1CE4E5B9u;
+	return (hash ^ (hash >> 32)) & (num_buckets - 1);
+}
+
+/**
+ * Find the pairs of satellites that may come within the threshold distance of each other during a range of coarse time steps.
+ *
+ * The satellites are put in a spatial hash with cells as large as the
+ * distance they can close during half a time step, so that such pairs lie
+ * in neighbouring cells. Each pair from neighbouring cells is checked
+ * against the sieve, and then for the closest distance along straight
+ * lines during the time step, padded for the curvature of the orbits.
+ **/
+static void conjunction_proximity_range(void *context, size_t begin, size_t end, int thread)
+{
+	struct conjunction_context *ctx = (struct conjunction_context*)context;
+	struct conjunction_thread *t = &ctx->threads[thread];
+	struct predict_position_arrays arrays = {t->position_x, t->position_y, t->position_z, t->velocity_x, t->velocity_y, t->velocity_z};
+	size_t n = ctx->num_elements;
+	double half_step = 0.5*CONJUNCTION_TIME_STEP*SECONDS_PER_DAY;
+
+	for (size_t step=begin; (step < end) && !t->out_of_memory; step++) {
+		predict_orbit_batch(ctx->elements, n, conjunction_step_time(ctx, step), &arrays);
+
+		double max_speed = 0.0;
+		for (size_t i=0; i < n; i++) {
+			double speed = sqrt(t->velocity_x[i]*t->velocity_x[i] + t->velocity_y[i]*t->velocity_y[i] + t->velocity_z[i]*t->velocity_z[i]);
+			if (isfinite(speed) && isfinite(t->position_x[i]) && (speed > max_speed)) {
+				max_speed = speed;
+			}
+		}
+
+		//two satellites close at most at twice the largest speed. Their relative motion is bent by
+		//the difference in gravity, at most 2*g*separation/R for separations up to twice the cell
+		//size, and a small fraction of g for the J2 and drag terms
+		double distance = ctx->threshold + 2.0*max_speed*half_step;
+		double acceleration = CONJUNCTION_SURFACE_GRAVITY*(4.0*distance/EARTH_RADIUS_KM_WGS84 + 0.01);
+		double curvature = 0.5*acceleration*half_step*half_step;
+		distance += curvature;
+		double reach = ctx->threshold + curvature;
+
+		//sort the satellites by hash bucket, so that each bucket is contiguous
+		for (size_t b=0; b <= ctx->num_buckets; b++) {
+			t->bucket_start[b] = 0;
+		}
+		for (size_t i=0; i < n; i++) {
+			t->bucket[i] = UINT32_MAX;
+			if (!isfinite(t->position_x[i]) || !isfinite(t->velocity_x[i])) {
+				continue;
+			}
+			int64_t x = floor(t->position_x[i]/distance);
+			int64_t y = floor(t->position_y[i]/distance);
+			int64_t z = floor(t->position_z[i]/distance);
+			t->bucket[i] = conjunction_bucket(x, y, z, ctx->num_buckets);
+			t->bucket_start[t->bucket[i] + 1]++;
+		}
+		for (size_t b=0; b < ctx->num_buckets; b++) {
+			t->bucket_start[b + 1] += t->bucket_start[b];
+		}
+		for (size_t i=0; i < n; i++) {
+			if (t->bucket[i] == UINT32_MAX) {
+				continue;
+			}
+			struct conjunction_point *point = &t->points[t->bucket_start[t->bucket[i]]++];
+			vec3_set(point->position, t->position_x[i], t->position_y[i], t->position_z[i]);
+			vec3_set(point->velocity, t->velocity_x[i], t->velocity_y[i], t->velocity_z[i]);
+			point->cell[0] = floor(t->position_x[i]/distance);
+			point->cell[1] = floor(t->position_y[i]/distance);
+			point->cell[2] = floor(t->position_z[i]/distance);
+			point->min_radius = ctx->min_radius[i];
+			point->max_radius = ctx->max_radius[i];
+			point->index = i;
+		}
+		//the scatter advanced each start to the end of its bucket
+		for (size_t b=ctx->num_buckets; b > 0; b--) {
+			t->bucket_start[b] = t->bucket_start[b - 1];
+		}
+		t->bucket_start[0] = 0;
+
+		size_t num_points = t->bucket_start[ctx->num_buckets];
+		for (size_t k=0; (k < num_points) && !t->out_of_memory; k++) {
+			const struct conjunction_point *p = &t->points[k];
+			//the own cell and the 13 neighbouring cells after it, so that each pair of cells is visited once
+			for (int neighbour=13; neighbour < 27; neighbour++) {
+				int64_t x = p->cell[0] + neighbour % 3 - 1;
+				int64_t y = p->cell[1] + (neighbour/3) % 3 - 1;
+				int64_t z = p->cell[2] + neighbour/9 - 1;
+				size_t bucket = conjunction_bucket(x, y, z, ctx->num_buckets);
+				for (size_t l=t->bucket_start[bucket]; l < t->bucket_start[bucket + 1]; l++) {
+					const struct conjunction_point *q = &t->points[l];
+					//other cells in the same bucket, and each pair within the own cell once
+					if ((q->cell[0] != x) || (q->cell[1] != y) || (q->cell[2] != z) || ((neighbour == 13) && (l <= k))) {
+						continue;
+					}
+					if ((p->min_radius > q->max_radius + ctx->threshold) || (q->min_radius > p->max_radius + ctx->threshold)) {
+						continue;
+					}
+
+					double dr[3] = {q->position[0] - p->position[0], q->position[1] - p->position[1], q->position[2] - p->position[2]};
+					double dv[3] = {q->velocity[0] - p->velocity[0], q->velocity[1] - p->velocity[1], q->velocity[2] - p->velocity[2]};
+					double dv2 = dv[0]*dv[0] + dv[1]*dv[1] + dv[2]*dv[2];
+					double closest = (dv2 > 0.0) ? fmax(-half_step, fmin(half_step, -(dr[0]*dv[0] + dr[1]*dv[1] + dr[2]*dv[2])/dv2)) : 0.0;
+					double d[3] = {dr[0] + dv[0]*closest, dr[1] + dv[1]*closest, dr[2] + dv[2]*closest};
+					if (d[0]*d[0] + d[1]*d[1] + d[2]*d[2] > reach*reach) {
+						continue;
+					}
+
+					uint32_t i = p->index, j = q->index;
+					struct conjunction_candidate candidate = {(i < j) ? i : j, (i < j) ? j : i, step};
+					if (!conjunction_candidates_append(&t->candidates, candidate)) {
+						t->out_of_memory = true;
+						break;
+					}
+				}
+			}
+		}
+	}
+}
+
+/**
+ * Relative position and velocity of two satellites.
+ *
+ * \param primary Orbital elements of the first satellite
+ * \param secondary Orbital elements of the second satellite
+ * \param time Julian date in UTC
+ * \param dr Returned position of the second satellite relative to the first, km
+ * \param dv Returned velocity of the second satellite relative to the first, km/s
+ * \return 0 on success, -1 if either orbit could not be predicted
+ **/
+static int conjunction_relative_state(const predict_orbital_elements_t *primary, const predict_orbital_elements_t *secondary, predict_julian_date_t time, double dr[3], double dv[3])
+{
+	struct predict_position x1, x2;
+	if ((predict_orbit_fields(primary, PREDICT_ORBIT_ECI, &x1, time) < 0) || (predict_orbit_fields(secondary, PREDICT_ORBIT_ECI, &x2, time) < 0)) {
+		return -1;
+	}
+	vec3_sub(x2.position, x1.position, dr);
+	vec3_sub(x2.velocity, x1.velocity, dv);
+	return 0;
+}
+
+/**
+ * Pair of satellites for brent_root(), which finds the zero of the range rate times the range.
+ **/
+struct conjunction_pair {
+	const predict_orbital_elements_t *primary;
+	const predict_orbital_elements_t *secondary;
+	predict_julian_date_t base_time;
+	bool failed;
+};
+
+static double conjunction_range_rate(double time, void *context)
+{
+	struct conjunction_pair *pair = (struct conjunction_pair*)context;
+	double dr[3], dv[3];
+	if (conjunction_relative_state(pair->primary, pair->secondary, pair->base_time + time, dr, dv) < 0) {
+		pair->failed = true;
+		return 0.0;
+	}
+	return vec3_dot(dr, dv);
+}
+
+/**
+ * Run of consecutive coarse time steps where a pair of satellites may come close, for the refinement.
+ **/
+struct conjunction_window {
+	uint32_t primary;
+	uint32_t secondary;
+	uint32_t first_step;
+	uint32_t last_step;
+};
+
+/**
+ * Arguments of the refinement, shared read-only between the threads.
+ **/
+struct conjunction_refine_context {
+	const struct conjunction_context *proximity;
+	///Index of each sieved satellite in the caller's array
+	const size_t *index;
+	const struct conjunction_window *windows;
+	///Found conjunctions of each thread
+	predict_conjunctions_t *found;
+	size_t *capacity;
+	bool *out_of_memory;
+};
+
+/**
+ * Find the times of closest approach within a range of windows.
+ *
+ * The range rate of a pair changes sign from negative to positive at each
+ * closest approach. It is sampled at the coarse time steps of the window
+ * and its zeros are refined with brent_root().
+ **/
+static void conjunction_refine_range(void *context, size_t begin, size_t end, int thread)
+{
+	struct conjunction_refine_context *ctx = (struct conjunction_refine_context*)context;
+	const struct conjunction_context *proximity = ctx->proximity;
+	predict_conjunctions_t *found = &ctx->found[thread];
+
+	for (size_t w=begin; (w < end) && !ctx->out_of_memory[thread]; w++) {
+		const struct conjunction_window *window = &ctx->windows[w];
+		struct conjunction_pair pair;
+		pair.primary = &proximity->elements[window->primary];
+		pair.secondary = &proximity->elements[window->secondary];
+		pair.base_time = fmax(proximity->start_time, conjunction_step_time(proximity, window->first_step) - 0.5*CONJUNCTION_TIME_STEP);
+		pair.failed = false;
+		double window_end = fmin(proximity->end_time, conjunction_step_time(proximity, window->last_step) + 0.5*CONJUNCTION_TIME_STEP) - pair.base_time;
+
+		double lower = 0.0;
+		double f_lower = conjunction_range_rate(lower, &pair);
+		for (uint32_t step=window->first_step; (step <= window->last_step) && !pair.failed; step++) {
+			double upper = fmin(conjunction_step_time(proximity, step) + 0.5*CONJUNCTION_TIME_STEP - pair.base_time, window_end);
+			if (upper <= lower) {
+				continue;
+			}
+			double f_upper = conjunction_range_rate(upper, &pair);
+			if ((f_lower < 0.0) && (f_upper >= 0.0)) {
+				double time = brent_root(conjunction_range_rate, &pair, lower, upper, f_lower, f_upper, CONJUNCTION_TIME_TOLERANCE);
+				double dr[3], dv[3];
+				if (!pair.failed && (conjunction_relative_state(pair.primary, pair.secondary, pair.base_time + time, dr, dv) == 0)
+					&& (vec3_length(dr) <= proximity->threshold)) {
+					if (found->num_conjunctions == ctx->capacity[thread]) {
+						size_t capacity = (ctx->capacity[thread] > 0) ? 2*ctx->capacity[thread] : 64;
+						struct predict_conjunction *resized = realloc(found->conjunctions, capacity*sizeof(struct predict_conjunction));
+						if (resized == NULL) {
+							ctx->out_of_memory[thread] = true;
+							break;
+						}
+						found->conjunctions = resized;
+						ctx->capacity[thread] = capacity;
+					}
+					struct predict_conjunction *conjunction = &found->conjunctions[found->num_conjunctions++];
+					conjunction->primary = ctx->index[window->primary];
+					conjunction->secondary = ctx->index[window->secondary];
+					conjunction->time = pair.base_time + time;
+					conjunction->miss_distance = vec3_length(dr);
+					conjunction->relative_velocity = vec3_length(dv);
+				}
+			}
+			lower = upper;
+			f_lower = f_upper;
+		}
+	}
+}
+
+/**
+ * Lower end of the radial range of a satellite, for sorting in conjunction_sieve().
+ **/
+struct conjunction_radius {
+	double min_radius;
+	size_t index;
+};
+
+static int conjunction_compare_radius(const void *a, const void *b)
+{
+	double ra = ((const struct conjunction_radius*)a)->min_radius;
+	double rb = ((const struct conjunction_radius*)b)->min_radius;
+	return (ra > rb) - (ra < rb);
+}
+
+static int conjunction_compare_candidates(const void *a, const void *b)
+{
+	const struct conjunction_candidate *ca = (const struct conjunction_candidate*)a;
+	const struct conjunction_candidate *cb = (const struct conjunction_candidate*)b;
+	if (ca->primary != cb->primary) {
+		return (ca->primary > cb->primary) - (ca->primary < cb->primary);
+	}
+	if (ca->secondary != cb->secondary) {
+		return (ca->secondary > cb->secondary) - (ca->secondary < cb->secondary);
+	}
+	return (ca->step > cb->step) - (ca->step < cb->step);
+}
+
+static int conjunction_compare_time(const void *a, const void *b)
+{
+	const struct predict_conjunction *ca = (const struct predict_conjunction*)a;
+	const struct predict_conjunction *cb = (const struct predict_conjunction*)b;
+	if (ca->time != cb->time) {
+		return (ca->time > cb->time) - (ca->time < cb->time);
+	}
+	if (ca->primary != cb->primary) {
+		return (ca->primary > cb->primary) - (ca->primary < cb->primary);
+	}
+	return (ca->secondary > cb->secondary) - (ca->secondary < cb->secondary);
+}
+
+/**
+ * Select the satellites whose radial range, padded by the threshold, overlaps that of at least one other satellite.
+ *
+ * \param min_radius Smallest radius of each satellite
+ * \param max_radius Largest radius of each satellite
+ * \param num_elements Number of satellites
+ * \param threshold Threshold distance
+ * \param selected Returned flag for each satellite
+ * \return false if out of memory
+ **/
+static bool conjunction_sieve(const double *min_radius, const double *max_radius, size_t num_elements, double threshold, bool *selected)
+{
+	struct conjunction_radius *order = malloc(num_elements*sizeof(struct conjunction_radius));
+	if (order == NULL) {
+		return false;
+	}
+	for (size_t i=0; i < num_elements; i++) {
+		order[i].min_radius = min_radius[i];
+		order[i].index = i;
+	}
+	qsort(order, num_elements, sizeof(struct conjunction_radius), conjunction_compare_radius);
+
+	//in order of the lower end, a range overlaps an earlier one if it starts before the
+	//largest upper end so far, and a later one if it ends after the next one starts
+	double max_upper = -INFINITY;
+	for (size_t k=0; k < num_elements; k++) {
+		size_t i = order[k].index;
+		bool earlier = (min_radius[i] <= max_upper + threshold);
+		bool later = (k + 1 < num_elements) && (max_radius[i] + threshold >= order[k + 1].min_radius);
+		selected[i] = earlier || later;
+		max_upper = fmax(max_upper, max_radius[i]);
+	}
+	free(order);
+	return true;
+}
+
+bool predict_screen_conjunctions(predict_conjunctions_t *conjunctions, const predict_orbital_elements_t *orbital_elements, size_t num_elements, predict_julian_date_t start_time, predict_julian_date_t end_time, double threshold, int num_threads)
+{
+	conjunctions->conjunctions = NULL;
+	conjunctions->num_conjunctions = 0;
+	if ((num_elements < 2) || !(end_time > start_time)) {
+		return true;
+	}
+	if (num_elements >= UINT32_MAX) {
+		return false;
+	}
+	if (num_threads <= 0) {
+		num_threads = parallel_default_threads();
+	}
+
+	//apogee/perigee sieve
+	double *all_min_radius = malloc(num_elements*sizeof(double));
+	double *all_max_radius = malloc(num_elements*sizeof(double));
+	bool *selected = malloc(num_elements*sizeof(bool));
+	predict_orbital_elements_t *elements = malloc(num_elements*sizeof(predict_orbital_elements_t));
+	size_t *index = malloc(num_elements*sizeof(size_t));
+	bool success = (all_min_radius != NULL) && (all_max_radius != NULL) && (selected != NULL) && (elements != NULL) && (index != NULL);
+	size_t n = 0;
+	if (success) {
+		for (size_t i=0; i < num_elements; i++) {
+			double apogee = predict_apogee(&orbital_elements[i]) + EARTH_RADIUS_KM_WGS84;
+			double margin = CONJUNCTION_SIEVE_MARGIN + CONJUNCTION_SIEVE_RELATIVE_MARGIN*apogee;
+			all_min_radius[i] = predict_perigee(&orbital_elements[i]) + EARTH_RADIUS_KM_WGS84 - margin;
+			all_max_radius[i] = apogee + margin;
+		}
+		success = conjunction_sieve(all_min_radius, all_max_radius, num_elements, threshold, selected);
+	}
+	if (success) {
+		for (size_t i=0; i < num_elements; i++) {
+			if (selected[i]) {
+				elements[n] = orbital_elements[i];
+				all_min_radius[n] = all_min_radius[i];
+				all_max_radius[n] = all_max_radius[i];
+				index[n] = i;
+				n++;
+			}
+		}
+	}
+	free(selected);
+
+	//proximity pass over the coarse time steps
+	struct conjunction_context context;
+	context.elements = elements;
+	context.num_elements = n;
+	context.min_radius = all_min_radius;
+	context.max_radius = all_max_radius;
+	context.start_time = start_time;
+	context.end_time = end_time;
+	context.threshold = threshold;
+	//sparse enough that most lookups of empty neighbouring cells find an empty bucket
+	context.num_buckets = 1;
+	while (context.num_buckets < 8*n) {
+		context.num_buckets *= 2;
+	}
+	context.threads = calloc(num_threads, sizeof(struct conjunction_thread));
+	success = success && (context.threads != NULL);
+	for (int t=0; success && (t < num_threads); t++) {
+		struct conjunction_thread *thread = &context.threads[t];
+		thread->position_x = malloc(6*n*sizeof(double));
+		thread->bucket = malloc(n*sizeof(uint32_t));
+		thread->bucket_start = malloc((context.num_buckets + 1)*sizeof(uint32_t));
+		thread->points = malloc(n*sizeof(struct conjunction_point));
+		success = (thread->position_x != NULL) && (thread->bucket != NULL) && (thread->bucket_start != NULL) && (thread->points != NULL);
+		if (success) {
+			thread->position_y = thread->position_x + n;
+			thread->position_z = thread->position_x + 2*n;
+			thread->velocity_x = thread->position_x + 3*n;
+			thread->velocity_y = thread->position_x + 4*n;
+			thread->velocity_z = thread->position_x + 5*n;
+		}
+	}
+
+	size_t num_steps = ceil((end_time - start_time)/CONJUNCTION_TIME_STEP) + 1;
+	if (success && (n >= 2)) {
+		parallel_for(num_steps, 1, num_threads, conjunction_proximity_range, &context);
+	}
+
+	//collect the candidates of all threads, and merge consecutive time steps of a pair into windows
+	size_t num_candidates = 0;
+	for (int t=0; success && (t < num_threads); t++) {
+		success = !context.threads[t].out_of_memory;
+		num_candidates += context.threads[t].candidates.num_candidates;
+	}
+	struct conjunction_candidate *candidates = success ? malloc((num_candidates + 1)*sizeof(struct conjunction_candidate)) : NULL;
+	struct conjunction_window *windows = success ? malloc((num_candidates + 1)*sizeof(struct conjunction_window)) : NULL;
+	success = success && (candidates != NULL) && (windows != NULL);
+	size_t num_windows = 0;
+	if (success) {
+		size_t k = 0;
+		for (int t=0; t < num_threads; t++) {
+			for (size_t c=0; c < context.threads[t].candidates.num_candidates; c++) {
+				candidates[k++] = context.threads[t].candidates.candidates[c];
+			}
+		}
+		qsort(candidates, num_candidates, sizeof(struct conjunction_candidate), conjunction_compare_candidates);
+		for (size_t c=0; c < num_candidates; c++) {
+			struct conjunction_window *last = (num_windows > 0) ? &windows[num_windows - 1] : NULL;
+			if ((last != NULL) && (last->primary == candidates[c].primary) && (last->secondary == candidates[c].secondary) && (last->last_step + 1 >= candidates[c].step)) {
+				last->last_step = candidates[c].step;
+				continue;
+			}
+			struct conjunction_window window = {candidates[c].primary, candidates[c].secondary, candidates[c].step, candidates[c].step};
+			windows[num_windows++] = window;
+		}
+	}
+	for (int t=0; (context.threads != NULL) && (t < num_threads); t++) {
+		free(context.threads[t].position_x);
+		free(context.threads[t].bucket);
+		free(context.threads[t].bucket_start);
+		free(context.threads[t].points);
+		free(context.threads[t].candidates.candidates);
+	}
+	free(context.threads);
+	free(candidates);
+
+	//time of closest approach refinement
+	predict_conjunctions_t *found = calloc(num_threads, sizeof(predict_conjunctions_t));
+	size_t *capacity = calloc(num_threads, sizeof(size_t));
+	bool *out_of_memory = calloc(num_threads, sizeof(bool));
+	success = success && (found != NULL) && (capacity != NULL) && (out_of_memory != NULL);
+	if (success) {
+		struct conjunction_refine_context refine_context;
+		refine_context.proximity = &context;
+		refine_context.index = index;
+		refine_context.windows = windows;
+		refine_context.found = found;
+		refine_context.capacity = capacity;
+		refine_context.out_of_memory = out_of_memory;
+		parallel_for(num_windows, 16, num_threads, conjunction_refine_range, &refine_context);
+
+		size_t num_found = 0;
+		for (int t=0; t < num_threads; t++) {
+			success = success && !out_of_memory[t];
+			num_found += found[t].num_conjunctions;
+		}
+		conjunctions->conjunctions = success ? malloc((num_found + 1)*sizeof(struct predict_conjunction)) : NULL;
+		success = success && (conjunctions->conjunctions != NULL);
+		for (int t=0; success && (t < num_threads); t++) {
+			for (size_t c=0; c < found[t].num_conjunctions; c++) {
+				conjunctions->conjunctions[conjunctions->num_conjunctions++] = found[t].conjunctions[c];
+			}
+		}
+		if (success) {
+			qsort(conjunctions->conjunctions, conjunctions->num_conjunctions, sizeof(struct predict_conjunction), conjunction_compare_time);
+		}
+	}
+	for (int t=0; (found != NULL) && (t < num_threads); t++) {
+		free(found[t].conjunctions);
+	}
+	free(found);
+	free(capacity);
+	free(out_of_memory);
+	free(windows);
+	free(all_min_radius);
+	free(all_max_radius);
+	free(elements);
+	free(index);
+
+	if (!success) {
+		predict_destroy_conjunctions(conjunctions);
+	}
+	return success;
+}
+
+void predict_destroy_conjunctions(predict_conjunctions_t *conjunctions)
+{
+	free(conjunctions->conjunctions);
+	conjunctions->conjunctions = NULL;
+	conjunctions->num_conjunctions = 0;
+}
@@ -65,6 +65,8 @@
 #define SPEED_OF_LIGHT				299792458.0
 ///Angular velocity of Earth in radians per seconds
 #define EARTH_ANGULAR_VELOCITY			7.292115E-5
+///Gravitational parameter of Earth in km^3/s^2, as given by XKE
+#define EARTH_GRAVITATIONAL_PARAMETER		(XKE*XKE*EARTH_RADIUS_KM_WGS84*EARTH_RADIUS_KM_WGS84*EARTH_RADIUS_KM_WGS84/3600.0)
 ///@}
 
 /** \name Iteration constants
@@ -74,10 +76,20 @@
 ///@{
 ///Threshold used for fine-tuning of AOS/LOS
 #define AOSLOS_HORIZON_THRESHOLD 	0.3
-///Threshold used for comparing lower and upper brackets in find_max_elevation
+///Offset from the first maximum found by predict_at_max_elevation() to the brackets searched for another
 #define MAXELE_TIME_EQUALITY_THRESHOLD 	FLT_EPSILON
-///Maximum number of iterations in find_max_elevation
-#define MAXELE_MAX_NUM_ITERATIONS 	10000
+///Tolerance on the time of maximum elevation in find_max_elevation, in days
+#define MAXELE_TIME_TOLERANCE 		(1.0e-3/SECONDS_PER_DAY)
+///Shortest time step of the scan in predict_passes(), in days. Passes shorter than this may be missed
+#define PASSES_MIN_TIME_STEP		(10.0/SECONDS_PER_DAY)
+///Tolerance on the times of AOS, LOS, TCA and maximum elevation in predict_passes(), in days
+#define PASSES_TIME_TOLERANCE		(1.0e-2/SECONDS_PER_DAY)
+///Part of its time step by which predict_passes_observers() may bring an observation forward, to share the propagation with other observers
+#define PASSES_SHARED_STEP_FRACTION	0.5
+///Margin on the perigee radius for the short-periodic terms of the models, in perigee_radius_bound(), in km
+#define PERIGEE_RADIUS_MARGIN		20.0
+///Lowest radius returned by perigee_radius_bound(), in km
+#define PERIGEE_RADIUS_MIN		(1.01*EARTH_RADIUS_KM_WGS84)
 ///@}
 
 /** \name General spacetrack report #3 constants
@@ -0,0 +1,215 @@
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "predict.h"
+#include "unsorted.h"
+#include "defs.h"
+
+//longest and shortest spacing of the knots, in seconds. Below the shortest, the tolerance is given up on
+#define DOPPLER_MAX_KNOT_STEP 120.0
+#define DOPPLER_MIN_KNOT_STEP 0.5
+
+/**
+ * Range rate of a satellite and its derivative at a knot.
+ **/
+struct doppler_knot {
+	///Time in seconds from the start of the profile
+	double time;
+	///Range rate, km/s
+	double range_rate;
+	///Derivative of the range rate, km/s^2
+	double range_acceleration;
+};
+
+/**
+ * Calculate the range rate of a satellite and its derivative.
+ *
+ * The derivative uses the acceleration of the satellite from the central
+ * field and J2. Any difference from the orbit model shows up in the check of
+ * the interpolation, and the knots are placed closer.
+ *
+ * \param observer Prepared observer
+ * \param orbital_elements Orbital elements of satellite
+ * \param start_time Start of the profile
+ * \param time Time in seconds from the start
+ * \param knot Returned knot
+ * \return 0 on success, -1 if the orbit could not be predicted
+ **/
+static int doppler_calculate(const predict_prepared_observer_t *observer, const predict_orbital_elements_t *orbital_elements, predict_julian_date_t start_time, double time, struct doppler_knot *knot)
+{
+	struct predict_position orbit;
+	predict_julian_date_t julian_time = start_time + time/SECONDS_PER_DAY;
+	if (predict_orbit_fields(orbital_elements, PREDICT_ORBIT_ECI, &orbit, julian_time) != 0) {
+		return -1;
+	}
+
+	//observer in ECI, turning with the earth
+	double gmst = ThetaG_JD(julian_time);
+	double sin_gmst = sin(gmst), cos_gmst = cos(gmst);
+	double observer_position[3], observer_velocity[3], observer_acceleration[3];
+	vec3_set(observer_position, cos_gmst*observer->position[0] - sin_gmst*observer->position[1], sin_gmst*observer->position[0] + cos_gmst*observer->position[1], observer->position[2]);
+	vec3_set(observer_velocity, -EARTH_ANGULAR_VELOCITY*observer_position[1], EARTH_ANGULAR_VELOCITY*observer_position[0], 0.0);
+	vec3_set(observer_acceleration, -EARTH_ANGULAR_VELOCITY*observer_velocity[1], EARTH_ANGULAR_VELOCITY*observer_velocity[0], 0.0);
+
+	//acceleration of the satellite
+	double radius = vec3_length(orbit.position);
+	double z2 = pow(orbit.position[2]/radius, 2);
+	double j2 = 3.0*CK2*pow(EARTH_RADIUS_KM_WGS84/radius, 2);
+	double central = -EARTH_GRAVITATIONAL_PARAMETER/(radius*radius*radius);
+	double acceleration[3];
+	vec3_set(acceleration, central*orbit.position[0]*(1.0 + j2*(1.0 - 5.0*z2)), central*orbit.position[1]*(1.0 + j2*(1.0 - 5.0*z2)), central*orbit.position[2]*(1.0 + j2*(3.0 - 5.0*z2)));
+
+	double range[3], range_velocity[3], range_acceleration[3];
+	vec3_sub(orbit.position, observer_position, range);
+	vec3_sub(orbit.velocity, observer_velocity, range_velocity);
+	vec3_sub(acceleration, observer_acceleration, range_acceleration);
+	double range_length = vec3_length(range);
+	double range_rate = vec3_dot(range, range_velocity)/range_length;
+
+	knot->time = time;
+	knot->range_rate = range_rate;
+	knot->range_acceleration = (vec3_dot(range_velocity, range_velocity) + vec3_dot(range, range_acceleration) - range_rate*range_rate)/range_length;
+	return 0;
+}
+
+/**
+ * Evaluate the cubic Hermite interpolant of the range rate between two knots.
+ *
+ * \param lower Knot at the start of the interval
+ * \param upper Knot at the end of the interval
+ * \param time Time in seconds from the start of the profile
+ * \param derivative Returned derivative of the range rate, km/s^2. May be NULL
+ * \return Range rate, km/s
+ **/
+static double doppler_interpolate(const struct doppler_knot *lower, const struct doppler_knot *upper, double time, double *derivative)
+{
+	double h = upper->time - lower->time;
+	return hermite_interpolate((time - lower->time)/h, h, lower->range_rate, lower->range_acceleration, upper->range_rate, upper->range_acceleration, derivative);
+}
+
+/**
+ * Append a knot.
+ *
+ * \param knots Knots
+ * \param num_knots Number of knots, updated
+ * \param capacity Allocated number of knots, updated
+ * \param knot Knot to append
+ * \return false if out of memory
+ **/
+static bool doppler_add_knot(struct doppler_knot **knots, size_t *num_knots, size_t *capacity, const struct doppler_knot *knot)
+{
+	if (*num_knots == *capacity) {
+		size_t new_capacity = (*capacity > 0) ? 2*(*capacity) : 16;
+		struct doppler_knot *resized = realloc(*knots, new_capacity*sizeof(struct doppler_knot));
+		if (resized == NULL) {
+			return false;
+		}
+		*knots = resized;
+		*capacity = new_capacity;
+	}
+	(*knots)[(*num_knots)++] = *knot;
+	return true;
+}
+
+bool predict_create_doppler_profile(predict_doppler_profile_t *profile, const predict_observer_t *observer, const predict_orbital_elements_t *orbital_elements, predict_julian_date_t start_time, predict_julian_date_t end_time, double time_step, const double *frequencies, size_t num_frequencies, double tolerance)
+{
+	memset(profile, 0, sizeof(predict_doppler_profile_t));
+
+	end_time = fmin(end_time, orbital_elements->decay_time);
+	double duration = (end_time - start_time)*SECONDS_PER_DAY;
+	if (!(duration >= 0.0) || !(time_step > 0.0) || (num_frequencies == 0)) {
+		return false;
+	}
+
+	//tolerance on the range rate from that on the shift of the highest frequency
+	double max_frequency = 0.0;
+	for (size_t j=0; j < num_frequencies; j++) {
+		max_frequency = fmax(max_frequency, fabs(frequencies[j]));
+	}
+	double hz_per_range_rate = max_frequency*1000.0/SPEED_OF_LIGHT;
+	double range_rate_tolerance = (hz_per_range_rate > 0.0) ? tolerance/hz_per_range_rate : INFINITY;
+
+	predict_prepared_observer_t prepared;
+	predict_prepare_observer(&prepared, observer);
+
+	//place the knots in time order, halving the spacing until the interpolant meets the exact range rate
+	//halfway between the knots, where the error of a cubic Hermite interpolant is largest
+	struct doppler_knot *knots = NULL;
+	size_t num_knots = 0, capacity = 0;
+	struct doppler_knot lower, upper, middle;
+	double step = fmin(DOPPLER_MAX_KNOT_STEP, duration);
+	double max_error = 0.0;
+	bool success = (doppler_calculate(&prepared, orbital_elements, start_time, 0.0, &lower) == 0) && doppler_add_knot(&knots, &num_knots, &capacity, &lower);
+	while (success && (lower.time < duration)) {
+		double upper_time = fmin(lower.time + step, duration);
+		success = (doppler_calculate(&prepared, orbital_elements, start_time, upper_time, &upper) == 0);
+		while (success) {
+			double h = upper.time - lower.time;
+			success = (doppler_calculate(&prepared, orbital_elements, start_time, lower.time + 0.5*h, &middle) == 0);
+			double error = fabs(doppler_interpolate(&lower, &upper, middle.time, NULL) - middle.range_rate);
+			if ((error <= range_rate_tolerance) || (h <= DOPPLER_MIN_KNOT_STEP)) {
+				max_error = fmax(max_error, error);
+				step = fmin(2.0*h, DOPPLER_MAX_KNOT_STEP);
+				break;
+			}
+			upper = middle;
+		}
+		success = success && doppler_add_knot(&knots, &num_knots, &capacity, &upper);
+		lower = upper;
+	}
+
+	size_t num_samples = (size_t)floor(duration/time_step) + 1;
+	profile->frequencies = malloc(num_frequencies*sizeof(double));
+	profile->range_rate = malloc(num_samples*sizeof(double));
+	profile->range_rate_derivative = malloc(num_samples*sizeof(double));
+	profile->doppler_shift = malloc(num_samples*num_frequencies*sizeof(double));
+	if (!success || (profile->frequencies == NULL) || (profile->range_rate == NULL) || (profile->range_rate_derivative == NULL) || (profile->doppler_shift == NULL)) {
+		free(knots);
+		predict_destroy_doppler_profile(profile);
+		return false;
+	}
+	memcpy(profile->frequencies, frequencies, num_frequencies*sizeof(double));
+	profile->start_time = start_time;
+	profile->time_step = time_step;
+	profile->num_samples = num_samples;
+	profile->num_frequencies = num_frequencies;
+	profile->num_knots = num_knots;
+	profile->max_error = max_error*hz_per_range_rate;
+
+	//samples and knots are both in time order, so the interval of each sample is found by walking the knots
+	size_t knot = 0;
+	for (size_t i=0; i < num_samples; i++) {
+		double time = i*time_step;
+		while ((knot + 2 < num_knots) && (knots[knot + 1].time < time)) {
+			knot++;
+		}
+		double range_rate;
+		if (num_knots == 1) {
+			range_rate = knots[0].range_rate;
+			profile->range_rate_derivative[i] = knots[0].range_acceleration;
+		} else {
+			range_rate = doppler_interpolate(&knots[knot], &knots[knot + 1], time, &profile->range_rate_derivative[i]);
+		}
+		profile->range_rate[i] = range_rate;
+		//as predict_doppler_shift()
+		for (size_t j=0; j < num_frequencies; j++) {
+			profile->doppler_shift[i*num_frequencies + j] = -frequencies[j]*range_rate*1000.0/SPEED_OF_LIGHT;
+		}
+	}
+	free(knots);
+	return true;
+}
+
+void predict_destroy_doppler_profile(predict_doppler_profile_t *profile)
+{
+	free(profile->frequencies);
+	free(profile->range_rate);
+	free(profile->range_rate_derivative);
+	free(profile->doppler_shift);
+	profile->frequencies = NULL;
+	profile->range_rate = NULL;
+	profile->range_rate_derivative = NULL;
+	profile->doppler_shift = NULL;
+	profile->num_samples = 0;
+}
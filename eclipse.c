@@ -0,0 +1,180 @@
+#include <math.h>
+#include <stdlib.h>
+
+#include "predict.h"
+#include "unsorted.h"
+#include "defs.h"
+#include "sun.h"
+
+//shortest time step of the scan, in days. Shadow crossings closer together than this may be missed
+#define ECLIPSE_MIN_TIME_STEP (1.0/SECONDS_PER_DAY)
+
+//tolerance on the time of the events, in days
+#define ECLIPSE_TIME_TOLERANCE (1.0e-2/SECONDS_PER_DAY)
+
+//margin on the radial speed for the short-periodic terms of the models, in km/s
+#define ECLIPSE_RADIAL_SPEED_MARGIN 0.05
+
+//angular speed of the sun along the ecliptic, with a margin, in radians per second
+#define ECLIPSE_SUN_ANGULAR_SPEED (1.1*TWO_PI/(365.25*SECONDS_PER_DAY))
+
+/**
+ * Shadow depths of a satellite, as the eclipse depth of predict_orbit().
+ **/
+struct eclipse_depth {
+	predict_julian_date_t time;
+	///Depth into the umbra in radians, positive in the umbra
+	double umbra;
+	///Depth into the penumbra in radians, positive in the penumbra or the umbra
+	double penumbra;
+};
+
+/**
+ * Calculate the shadow depths of a satellite. The umbra depth is that of is_eclipsed(), and the
+ * penumbra depth the same with the apparent radius of the sun added instead of subtracted.
+ *
+ * \param orbital_elements Orbital elements of satellite
+ * \param time Time
+ * \param depth Returned depths
+ **/
+static void eclipse_calculate(const predict_orbital_elements_t *orbital_elements, predict_julian_date_t time, struct eclipse_depth *depth)
+{
+	struct predict_position orbit;
+	predict_orbit_fields(orbital_elements, PREDICT_ORBIT_ECI, &orbit, time);
+	double solar_vector[3];
+	sun_predict(time, solar_vector);
+
+	double rho[3], earth[3];
+	double sd_earth = asin_(EARTH_RADIUS_KM_WGS84/vec3_length(orbit.position));
+	vec3_sub(solar_vector, orbit.position, rho);
+	double sd_sun = asin_(SOLAR_RADIUS_KM/vec3_length(rho));
+	vec3_mul_scalar(orbit.position, -1, earth);
+	double delta = acos_(vec3_dot(solar_vector, earth)/vec3_length(solar_vector)/vec3_length(earth));
+
+	depth->time = time;
+	depth->umbra = sd_earth - sd_sun - delta;
+	depth->penumbra = sd_earth + sd_sun - delta;
+}
+
+static double eclipse_umbra(double time, void *context)
+{
+	struct eclipse_depth depth;
+	eclipse_calculate((const predict_orbital_elements_t*)context, time, &depth);
+	return depth.umbra;
+}
+
+static double eclipse_penumbra(double time, void *context)
+{
+	struct eclipse_depth depth;
+	eclipse_calculate((const predict_orbital_elements_t*)context, time, &depth);
+	return depth.penumbra;
+}
+
+/**
+ * Upper bound on the rate of change of the shadow depths. The direction of the satellite from the
+ * centre of the earth turns at most at its angular speed at perigee, and the apparent radius of the
+ * earth changes with the radial speed, which is largest where the orbit crosses the latus rectum.
+ *
+ * \param orbital_elements Orbital elements of satellite
+ * \return Rate in radians per second
+ **/
+static double eclipse_max_depth_rate(const predict_orbital_elements_t *orbital_elements)
+{
+	double mean_motion = orbital_elements->mean_motion*TWO_PI/SECONDS_PER_DAY;
+	double semi_major_axis = cbrt(EARTH_GRAVITATIONAL_PARAMETER/(mean_motion*mean_motion));
+	double eccentricity = orbital_elements->eccentricity;
+	//kept clear of the surface, where the apparent radius of the earth changes without bound
+	double perigee_radius = perigee_radius_bound(orbital_elements);
+	double semi_latus_rectum = fmax(semi_major_axis*(1.0 - eccentricity*eccentricity), perigee_radius);
+
+	double perigee_speed = sqrt(EARTH_GRAVITATIONAL_PARAMETER*(2.0/perigee_radius - 1.0/semi_major_axis));
+	double radial_speed = eccentricity*sqrt(EARTH_GRAVITATIONAL_PARAMETER/semi_latus_rectum) + ECLIPSE_RADIAL_SPEED_MARGIN;
+	double angular_speed = perigee_speed/perigee_radius;
+	double earth_radius_rate = EARTH_RADIUS_KM_WGS84/(perigee_radius*sqrt(perigee_radius*perigee_radius - EARTH_RADIUS_KM_WGS84*EARTH_RADIUS_KM_WGS84))*radial_speed;
+	return 1.05*(angular_speed + earth_radius_rate) + ECLIPSE_SUN_ANGULAR_SPEED;
+}
+
+/**
+ * Append an event to the list.
+ *
+ * \param events Events
+ * \param capacity Allocated length of the list, updated
+ * \param type Type of event
+ * \param time Time of event
+ * \return false if out of memory
+ **/
+static bool eclipse_add_event(predict_eclipse_events_t *events, size_t *capacity, enum predict_eclipse_event_type type, double time)
+{
+	if (events->num_events == *capacity) {
+		size_t new_capacity = (*capacity > 0) ? 2*(*capacity) : 16;
+		struct predict_eclipse_event *resized = realloc(events->events, new_capacity*sizeof(struct predict_eclipse_event));
+		if (resized == NULL) {
+			return false;
+		}
+		events->events = resized;
+		*capacity = new_capacity;
+	}
+	events->events[events->num_events].time = time;
+	events->events[events->num_events].type = type;
+	events->num_events++;
+	return true;
+}
+
+bool predict_eclipse_events(const predict_orbital_elements_t *orbital_elements, predict_julian_date_t start_time, predict_julian_date_t end_time, predict_eclipse_events_t *events)
+{
+	events->events = NULL;
+	events->num_events = 0;
+
+	end_time = fmin(end_time, orbital_elements->decay_time);
+	if (!(end_time > start_time)) {
+		return true;
+	}
+
+	void *context = (void*)orbital_elements;
+	double max_rate = eclipse_max_depth_rate(orbital_elements)*SECONDS_PER_DAY;
+	size_t capacity = 0;
+	struct eclipse_depth previous, current;
+	eclipse_calculate(orbital_elements, start_time, &previous);
+
+	while (previous.time < end_time) {
+		//neither depth can change sign before the nearer of them could have reached zero
+		double distance = fmin(fabs(previous.umbra), fabs(previous.penumbra));
+		double time = fmin(previous.time + fmax(distance/max_rate, ECLIPSE_MIN_TIME_STEP), end_time);
+		eclipse_calculate(orbital_elements, time, &current);
+
+		bool penumbra_crossed = ((previous.penumbra >= 0.0) != (current.penumbra >= 0.0));
+		bool umbra_crossed = ((previous.umbra >= 0.0) != (current.umbra >= 0.0));
+		double penumbra_time = 0.0, umbra_time = 0.0;
+		if (penumbra_crossed) {
+			penumbra_time = brent_root(eclipse_penumbra, context, previous.time, current.time, previous.penumbra, current.penumbra, ECLIPSE_TIME_TOLERANCE);
+		}
+		if (umbra_crossed) {
+			umbra_time = brent_root(eclipse_umbra, context, previous.time, current.time, previous.umbra, current.umbra, ECLIPSE_TIME_TOLERANCE);
+		}
+
+		//the umbra lies within the penumbra: entering, the penumbra comes first, and leaving, the umbra
+		bool success = true;
+		if (penumbra_crossed && (current.penumbra >= 0.0)) {
+			success = success && eclipse_add_event(events, &capacity, PREDICT_PENUMBRA_ENTRY, penumbra_time);
+		}
+		if (umbra_crossed) {
+			success = success && eclipse_add_event(events, &capacity, (current.umbra >= 0.0) ? PREDICT_UMBRA_ENTRY : PREDICT_UMBRA_EXIT, umbra_time);
+		}
+		if (penumbra_crossed && (current.penumbra < 0.0)) {
+			success = success && eclipse_add_event(events, &capacity, PREDICT_PENUMBRA_EXIT, penumbra_time);
+		}
+		if (!success) {
+			predict_destroy_eclipse_events(events);
+			return false;
+		}
+		previous = current;
+	}
+	return true;
+}
+
+void predict_destroy_eclipse_events(predict_eclipse_events_t *events)
+{
+	free(events->events);
+	events->events = NULL;
+	events->num_events = 0;
+}
@@ -1,4 +1,7 @@
 #include "predict.h"
+#include "unsorted.h"
+#include "sun.h"
+#include "moon.h"
 
 #define SECONDS_IN_HOUR 3600.0
 #define SECONDS_IN_DAY 86400.0
@@ -34,4 +37,15 @@ uint64_t timestamp_ms_from_julian(predict_julian_date_t date)
 	}
 
 	return (uint64_t)((date - UNIX_EPOCH_IN_JULIAN) * (1000 * SECONDS_IN_DAY));
-}
\ No newline at end of file
+}
+
+void predict_create_time_context(predict_time_context_t *context, predict_julian_date_t time, bool moon)
+{
+	context->time = time;
+	context->gmst = ThetaG_JD(time);
+	sun_predict(time, context->sun_position);
+	context->has_moon = moon;
+	if (moon) {
+		moon_equatorial(time, &context->moon_right_ascension, &context->moon_declination, &context->moon_sidereal_time, &context->moon_range);
+	}
+}
@@ -4,6 +4,7 @@
 #include <string.h>
 #include "defs.h"
 #include "sun.h"
+#include "moon.h"
 
 /**
  * This function is used in the FindMoon() function.
@@ -34,6 +35,27 @@ struct moon {
 	double dx;
 };
 
+/**
+ * Greenwich sidereal time used by the moon model.
+ *
+ * \param jul_time Julian day in UTC
+ * \return Sidereal time in degrees
+ * \copyright GPLv2+
+ **/
+static double moon_teg(predict_julian_date_t jul_time)
+{
+	/* Find siderial time in radians */
+
+	double t=(jul_time-2451545.0)/36525.0;
+	double teg=280.46061837+360.98564736629*(jul_time-2451545.0)+(0.000387933*t-t*t/38710000.0)*t;
+
+	/* Subtracting 360 is exact, so fmod() gives the same as subtracting repeatedly */
+	if (teg>360.0)
+		teg=fmod(teg, 360.0);
+
+	return teg;
+}
+
 /**
  * Predict absolute, observer-independent properties of the moon.
  *
@@ -162,13 +184,7 @@ void predict_moon(predict_julian_date_t jul_time, struct moon *moon)
 	b=bt*M_PI/180.0;
 	lm=l*M_PI/180.0;
 
-	/* Find siderial time in radians */
-
-	t=(jul_time-2451545.0)/36525.0;
-	teg=280.46061837+360.98564736629*(jul_time-2451545.0)+(0.000387933*t-t*t/38710000.0)*t;
-
-	while (teg>360.0)
-		teg-=360.0;
+	teg = moon_teg(jul_time);
 
 	//output
 	moon->b = b;
@@ -178,7 +194,20 @@ void predict_moon(predict_julian_date_t jul_time, struct moon *moon)
 	moon->teg = teg;
 }
 
-void predict_observe_moon(const predict_observer_t *observer, predict_julian_date_t jul_time, struct predict_observation *obs)
+void moon_ecliptic(predict_julian_date_t jul_time, double *longitude, double *latitude, double *obliquity)
+{
+	struct moon moon;
+	predict_moon(jul_time, &moon);
+
+	double z=(moon.jd-2415020.5)/365.2422;
+	double ob=23.452294-(0.46845*z+5.9e-07*z*z)/3600.0;
+
+	*longitude = moon.lm;
+	*latitude = moon.b;
+	*obliquity = ob*M_PI/180.0;
+}
+
+void moon_equatorial(predict_julian_date_t jul_time, double *right_ascension, double *declination, double *sidereal_time, double *range)
 {
 	struct moon moon;
 	predict_moon(jul_time, &moon);
@@ -193,16 +222,31 @@ void predict_observe_moon(const predict_observer_t *observer, predict_julian_dat
 	double dec=asin(sin(moon.b)*cos(ob)+cos(moon.b)*sin(ob)*sin(moon.lm));
 	double ra=acos(cos(moon.b)*cos(moon.lm)/cos(dec));
 
-	if (moon.lm > M_PI)
+	/* Quadrant from the sign of the y component of the direction, which differs from */
+	/* that of sin(lm) near lm = 0 and lm = pi when the latitude is not zero */
+	if (cos(moon.b)*sin(moon.lm)*cos(ob) - sin(moon.b)*sin(ob) < 0.0)
 	{
 		ra = 2*M_PI - ra;
 	}
 
+	*right_ascension = ra;
+	*declination = dec;
+	*sidereal_time = moon.teg*M_PI/180.0;
+	*range = moon.dx;
+}
+
+double moon_sidereal_time(predict_julian_date_t jul_time)
+{
+	return moon_teg(jul_time)*M_PI/180.0;
+}
+
+void moon_observe(const predict_observer_t *observer, predict_julian_date_t jul_time, double ra, double dec, double sidereal_time, double range, struct predict_observation *obs)
+{
 	double n = observer->latitude;    /* North latitude of tracking station */
 	double e = observer->longitude;  /* East longitude of tracking station */
 
 
-	double th = FMod2p(moon.teg*M_PI/180.0 + e);
+	double th = FMod2p(sidereal_time + e);
 	double h=th-ra;
 
 	double az=atan2(sin(h),cos(h)*sin(n)-tan(dec)*cos(n))+M_PI;
@@ -215,7 +259,7 @@ void predict_observe_moon(const predict_observer_t *observer, predict_julian_dat
 	double mm=FMod2p(1.319238+jul_time*0.228027135);  /* mean moon position */
 	double t2=0.10976;
 	double t1=mm+t2*sin(mm);
-	double dv=0.01255*moon.dx*moon.dx*sin(t1)*(1.0+t2*cos(mm));
+	double dv=0.01255*range*range*sin(t1)*(1.0+t2*cos(mm));
 	dv=dv*4449.0;
 	t1=6378.0;
 	t2=384401.0;
@@ -227,10 +271,26 @@ void predict_observe_moon(const predict_observer_t *observer, predict_julian_dat
 	obs->time = jul_time;
 	obs->azimuth = az;
 	obs->elevation = el;
-	obs->range = moon.dx;
+	obs->range = range;
 	obs->range_rate = moon_dv;
 }
 
+void predict_observe_moon(const predict_observer_t *observer, predict_julian_date_t jul_time, struct predict_observation *obs)
+{
+	double ra, dec, sidereal_time, range;
+	moon_equatorial(jul_time, &ra, &dec, &sidereal_time, &range);
+	moon_observe(observer, jul_time, ra, dec, sidereal_time, range, obs);
+}
+
+void predict_observe_moon_context(const predict_observer_t *observer, const predict_time_context_t *context, struct predict_observation *obs)
+{
+	if (!context->has_moon) {
+		predict_observe_moon(observer, context->time, obs);
+		return;
+	}
+	moon_observe(observer, context->time, context->moon_right_ascension, context->moon_declination, context->moon_sidereal_time, context->moon_range, obs);
+}
+
 double predict_moon_gha(predict_julian_date_t jul_time)
 {
 	struct moon moon;
@@ -246,7 +306,9 @@ double predict_moon_gha(predict_julian_date_t jul_time)
 	double dec=asin(sin(moon.b)*cos(ob)+cos(moon.b)*sin(ob)*sin(moon.lm));
 	double ra=acos(cos(moon.b)*cos(moon.lm)/cos(dec));
 
-	if (moon.lm > M_PI)
+	/* Quadrant from the sign of the y component of the direction, which differs from */
+	/* that of sin(lm) near lm = 0 and lm = pi when the latitude is not zero */
+	if (cos(moon.b)*sin(moon.lm)*cos(ob) - sin(moon.b)*sin(ob) < 0.0)
 	{
 		ra = 2*M_PI - ra;
 	}
@@ -0,0 +1,49 @@
+#ifndef _MOON_H_
+#define _MOON_H_
+
+#include "predict.h"
+
+/**
+ * Ecliptic coordinates of the moon and the obliquity of the ecliptic used by
+ * moon_equatorial() to convert them to equatorial coordinates.
+ *
+ * \param jul_time Julian day in UTC
+ * \param longitude Returned ecliptic longitude in radians
+ * \param latitude Returned ecliptic latitude in radians
+ * \param obliquity Returned obliquity of the ecliptic in radians
+ **/
+void moon_ecliptic(predict_julian_date_t jul_time, double *longitude, double *latitude, double *obliquity);
+
+/**
+ * Equatorial coordinates of the moon, independent of the observer.
+ *
+ * \param jul_time Julian day in UTC
+ * \param right_ascension Returned right ascension in radians
+ * \param declination Returned declination in radians
+ * \param sidereal_time Returned Greenwich sidereal time of the moon model in radians
+ * \param range Returned range approximation, as in predict_observe_moon()
+ **/
+void moon_equatorial(predict_julian_date_t jul_time, double *right_ascension, double *declination, double *sidereal_time, double *range);
+
+/**
+ * Greenwich sidereal time of the moon model, as returned by moon_equatorial().
+ *
+ * \param jul_time Julian day in UTC
+ * \return Sidereal time in radians
+ **/
+double moon_sidereal_time(predict_julian_date_t jul_time);
+
+/**
+ * Observe the moon at known equatorial coordinates, from moon_equatorial().
+ *
+ * \param observer Observer
+ * \param jul_time Julian day in UTC
+ * \param ra Right ascension in radians
+ * \param dec Declination in radians
+ * \param sidereal_time Greenwich sidereal time of the moon model in radians
+ * \param range Range approximation
+ * \param obs Returned observation
+ **/
+void moon_observe(const predict_observer_t *observer, predict_julian_date_t jul_time, double ra, double dec, double sidereal_time, double range, struct predict_observation *obs);
+
+#endif
@@ -5,7 +5,7 @@
 #include "defs.h"
 #include "sun.h"
 
-void observer_calculate(const predict_observer_t *observer, double time, const double pos[3], const double vel[3], struct predict_observation *result);
+void observer_calculate(const predict_observer_t *observer, double gmst, const double pos[3], const double vel[3], struct predict_observation *result);
 
 void predict_create_observer(predict_observer_t *obs, const char *name, double lat, double lon, double alt)
 {
@@ -31,7 +31,7 @@ void predict_observe_orbit(const predict_observer_t *observer, const struct pred
 	
 	double julTime = orbit->time;
 
-	observer_calculate(observer, julTime, orbit->position, orbit->velocity, obs);
+	observer_calculate(observer, ThetaG_JD(julTime), orbit->position, orbit->velocity, obs);
 
 	// Calculate visibility status of the orbit: Orbit is visible if sun elevation is low enough and the orbit is above the horizon, but still in sunlight.
 	obs->visible = false;
@@ -43,7 +43,23 @@ void predict_observe_orbit(const predict_observer_t *observer, const struct pred
 	obs->time = orbit->time;
 }
 
-void observer_calculate(const predict_observer_t *observer, double time, const double pos[3], const double vel[3], struct predict_observation *result)
+void predict_observe_orbit_context(const predict_observer_t *observer, const struct predict_position *orbit, const predict_time_context_t *context, struct predict_observation *obs)
+{
+	if (obs == NULL) return;
+
+	observer_calculate(observer, context->gmst, orbit->position, orbit->velocity, obs);
+
+	// Visibility as in predict_observe_orbit(), with the sun from the context
+	obs->visible = false;
+	struct predict_observation sun_obs;
+	predict_observe_sun_context(observer, context, &sun_obs);
+	if (!(orbit->eclipsed) && (sun_obs.elevation*180.0/M_PI < NAUTICAL_TWILIGHT_SUN_ELEVATION) && (obs->elevation*180.0/M_PI > 0)) {
+		obs->visible = true;
+	}
+	obs->time = orbit->time;
+}
+
+void observer_calculate(const predict_observer_t *observer, double gmst, const double pos[3], const double vel[3], struct predict_observation *result)
 {
 	
 		/* The procedures Calculate_Obs and Calculate_RADec calculate         */
@@ -73,7 +89,7 @@ void observer_calculate(const predict_observer_t *observer, double time, const d
 	geodetic.lon = observer->longitude;
 	geodetic.alt = observer->altitude / 1000.0;
 	geodetic.theta = 0.0;
-	Calculate_User_PosVel(time, &geodetic, obs_pos, obs_vel);
+	Calculate_User_PosVel_gmst(gmst, &geodetic, obs_pos, obs_vel);
 
 	vec3_sub(pos, obs_pos, range);
 	vec3_sub(vel, obs_vel, rgvel);
@@ -133,6 +149,126 @@ void observer_calculate(const predict_observer_t *observer, double time, const d
 
 }
 
+void predict_prepare_observer(predict_prepared_observer_t *prepared, const predict_observer_t *observer)
+{
+	//position as in Calculate_User_PosVel_gmst(), at zero sidereal time
+	double sin_lat = sin(observer->latitude), cos_lat = cos(observer->latitude);
+	double sin_lon = sin(observer->longitude), cos_lon = cos(observer->longitude);
+	double c = 1.0/sqrt(1.0 + FLATTENING_FACTOR*(FLATTENING_FACTOR - 2.0)*sin_lat*sin_lat);
+	double sq = (1.0 - FLATTENING_FACTOR)*(1.0 - FLATTENING_FACTOR)*c;
+	double altitude = observer->altitude/1000.0;
+	double achcp = (EARTH_RADIUS_KM_WGS84*c + altitude)*cos_lat;
+	vec3_set(prepared->position, achcp*cos_lon, achcp*sin_lon, (EARTH_RADIUS_KM_WGS84*sq + altitude)*sin_lat);
+
+	//rows of the rotation to the topocentric frame of observer_calculate()
+	vec3_set(prepared->south, sin_lat*cos_lon, sin_lat*sin_lon, -cos_lat);
+	vec3_set(prepared->east, -sin_lon, cos_lon, 0.0);
+	vec3_set(prepared->zenith, cos_lat*cos_lon, cos_lat*sin_lon, sin_lat);
+}
+
+/**
+ * Rotate an ECI position and velocity into the Earth-fixed frame.
+ *
+ * \param sin_gmst Sine of the Greenwich mean sidereal time
+ * \param cos_gmst Cosine of the Greenwich mean sidereal time
+ * \param pos ECI position, km
+ * \param vel ECI velocity, km/s
+ * \param position Returned position in the Earth-fixed frame, km
+ * \param velocity Returned velocity relative to the Earth-fixed frame, km/s
+ **/
+static void observer_earth_fixed(double sin_gmst, double cos_gmst, const double pos[3], const double vel[3], double position[3], double velocity[3])
+{
+	position[0] = cos_gmst*pos[0] + sin_gmst*pos[1];
+	position[1] = -sin_gmst*pos[0] + cos_gmst*pos[1];
+	position[2] = pos[2];
+	velocity[0] = cos_gmst*vel[0] + sin_gmst*vel[1] + EARTH_ANGULAR_VELOCITY*position[1];
+	velocity[1] = -sin_gmst*vel[0] + cos_gmst*vel[1] - EARTH_ANGULAR_VELOCITY*position[0];
+	velocity[2] = vel[2];
+}
+
+/**
+ * Calculate range, azimuth, elevation and their rates from a prepared observer, as observer_calculate() does.
+ *
+ * \param observer Prepared observer
+ * \param gmst Greenwich mean sidereal time, from ThetaG_JD()
+ * \param pos ECI position of the satellite, km
+ * \param vel ECI velocity of the satellite, km/s
+ * \param result Returned observation. The time and visibility are not set
+ **/
+static void observer_prepared_calculate(const predict_prepared_observer_t *observer, double gmst, const double pos[3], const double vel[3], struct predict_observation *result)
+{
+	double sin_gmst = sin(gmst), cos_gmst = cos(gmst);
+	double position[3], velocity[3];
+	observer_earth_fixed(sin_gmst, cos_gmst, pos, vel, position, velocity);
+
+	double range[3];
+	vec3_sub(position, observer->position, range);
+	double range_length = vec3_length(range);
+	double range_rate_length = vec3_dot(range, velocity)/range_length;
+
+	double top_s = vec3_dot(observer->south, range);
+	double top_e = vec3_dot(observer->east, range);
+	double top_z = vec3_dot(observer->zenith, range);
+	double top_s_dot = vec3_dot(observer->south, velocity);
+	double top_e_dot = vec3_dot(observer->east, velocity);
+	double top_z_dot = vec3_dot(observer->zenith, velocity);
+
+	// Azimut
+	double y = -top_e / top_s;
+	double az = atan(-top_e / top_s);
+
+	if (top_s > 0.0) az = az + M_PI;
+	if (az < 0.0) az = az + 2*M_PI;
+
+	// Azimut rate
+	double y_dot = - (top_e_dot*top_s - top_s_dot*top_e) / (top_s*top_s);
+	double az_dot = y_dot / (1 + y*y);
+
+	// Elevation
+	double x = top_z / range_length;
+	double el = asin_(x);
+
+	// Elevation rate
+	double x_dot = (top_z_dot*range_length - range_rate_length*top_z) / (range_length * range_length);
+	double el_dot = x_dot / sqrt( 1 - x*x );
+
+	result->azimuth = az;
+	result->azimuth_rate = az_dot;
+	result->elevation = el;
+	result->elevation_rate = el_dot;
+	result->range = range_length;
+	result->range_rate = range_rate_length;
+
+	//range vector in ECI, as observer_calculate() returns it
+	result->range_x = pos[0] - (cos_gmst*observer->position[0] - sin_gmst*observer->position[1]);
+	result->range_y = pos[1] - (sin_gmst*observer->position[0] + cos_gmst*observer->position[1]);
+	result->range_z = pos[2] - observer->position[2];
+}
+
+void predict_observe_orbit_prepared(const predict_prepared_observer_t *observer, const struct predict_position *orbit, const predict_time_context_t *context, struct predict_observation *obs)
+{
+	if (obs == NULL) return;
+
+	double gmst, solar_vector[3];
+	if (context != NULL) {
+		gmst = context->gmst;
+		vec3_set(solar_vector, context->sun_position[0], context->sun_position[1], context->sun_position[2]);
+	} else {
+		gmst = ThetaG_JD(orbit->time);
+		sun_predict(orbit->time, solar_vector);
+	}
+	observer_prepared_calculate(observer, gmst, orbit->position, orbit->velocity, obs);
+
+	//visibility as in predict_observe_orbit(), with the elevation of the sun from the prepared observer
+	double zero_vector[3] = {0, 0, 0};
+	double sun_range[3], sun_velocity[3];
+	observer_earth_fixed(sin(gmst), cos(gmst), solar_vector, zero_vector, sun_range, sun_velocity);
+	vec3_sub(sun_range, observer->position, sun_range);
+	double sun_elevation = asin_(vec3_dot(observer->zenith, sun_range)/vec3_length(sun_range));
+	obs->visible = !(orbit->eclipsed) && (sun_elevation*180.0/M_PI < NAUTICAL_TWILIGHT_SUN_ELEVATION) && (obs->elevation*180.0/M_PI > 0);
+	obs->time = orbit->time;
+}
+
 struct predict_observation predict_next_aos(const predict_observer_t *observer, const predict_orbital_elements_t *orbital_elements, double start_utc)
 {
 	double curr_time = start_utc;
@@ -251,20 +387,62 @@ struct predict_observation predict_next_los(const predict_observer_t *observer,
 }
 
 /**
- * Convenience function for calculation of derivative of elevation at specific time.
+ * Satellite and observer of predict_passes() and find_max_elevation(), for the root finding.
+ **/
+struct observer_pass_search {
+	const predict_observer_t *observer;
+	const predict_orbital_elements_t *orbital_elements;
+	predict_prepared_observer_t prepared;
+};
+
+/**
+ * Observe a satellite using only the ECI position and velocity from the orbit model.
  *
- * \param observer Ground station
- * \param orbital_elements Orbital elements for satellite
+ * \param search Satellite and observer
  * \param time Time
- * \return Derivative of elevation at input time
+ * \param obs Returned observation. The visibility status is not set
  **/
-double elevation_derivative(const predict_observer_t *observer, const predict_orbital_elements_t *orbital_elements, double time)
+static void observer_pass_observe(struct observer_pass_search *search, double time, struct predict_observation *obs)
 {
 	struct predict_position orbit;
-	struct predict_observation observation;
-	predict_orbit(orbital_elements, &orbit, time);
-	predict_observe_orbit(observer, &orbit, &observation);
-	return observation.elevation_rate;
+	predict_orbit_fields(search->orbital_elements, PREDICT_ORBIT_ECI, &orbit, time);
+	observer_prepared_calculate(&search->prepared, ThetaG_JD(time), orbit.position, orbit.velocity, obs);
+	obs->time = time;
+}
+
+/**
+ * Observe a satellite with all fields, for the reported observations of predict_passes().
+ *
+ * \param search Satellite and observer
+ * \param time Time
+ * \param obs Returned observation
+ **/
+static void observer_pass_observe_all(const struct observer_pass_search *search, double time, struct predict_observation *obs)
+{
+	struct predict_position orbit;
+	predict_orbit(search->orbital_elements, &orbit, time);
+	predict_observe_orbit(search->observer, &orbit, obs);
+}
+
+static double observer_pass_elevation(double time, void *context)
+{
+	struct predict_observation obs;
+	observer_pass_observe((struct observer_pass_search*)context, time, &obs);
+	return obs.elevation;
+}
+
+static double observer_pass_elevation_rate(double time, void *context)
+{
+	struct predict_observation obs;
+	observer_pass_observe((struct observer_pass_search*)context, time, &obs);
+	return obs.elevation_rate;
+}
+
+static double observer_pass_range_rate(double time, void *context)
+{
+	struct predict_observation obs;
+	observer_pass_observe((struct observer_pass_search*)context, time, &obs);
+	return obs.range_rate;
 }
 
 /**
@@ -278,32 +456,23 @@ double elevation_derivative(const predict_observer_t *observer, const predict_or
  **/
 struct predict_observation find_max_elevation(const predict_observer_t *observer, const predict_orbital_elements_t *orbital_elements, double lower_time, double upper_time)
 {
-	double max_ele_time_candidate = (upper_time + lower_time)/2.0;
-	int iteration = 0;
-	while ((fabs(lower_time - upper_time) > MAXELE_TIME_EQUALITY_THRESHOLD) && (iteration < MAXELE_MAX_NUM_ITERATIONS)) {
-		max_ele_time_candidate = (upper_time + lower_time)/2.0;
-
-		//calculate derivatives for lower, upper and candidate
-		double candidate_deriv = elevation_derivative(observer, orbital_elements, max_ele_time_candidate);
-		double lower_deriv = elevation_derivative(observer, orbital_elements, lower_time);
-		double upper_deriv = elevation_derivative(observer, orbital_elements, upper_time);
-
-		//check whether derivative has changed sign
-		if (candidate_deriv*lower_deriv < 0) {
-			upper_time = max_ele_time_candidate;
-		} else if (candidate_deriv*upper_deriv < 0) {
-			lower_time = max_ele_time_candidate;
-		} else {
-			break;
-		}
-		iteration++;
+	struct observer_pass_search search;
+	search.observer = observer;
+	search.orbital_elements = orbital_elements;
+	predict_prepare_observer(&search.prepared, observer);
+
+	//the elevation rate changes sign at the maximum, refine it where it does
+	double lower_rate = observer_pass_elevation_rate(lower_time, &search);
+	double upper_rate = observer_pass_elevation_rate(upper_time, &search);
+	double max_ele_time;
+	if ((lower_rate > 0.0) != (upper_rate > 0.0)) {
+		max_ele_time = brent_root(observer_pass_elevation_rate, &search, lower_time, upper_time, lower_rate, upper_rate, MAXELE_TIME_TOLERANCE);
+	} else {
+		max_ele_time = (lower_rate > 0.0) ? upper_time : lower_time;
 	}
 
-	//prepare output
-	struct predict_position orbit;
 	struct predict_observation observation;
-	predict_orbit(orbital_elements, &orbit, max_ele_time_candidate);
-	predict_observe_orbit(observer, &orbit, &observation);
+	observer_pass_observe_all(&search, max_ele_time, &observation);
 	return observation;
 }
 
@@ -355,6 +524,381 @@ struct predict_observation predict_at_max_elevation(const predict_observer_t *ob
 	}
 }
 
+/**
+ * Upper bound on the speed of a satellite relative to an observer, its speed at perigee plus that of the observer.
+ *
+ * \param observer Ground station
+ * \param orbital_elements Orbital elements of satellite
+ * \return Speed in km/s
+ **/
+static double observer_pass_max_speed(const predict_observer_t *observer, const predict_orbital_elements_t *orbital_elements)
+{
+	double mean_motion = orbital_elements->mean_motion*TWO_PI/SECONDS_PER_DAY;
+	double semi_major_axis = cbrt(EARTH_GRAVITATIONAL_PARAMETER/(mean_motion*mean_motion));
+	double observer_radius = EARTH_RADIUS_KM_WGS84 + observer->altitude/1000.0;
+	double perigee_radius = perigee_radius_bound(orbital_elements);
+	return 1.05*sqrt(EARTH_GRAVITATIONAL_PARAMETER*(2.0/perigee_radius - 1.0/semi_major_axis)) + EARTH_ANGULAR_VELOCITY*observer_radius;
+}
+
+/**
+ * Bracket of the time of an extremum within a pass, between two scan points.
+ **/
+struct observer_pass_bracket {
+	double lower, upper;
+	double f_lower, f_upper;
+	///Best value of the quantity at either end, for choosing between brackets
+	double value;
+	bool found;
+};
+
+/**
+ * Refine an extremum of a pass, or use the best scan point of the pass if there was no bracket.
+ *
+ * \param search Satellite and observer
+ * \param func Derivative of the quantity, which changes sign at the extremum
+ * \param bracket Bracket
+ * \param fallback_time Time of the best scan point
+ * \param obs Returned observation
+ **/
+static void observer_pass_refine(struct observer_pass_search *search, brent_func func, const struct observer_pass_bracket *bracket, double fallback_time, struct predict_observation *obs)
+{
+	double time = fallback_time;
+	if (bracket->found) {
+		time = brent_root(func, search, bracket->lower, bracket->upper, bracket->f_lower, bracket->f_upper, PASSES_TIME_TOLERANCE);
+	}
+	observer_pass_observe_all(search, time, obs);
+}
+
+/**
+ * Append a pass.
+ *
+ * \param passes Passes
+ * \param capacity Allocated number of passes
+ * \param pass Pass to append
+ * \return false if out of memory
+ **/
+static bool observer_passes_append(predict_passes_t *passes, size_t *capacity, const struct predict_pass *pass)
+{
+	if (passes->num_passes == *capacity) {
+		size_t new_capacity = (*capacity > 0) ? 2*(*capacity) : 16;
+		struct predict_pass *resized = realloc(passes->passes, new_capacity*sizeof(struct predict_pass));
+		if (resized == NULL) {
+			return false;
+		}
+		passes->passes = resized;
+		*capacity = new_capacity;
+	}
+	passes->passes[passes->num_passes++] = *pass;
+	return true;
+}
+
+/**
+ * Scan of the passes over one observer, fed one observation at a time.
+ **/
+struct observer_pass_scan {
+	struct observer_pass_search search;
+	predict_passes_t *passes;
+	size_t capacity;
+	double max_speed;
+	struct predict_observation previous;
+	bool in_pass;
+	struct predict_pass pass;
+	struct observer_pass_bracket max_elevation, closest;
+	double highest_time, nearest_time;
+	double highest, nearest;
+};
+
+/**
+ * Start a scan.
+ *
+ * \param scan Returned scan
+ * \param observer Ground station
+ * \param orbital_elements Orbital elements of satellite
+ * \param passes Passes to append to
+ * \param first Observation at the start of the interval, from observer_pass_observe()
+ **/
+static void observer_pass_scan_start(struct observer_pass_scan *scan, const predict_observer_t *observer, const predict_orbital_elements_t *orbital_elements, predict_passes_t *passes, const struct predict_observation *first)
+{
+	scan->search.observer = observer;
+	scan->search.orbital_elements = orbital_elements;
+	predict_prepare_observer(&scan->search.prepared, observer);
+	scan->passes = passes;
+	scan->capacity = 0;
+	scan->max_speed = observer_pass_max_speed(observer, orbital_elements);
+	scan->previous = *first;
+	scan->in_pass = (first->elevation >= 0.0);
+	scan->max_elevation.found = false;
+	scan->closest.found = false;
+	scan->highest_time = scan->nearest_time = first->time;
+	scan->highest = first->elevation;
+	scan->nearest = first->range;
+	if (scan->in_pass) {
+		observer_pass_observe_all(&scan->search, first->time, &scan->pass.aos);
+	}
+}
+
+/**
+ * Longest time step the scan can take from its last observation.
+ *
+ * \param scan Scan
+ * \return Time step in days
+ **/
+static double observer_pass_scan_step(const struct observer_pass_scan *scan)
+{
+	//step no further than the elevation can change sign within, except near the horizon. The elevation
+	//changes at most at max_speed/range, and the range shrinks at most at max_speed, so it takes at
+	//least range*(1 - exp(-|elevation|))/max_speed to reach the horizon
+	double step = scan->previous.range*(1.0 - exp(-fabs(scan->previous.elevation)))/scan->max_speed/SECONDS_PER_DAY;
+	double max_step = 0.1/scan->search.orbital_elements->mean_motion;
+	return fmin(fmax(step, PASSES_MIN_TIME_STEP), max_step);
+}
+
+/**
+ * Feed the next observation to a scan, finishing and appending a pass when the satellite sets or the interval ends.
+ *
+ * \param scan Scan
+ * \param current Observation after the last one, from observer_pass_observe()
+ * \param end_time End of the interval
+ * \return false if out of memory
+ **/
+static bool observer_pass_scan_next(struct observer_pass_scan *scan, const struct predict_observation *current, double end_time)
+{
+	struct observer_pass_search *search = &scan->search;
+	struct predict_observation *previous = &scan->previous;
+	struct predict_pass *pass = &scan->pass;
+
+	if (!scan->in_pass && (current->elevation >= 0.0)) {
+		//acquisition of signal
+		double aos_time = brent_root(observer_pass_elevation, search, previous->time, current->time, previous->elevation, current->elevation, PASSES_TIME_TOLERANCE);
+		observer_pass_observe_all(search, aos_time, &pass->aos);
+		*previous = pass->aos;
+		scan->in_pass = true;
+		scan->max_elevation.found = false;
+		scan->closest.found = false;
+		scan->highest_time = scan->nearest_time = aos_time;
+		scan->highest = previous->elevation;
+		scan->nearest = previous->range;
+	}
+
+	if (scan->in_pass) {
+		//bracket the highest maximum of the elevation and the lowest minimum of the range
+		double pass_end = current->time, pass_end_elevation_rate = current->elevation_rate, pass_end_range_rate = current->range_rate;
+		bool los = (current->elevation < 0.0);
+		if (los) {
+			//loss of signal
+			double los_time = brent_root(observer_pass_elevation, search, previous->time, current->time, previous->elevation, current->elevation, PASSES_TIME_TOLERANCE);
+			observer_pass_observe_all(search, los_time, &pass->los);
+			pass_end = los_time;
+			pass_end_elevation_rate = pass->los.elevation_rate;
+			pass_end_range_rate = pass->los.range_rate;
+		} else if (current->elevation > scan->highest) {
+			scan->highest = current->elevation;
+			scan->highest_time = current->time;
+		}
+		if (!los && (current->range < scan->nearest)) {
+			scan->nearest = current->range;
+			scan->nearest_time = current->time;
+		}
+
+		if ((previous->elevation_rate > 0.0) && (pass_end_elevation_rate <= 0.0) && (!scan->max_elevation.found || (fmax(previous->elevation, current->elevation) > scan->max_elevation.value))) {
+			struct observer_pass_bracket bracket = {previous->time, pass_end, previous->elevation_rate, pass_end_elevation_rate, fmax(previous->elevation, current->elevation), true};
+			scan->max_elevation = bracket;
+		}
+		if ((previous->range_rate < 0.0) && (pass_end_range_rate >= 0.0) && (!scan->closest.found || (-fmin(previous->range, current->range) > scan->closest.value))) {
+			struct observer_pass_bracket bracket = {previous->time, pass_end, previous->range_rate, pass_end_range_rate, -fmin(previous->range, current->range), true};
+			scan->closest = bracket;
+		}
+
+		if (los || (current->time >= end_time)) {
+			observer_pass_refine(search, observer_pass_elevation_rate, &scan->max_elevation, scan->highest_time, &pass->max_elevation);
+			observer_pass_refine(search, observer_pass_range_rate, &scan->closest, scan->nearest_time, &pass->tca);
+			if (!los) {
+				observer_pass_observe_all(search, end_time, &pass->los);
+			}
+			if (!observer_passes_append(scan->passes, &scan->capacity, pass)) {
+				return false;
+			}
+			scan->in_pass = false;
+		}
+	}
+	*previous = *current;
+	return true;
+}
+
+bool predict_passes(const predict_observer_t *observer, const predict_orbital_elements_t *orbital_elements, predict_julian_date_t start_time, predict_julian_date_t end_time, predict_passes_t *passes)
+{
+	passes->passes = NULL;
+	passes->num_passes = 0;
+
+	//the satellite is never above the horizon, or decays before the interval
+	end_time = fmin(end_time, orbital_elements->decay_time);
+	if (!predict_aos_happens(orbital_elements, observer->latitude) || !(end_time > start_time)) {
+		return true;
+	}
+
+	struct observer_pass_search search;
+	search.observer = observer;
+	search.orbital_elements = orbital_elements;
+	predict_prepare_observer(&search.prepared, observer);
+	struct predict_observation obs;
+	observer_pass_observe(&search, start_time, &obs);
+	struct observer_pass_scan scan;
+	observer_pass_scan_start(&scan, observer, orbital_elements, passes, &obs);
+
+	double time = start_time;
+	while (time < end_time) {
+		time = fmin(time + observer_pass_scan_step(&scan), end_time);
+		observer_pass_observe(&search, time, &obs);
+		if (!observer_pass_scan_next(&scan, &obs, end_time)) {
+			predict_destroy_passes(passes);
+			return false;
+		}
+	}
+	return true;
+}
+
+/**
+ * Times of the next observation of an observer in predict_passes_observers().
+ **/
+struct observer_pass_site {
+	///Time the observer should be observed at, at the latest
+	double next_time;
+	///Time from when a propagation can be shared with the observer
+	double earliest_time;
+};
+
+/**
+ * Elevation, range and their rates of a satellite from a prepared observer, as observer_prepared_calculate()
+ * calculates them, for a satellite already in the Earth-fixed frame.
+ *
+ * \param observer Prepared observer
+ * \param position Satellite position in the Earth-fixed frame, km
+ * \param velocity Satellite velocity relative to the Earth-fixed frame, km/s
+ * \param time Time
+ * \param obs Returned observation. Only the time, elevation, range and their rates are set
+ **/
+static void observer_pass_site_observe(const predict_prepared_observer_t *observer, const double position[3], const double velocity[3], double time, struct predict_observation *obs)
+{
+	double range[3];
+	vec3_sub(position, observer->position, range);
+	double range_length = vec3_length(range);
+	double range_rate = vec3_dot(range, velocity)/range_length;
+	double top_z = vec3_dot(range, observer->zenith);
+	double top_z_dot = vec3_dot(velocity, observer->zenith);
+
+	double x = top_z/range_length;
+	double x_dot = (top_z_dot*range_length - range_rate*top_z)/(range_length*range_length);
+	obs->time = time;
+	obs->elevation = asin_(x);
+	obs->elevation_rate = x_dot/sqrt(1.0 - x*x);
+	obs->range = range_length;
+	obs->range_rate = range_rate;
+}
+
+/**
+ * Set the times of the next observation of a site, after its scan has been fed an observation.
+ *
+ * \param site Site
+ * \param scan Scan of the site
+ * \param end_time End of the interval
+ **/
+static void observer_pass_site_schedule(struct observer_pass_site *site, const struct observer_pass_scan *scan, double end_time)
+{
+	double step = observer_pass_scan_step(scan);
+	site->next_time = (scan->previous.time < end_time) ? fmin(scan->previous.time + step, end_time) : INFINITY;
+	site->earliest_time = site->next_time - PASSES_SHARED_STEP_FRACTION*step;
+}
+
+/**
+ * Propagate a satellite into the Earth-fixed frame, for predict_passes_observers().
+ *
+ * \param orbital_elements Orbital elements of satellite
+ * \param time Time
+ * \param position Returned position in the Earth-fixed frame, km
+ * \param velocity Returned velocity relative to the Earth-fixed frame, km/s
+ **/
+static void observer_pass_earth_fixed(const predict_orbital_elements_t *orbital_elements, double time, double position[3], double velocity[3])
+{
+	struct predict_position orbit;
+	predict_orbit_fields(orbital_elements, PREDICT_ORBIT_ECI, &orbit, time);
+	double gmst = ThetaG_JD(time);
+	observer_earth_fixed(sin(gmst), cos(gmst), orbit.position, orbit.velocity, position, velocity);
+}
+
+bool predict_passes_observers(const predict_observer_t *observers, size_t num_observers, const predict_orbital_elements_t *orbital_elements, predict_julian_date_t start_time, predict_julian_date_t end_time, predict_passes_t *passes)
+{
+	for (size_t i=0; i < num_observers; i++) {
+		passes[i].passes = NULL;
+		passes[i].num_passes = 0;
+	}
+
+	end_time = fmin(end_time, orbital_elements->decay_time);
+	if (!(end_time > start_time) || (num_observers == 0)) {
+		return true;
+	}
+
+	//scans of the observers the satellite can rise over at all
+	struct observer_pass_scan *scans = malloc(num_observers*sizeof(struct observer_pass_scan));
+	struct observer_pass_site *sites = malloc(num_observers*sizeof(struct observer_pass_site));
+	if ((scans == NULL) || (sites == NULL)) {
+		free(scans);
+		free(sites);
+		return false;
+	}
+	//one propagation is shared by all observers due to be observed
+	double position[3], velocity[3];
+	struct predict_observation obs = {0};
+	observer_pass_earth_fixed(orbital_elements, start_time, position, velocity);
+	size_t num_scans = 0;
+	for (size_t i=0; i < num_observers; i++) {
+		if (predict_aos_happens(orbital_elements, observers[i].latitude)) {
+			predict_prepared_observer_t prepared;
+			predict_prepare_observer(&prepared, &observers[i]);
+			observer_pass_site_observe(&prepared, position, velocity, start_time, &obs);
+			observer_pass_scan_start(&scans[num_scans], &observers[i], orbital_elements, &passes[i], &obs);
+			observer_pass_site_schedule(&sites[num_scans], &scans[num_scans], end_time);
+			num_scans++;
+		}
+	}
+
+	bool success = true;
+	while (success) {
+		//each observer keeps its own time steps, but is brought forward to the next propagation when that
+		//falls in the last part of its step, so that observers share propagations
+		double time = INFINITY;
+		for (size_t i=0; i < num_scans; i++) {
+			time = fmin(time, sites[i].next_time);
+		}
+		if (time == INFINITY) {
+			break;
+		}
+
+		observer_pass_earth_fixed(orbital_elements, time, position, velocity);
+		for (size_t i=0; (i < num_scans) && success; i++) {
+			if (sites[i].earliest_time <= time) {
+				observer_pass_site_observe(&scans[i].search.prepared, position, velocity, time, &obs);
+				success = observer_pass_scan_next(&scans[i], &obs, end_time);
+				observer_pass_site_schedule(&sites[i], &scans[i], end_time);
+			}
+		}
+	}
+	free(scans);
+	free(sites);
+	if (!success) {
+		for (size_t i=0; i < num_observers; i++) {
+			predict_destroy_passes(&passes[i]);
+		}
+	}
+	return success;
+}
+
+void predict_destroy_passes(predict_passes_t *passes)
+{
+	free(passes->passes);
+	passes->passes = NULL;
+	passes->num_passes = 0;
+}
+
 double predict_doppler_shift(const struct predict_observation *obs, double frequency)
 {
 	double sat_range_rate = obs->range_rate*1000.0; //convert to m/s
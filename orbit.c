@@ -1,100 +1,26 @@
 #include <math.h>
-#include <string.h>
-#include <ctype.h>
+#include <stdatomic.h>
+#include <stdlib.h>
 
 #include "defs.h"
 #include "unsorted.h"
 #include "sdp4.h"
 #include "sgp4.h"
 #include "sun.h"
+#include "parallel.h"
 
 bool is_eclipsed(const double pos[3], const double sol[3], double *depth);
 bool predict_decayed(const predict_orbital_elements_t *orbital_elements, predict_julian_date_t time);
 
-//length of buffer used for extracting subsets of TLE strings for parsing
-#define SUBSTRING_BUFFER_LENGTH 50
-
-static bool checksum_tle(const char *tle_0, const char *tle_1)
-{
-  int i, check_a, check_b;
-
-  if(strlen(tle_0) < 69)
-  {
-    return false;
-  }
-
-  if(strlen(tle_1) < 69)
-  {
-    return false;
-  }
-
-  check_a = 0;
-  check_b = 0;
-
-  for(i=0; i<68; i++)
-  {
-    if(isdigit(tle_0[i]))
-    {
-      check_a += tle_0[i] - '0';
-    }
-    else if(tle_0[i] == '-')
-    {
-      check_a += 1;
-    }
-    
-    if(isdigit(tle_1[i]))
-    {
-      check_b += tle_1[i] - '0';
-    }
-    else if(tle_1[i] == '-')
-    {
-      check_b += 1;
-    }
-  }
-
-  if((check_a % 10) != (tle_0[68] - '0'))
-  {
-    return false;
-  }
-  
-  if((check_b % 10) != (tle_1[68] - '0'))
-  {
-    return false;
-  }
-
-  return true;
-}
-
 bool predict_parse_tle(predict_orbital_elements_t *m, const char *tle_line_1, const char *tle_line_2, struct predict_sgp4 *sgp4, struct predict_sdp4 *sdp4)
 {
 	if (m == NULL) return false;
 
-	if(!checksum_tle(tle_line_1, tle_line_2))
+	if (predict_tle_decode(m, tle_line_1, tle_line_2, NULL) != PREDICT_TLE_OK)
 	{
 		return false;
 	}
 
-	double tempnum;
-
-	char substring_buffer[SUBSTRING_BUFFER_LENGTH];
-	m->satellite_number = atol(SubString(tle_line_1,SUBSTRING_BUFFER_LENGTH,substring_buffer,2,6));
-	m->element_number = atol(SubString(tle_line_1,SUBSTRING_BUFFER_LENGTH,substring_buffer,64,67));
-	m->epoch_year = atoi(SubString(tle_line_1,SUBSTRING_BUFFER_LENGTH,substring_buffer,18,19));
-	strncpy(m->designator, SubString(tle_line_1,SUBSTRING_BUFFER_LENGTH,substring_buffer,9,16),8);
-	m->epoch_day = atof(SubString(tle_line_1,SUBSTRING_BUFFER_LENGTH,substring_buffer,20,31));
-	m->inclination = atof(SubString(tle_line_2,SUBSTRING_BUFFER_LENGTH,substring_buffer,8,15));
-	m->right_ascension = atof(SubString(tle_line_2,SUBSTRING_BUFFER_LENGTH,substring_buffer,17,24));
-	m->eccentricity = 1.0e-07*atof(SubString(tle_line_2,SUBSTRING_BUFFER_LENGTH,substring_buffer,26,32));
-	m->argument_of_perigee = atof(SubString(tle_line_2,SUBSTRING_BUFFER_LENGTH,substring_buffer,34,41));
-	m->mean_anomaly = atof(SubString(tle_line_2,SUBSTRING_BUFFER_LENGTH,substring_buffer,43,50));
-	m->mean_motion = atof(SubString(tle_line_2,SUBSTRING_BUFFER_LENGTH,substring_buffer,52,62));
-	m->derivative_mean_motion  = atof(SubString(tle_line_1,SUBSTRING_BUFFER_LENGTH,substring_buffer,33,42));
-	tempnum=1.0e-5*atof(SubString(tle_line_1,SUBSTRING_BUFFER_LENGTH,substring_buffer,44,49));
-	m->second_derivative_mean_motion = tempnum/pow(10.0,(tle_line_1[51]-'0'));
-	tempnum=1.0e-5*atof(SubString(tle_line_1,SUBSTRING_BUFFER_LENGTH,substring_buffer,53,58));
-	m->bstar_drag_term = tempnum/pow(10.0,(tle_line_1[60]-'0'));
-	m->revolutions_at_epoch = atof(SubString(tle_line_2,SUBSTRING_BUFFER_LENGTH,substring_buffer,63,67));
-
 	/* Period > 225 minutes is deep space */
 	double ao, xnodp, dd1, dd2, delo, a1, del1, r1;
 	double temp = TWO_PI/MINUTES_PER_DAY/MINUTES_PER_DAY;
@@ -192,9 +118,96 @@ bool predict_aos_happens(const predict_orbital_elements_t *m, double latitude)
 	}
 }
 
-/* This is the stuff we need to do repetitively while tracking. */
-/* This is the old Calc() function. */
-int predict_orbit(const predict_orbital_elements_t *orbital_elements, struct predict_position *m, predict_julian_date_t jul_time)
+/**
+ * Julian date of the epoch of a set of orbital elements.
+ *
+ * \param orbital_elements Orbital elements
+ * \return Julian date of TLE epoch
+ **/
+static double orbit_julian_epoch(const predict_orbital_elements_t *orbital_elements)
+{
+	double epoch = 1000.0*orbital_elements->epoch_year + orbital_elements->epoch_day;
+	return Julian_Date_of_Epoch(epoch);
+}
+
+/**
+ * Estimate time of orbit decay from the drag term of the orbital elements.
+ * Used by predict_tle_decode() to set the decay_time field.
+ *
+ * \param orbital_elements Orbital elements
+ * \return Julian date of decay
+ **/
+predict_julian_date_t orbit_decay_time(const predict_orbital_elements_t *orbital_elements)
+{
+	return orbit_julian_epoch(orbital_elements) + ((16.666666 - orbital_elements->mean_motion)/(10.0*fabs(orbital_elements->derivative_mean_motion)));
+}
+
+/**
+ * Run the NORAD model selected for the orbital elements.
+ *
+ * \param orbital_elements Orbital elements
+ * \param resonance Resonance integrator state of SDP4, or NULL to integrate from epoch
+ * \param tsince Time since epoch in minutes
+ * \param output Model output, in the normalized units of the model
+ * \return 0 on success, -1 if the ephemeris model is not supported
+ **/
+static int orbit_model_predict(const predict_orbital_elements_t *orbital_elements, struct predict_sdp4_resonance *resonance, double tsince, struct model_output *output)
+{
+	switch (orbital_elements->ephemeris) {
+		case EPHEMERIS_SDP4:
+			sdp4_predict_resonant((struct predict_sdp4*)orbital_elements->ephemeris_data, resonance, tsince, output);
+			return 0;
+		case EPHEMERIS_SGP4:
+			sgp4_predict((struct predict_sgp4*)orbital_elements->ephemeris_data, tsince, output);
+			return 0;
+		default:
+			//Panic!
+			return -1;
+	}
+}
+
+/**
+ * Per-satellite quantities used by predict_orbit() that do not depend on the time of prediction.
+ **/
+struct orbit_invariants {
+	///Julian date of TLE epoch
+	double jul_epoch;
+	///Mean motion in revolutions per day
+	double revs_per_day;
+	///Mean anomaly at epoch in revolutions
+	double revs_mean_anomaly;
+};
+
+/**
+ * Calculate the time-independent quantities of predict_orbit() for a satellite.
+ *
+ * \param orbital_elements Orbital elements
+ * \param inv Returned invariants
+ **/
+static void orbit_invariants_init(const predict_orbital_elements_t *orbital_elements, struct orbit_invariants *inv)
+{
+	double temp = TWO_PI/MINUTES_PER_DAY/MINUTES_PER_DAY;
+	double xno = orbital_elements->mean_motion*temp*MINUTES_PER_DAY;
+	double xmo = orbital_elements->mean_anomaly * M_PI / 180.0;
+
+	inv->jul_epoch = orbit_julian_epoch(orbital_elements);
+	inv->revs_per_day = xno*MINUTES_PER_DAY/(M_PI*2.0);
+	inv->revs_mean_anomaly = xmo/(2.0*M_PI);
+}
+
+/**
+ * Predict satellite orbit at given time, using precalculated invariants.
+ *
+ * \param orbital_elements Orbital elements
+ * \param inv Invariants of the orbital elements, from orbit_invariants_init()
+ * \param resonance Resonance integrator state of SDP4, or NULL to integrate from epoch
+ * \param fields Bitmask of enum predict_orbit_field to calculate
+ * \param m Predicted orbit
+ * \param jul_time Julian day in UTC
+ * \param context Sidereal time and sun position at jul_time, or NULL to calculate them
+ * \return 0 if everything went fine
+ **/
+static int orbit_predict_at(const predict_orbital_elements_t *orbital_elements, const struct orbit_invariants *inv, struct predict_sdp4_resonance *resonance, unsigned int fields, struct predict_position *m, predict_julian_date_t jul_time, const predict_time_context_t *context)
 {
 	m->time = jul_time;
 
@@ -202,24 +215,13 @@ int predict_orbit(const predict_orbital_elements_t *orbital_elements, struct pre
 	vec3_set(m->position, 0, 0, 0);
 	vec3_set(m->velocity, 0, 0, 0);
 
-	/* Convert satellite's epoch time to Julian  */
-	/* and calculate time since epoch in minutes */
-	double epoch = 1000.0*orbital_elements->epoch_year + orbital_elements->epoch_day;
-	double jul_epoch = Julian_Date_of_Epoch(epoch);
-	double tsince = (jul_time - jul_epoch)*MINUTES_PER_DAY;
+	/* Calculate time since epoch in minutes */
+	double tsince = (jul_time - inv->jul_epoch)*MINUTES_PER_DAY;
 
 	/* Call NORAD routines according to deep-space flag. */
 	struct model_output output;
-	switch (orbital_elements->ephemeris) {
-		case EPHEMERIS_SDP4:
-			sdp4_predict((struct predict_sdp4*)orbital_elements->ephemeris_data, tsince, &output);
-			break;
-		case EPHEMERIS_SGP4:
-			sgp4_predict((struct predict_sgp4*)orbital_elements->ephemeris_data, tsince, &output);
-			break;
-		default:
-			//Panic!
-			return -1;
+	if (orbit_model_predict(orbital_elements, resonance, tsince, &output) < 0) {
+		return -1;
 	}
 	m->position[0] = output.pos[0];
 	m->position[1] = output.pos[1];
@@ -236,92 +238,453 @@ int predict_orbit(const predict_orbital_elements_t *orbital_elements, struct pre
 	Convert_Sat_State(m->position, m->velocity);
 
 	/* Calculate satellite Lat North, Lon East and Alt. */
-	geodetic_t sat_geodetic;
-	Calculate_LatLonAlt(m->time, m->position, &sat_geodetic);
+	if (fields & (PREDICT_ORBIT_GEODETIC | PREDICT_ORBIT_FOOTPRINT)) {
+		geodetic_t sat_geodetic;
+		Calculate_LatLonAlt_gmst((context != NULL) ? context->gmst : ThetaG_JD(m->time), m->position, &sat_geodetic);
 
-	m->latitude = sat_geodetic.lat;
-	m->longitude = sat_geodetic.lon;
-	m->altitude = sat_geodetic.alt;
+		m->latitude = sat_geodetic.lat;
+		m->longitude = sat_geodetic.lon;
+		m->altitude = sat_geodetic.alt;
+	}
 
-	// Calculate solar position
-	double solar_vector[3];
-	sun_predict(m->time, solar_vector);
+	if (fields & PREDICT_ORBIT_ECLIPSE) {
+		// Calculate solar position
+		double solar_vector[3];
+		if (context != NULL) {
+			vec3_set(solar_vector, context->sun_position[0], context->sun_position[1], context->sun_position[2]);
+		} else {
+			sun_predict(m->time, solar_vector);
+		}
 
-	// Find eclipse depth and if sat is eclipsed
-	m->eclipsed = is_eclipsed(m->position, solar_vector, &m->eclipse_depth);
+		// Find eclipse depth and if sat is eclipsed
+		m->eclipsed = is_eclipsed(m->position, solar_vector, &m->eclipse_depth);
+	}
 
 	// Calculate footprint
-	m->footprint = 2.0*EARTH_RADIUS_KM_WGS84*acos(EARTH_RADIUS_KM_WGS84/(EARTH_RADIUS_KM_WGS84 + m->altitude));
-	
+	if (fields & PREDICT_ORBIT_FOOTPRINT) {
+		m->footprint = 2.0*EARTH_RADIUS_KM_WGS84*acos(EARTH_RADIUS_KM_WGS84/(EARTH_RADIUS_KM_WGS84 + m->altitude));
+	}
+
 	// Calculate current number of revolutions around Earth
-	double temp = TWO_PI/MINUTES_PER_DAY/MINUTES_PER_DAY;
-	double age = jul_time - jul_epoch;
-	double xno = orbital_elements->mean_motion*temp*MINUTES_PER_DAY;
-	double xmo = orbital_elements->mean_anomaly * M_PI / 180.0;
-	m->revolutions = (long)floor((xno*MINUTES_PER_DAY/(M_PI*2.0) + age*orbital_elements->bstar_drag_term)*age + xmo/(2.0*M_PI)) + orbital_elements->revolutions_at_epoch;
+	if (fields & PREDICT_ORBIT_REVOLUTIONS) {
+		double age = jul_time - inv->jul_epoch;
+		m->revolutions = (long)floor((inv->revs_per_day + age*orbital_elements->bstar_drag_term)*age + inv->revs_mean_anomaly) + orbital_elements->revolutions_at_epoch;
+	}
 
 	//calculate whether orbit is decayed
-	m->decayed = predict_decayed(orbital_elements, m->time);
+	if (fields & PREDICT_ORBIT_DECAY) {
+		m->decayed = predict_decayed(orbital_elements, m->time);
+	}
 
 	return 0;
 }
 
-time_t mktime_utc(const struct tm* timeinfo_utc)
+/* This is the stuff we need to do repetitively while tracking. */
+/* This is the old Calc() function. */
+int predict_orbit(const predict_orbital_elements_t *orbital_elements, struct predict_position *m, predict_julian_date_t jul_time)
 {
-	time_t curr_time = time(NULL);
-	int timezone_diff = 0; //deviation of the current timezone from UTC in seconds
-
-	//get UTC time, interpret resulting tm as a localtime
-	struct tm timeinfo_gmt;
-	gmtime_r(&curr_time, &timeinfo_gmt);
-	time_t time_gmt = mktime(&timeinfo_gmt);
-
-	//get localtime, interpret resulting tm as localtime
-	struct tm timeinfo_local;
-	localtime_r(&curr_time, &timeinfo_local);
-	time_t time_local = mktime(&timeinfo_local);
-
-	//find the time difference between the two interpretations
-	timezone_diff += difftime(time_local, time_gmt);
-
-	//hack for preventing mktime from assuming localtime: add timezone difference to the input struct.
-	struct tm ret_timeinfo;
-	ret_timeinfo.tm_sec = timeinfo_utc->tm_sec + timezone_diff;
-	ret_timeinfo.tm_min = timeinfo_utc->tm_min;
-	ret_timeinfo.tm_hour = timeinfo_utc->tm_hour;
-	ret_timeinfo.tm_mday = timeinfo_utc->tm_mday;
-	ret_timeinfo.tm_mon = timeinfo_utc->tm_mon;
-	ret_timeinfo.tm_year = timeinfo_utc->tm_year;
-	ret_timeinfo.tm_isdst = timeinfo_utc->tm_isdst;
-	return mktime(&ret_timeinfo);
+	return predict_orbit_fields(orbital_elements, PREDICT_ORBIT_ALL, m, jul_time);
 }
 
-bool predict_decayed(const predict_orbital_elements_t *orbital_elements, predict_julian_date_t time)
+int predict_orbit_fields(const predict_orbital_elements_t *orbital_elements, unsigned int fields, struct predict_position *m, predict_julian_date_t jul_time)
 {
-	struct tm julian_start_time;
-	time_t julian_start_day;
-	double satepoch, time_epochtime;
+	struct orbit_invariants inv;
+	orbit_invariants_init(orbital_elements, &inv);
 
-	julian_start_time.tm_sec = 0;
-	julian_start_time.tm_min = 0;
-	julian_start_time.tm_hour = 0;
-	julian_start_time.tm_mday = 31;
-	julian_start_time.tm_mon = 11;
-	julian_start_time.tm_year = 1979-1900;
-	julian_start_time.tm_isdst = 0;
-	julian_start_day = mktime_utc(&julian_start_time);
+	return orbit_predict_at(orbital_elements, &inv, NULL, fields, m, jul_time, NULL);
+}
 
-	satepoch=DayNum(1,0,orbital_elements->epoch_year)+orbital_elements->epoch_day;
+int predict_orbit_context(const predict_orbital_elements_t *orbital_elements, unsigned int fields, const predict_time_context_t *context, struct predict_position *m)
+{
+	struct orbit_invariants inv;
+	orbit_invariants_init(orbital_elements, &inv);
 
-	time_epochtime = difftime(timestamp_from_julian(time), julian_start_day) / SECONDS_PER_DAY;
+	return orbit_predict_at(orbital_elements, &inv, NULL, fields, m, context->time, context);
+}
 
-	bool has_decayed = false;
+int predict_orbit_resonant(const predict_orbital_elements_t *orbital_elements, struct predict_sdp4_resonance *state, struct predict_position *m, predict_julian_date_t jul_time)
+{
+	struct orbit_invariants inv;
+	orbit_invariants_init(orbital_elements, &inv);
 
-	if (satepoch + ((16.666666 - orbital_elements->mean_motion)/(10.0*fabs(orbital_elements->derivative_mean_motion))) < time_epochtime)
-	{
-		has_decayed = true;
+	return orbit_predict_at(orbital_elements, &inv, state, PREDICT_ORBIT_ALL, m, jul_time, NULL);
+}
+
+int predict_orbit_series(const predict_orbital_elements_t *orbital_elements, predict_julian_date_t start_time, double time_step, size_t num_steps, struct predict_position *m)
+{
+	struct orbit_invariants inv;
+	orbit_invariants_init(orbital_elements, &inv);
+	struct predict_sdp4_resonance resonance = {0};
+
+	for (size_t i=0; i < num_steps; i++) {
+		if (orbit_predict_at(orbital_elements, &inv, &resonance, PREDICT_ORBIT_ALL, &m[i], start_time + i*time_step, NULL) < 0) {
+			return -1;
+		}
+	}
+
+	return 0;
+}
+
+//number of predictions a thread of predict_orbit_parallel() takes at a time, to keep the cost of taking work small
+#define ORBIT_PARALLEL_GRAIN_PREDICTIONS 256
+
+/**
+ * Arguments of predict_orbit_parallel(), shared read-only between the threads.
+ **/
+struct orbit_parallel_context {
+	const predict_orbital_elements_t *orbital_elements;
+	const predict_julian_date_t *times;
+	size_t num_times;
+	unsigned int fields;
+	struct predict_position *output;
+	///Number of orbits that could not be propagated
+	_Atomic int num_failed;
+};
+
+/**
+ * Propagate a range of the orbits of predict_orbit_parallel() over all times.
+ **/
+static void orbit_parallel_range(void *context, size_t begin, size_t end, int thread)
+{
+	(void)thread;
+	struct orbit_parallel_context *ctx = (struct orbit_parallel_context*)context;
+
+	int num_failed = 0;
+	for (size_t i=begin; i < end; i++) {
+		const predict_orbital_elements_t *orbital_elements = &ctx->orbital_elements[i];
+		struct predict_position *output = &ctx->output[i*ctx->num_times];
+
+		struct orbit_invariants inv;
+		orbit_invariants_init(orbital_elements, &inv);
+		struct predict_sdp4_resonance resonance = {0};
+
+		for (size_t j=0; j < ctx->num_times; j++) {
+			if (orbit_predict_at(orbital_elements, &inv, &resonance, ctx->fields, &output[j], ctx->times[j], NULL) < 0) {
+				num_failed++;
+				break;
+			}
+		}
+	}
+
+	if (num_failed > 0) {
+		atomic_fetch_add(&ctx->num_failed, num_failed);
 	}
-	return has_decayed;
+}
+
+int predict_orbit_parallel(const predict_orbital_elements_t *orbital_elements, size_t num_elements, const predict_julian_date_t *times, size_t num_times, unsigned int fields, int num_threads, struct predict_position *output)
+{
+	if (num_times == 0) {
+		return 0;
+	}
+
+	struct orbit_parallel_context context;
+	context.orbital_elements = orbital_elements;
+	context.times = times;
+	context.num_times = num_times;
+	context.fields = fields;
+	context.output = output;
+	atomic_init(&context.num_failed, 0);
+
+	size_t grain = 1 + ORBIT_PARALLEL_GRAIN_PREDICTIONS/num_times;
+	parallel_for(num_elements, grain, num_threads, orbit_parallel_range, &context);
+
+	return atomic_load(&context.num_failed);
+}
+
+/**
+ * Collects near-earth satellites of predict_orbit_batch() until there are enough to fill the lanes of sgp4_predict_lanes().
+ **/
+struct orbit_batch_lanes {
+	///Model parameters of the collected satellites
+	struct sgp4_lanes lanes;
+	///Time since epoch for each lane
+	double tsince[SGP4_LANES];
+	///Index of each lane in the batch
+	size_t index[SGP4_LANES];
+	///Number of lanes in use
+	int num_used;
+};
+
+/* Scale factors from normalized model units to km and km/sec, */
+/* as in Convert_Sat_State() */
+#define ORBIT_POSITION_SCALE (EARTH_RADIUS_KM_WGS84)
+#define ORBIT_VELOCITY_SCALE (EARTH_RADIUS_KM_WGS84*MINUTES_PER_DAY/SECONDS_PER_DAY)
+
+/**
+ * Write normalized model position and velocity of one satellite into the output arrays of predict_orbit_batch().
+ *
+ * \param m Output arrays
+ * \param i Index of satellite
+ * \param pos Position in normalized model units
+ * \param vel Velocity in normalized model units
+ **/
+static void orbit_batch_store(struct predict_position_arrays *m, size_t i, const double pos[3], const double vel[3])
+{
+	m->position_x[i] = pos[0]*ORBIT_POSITION_SCALE;
+	m->position_y[i] = pos[1]*ORBIT_POSITION_SCALE;
+	m->position_z[i] = pos[2]*ORBIT_POSITION_SCALE;
+
+	if (m->velocity_x != NULL) {
+		m->velocity_x[i] = vel[0]*ORBIT_VELOCITY_SCALE;
+		m->velocity_y[i] = vel[1]*ORBIT_VELOCITY_SCALE;
+		m->velocity_z[i] = vel[2]*ORBIT_VELOCITY_SCALE;
+	}
+}
+
+/**
+ * Propagate the collected near-earth satellites and write them to the output arrays.
+ *
+ * \param batch Collected satellites. Emptied on return
+ * \param m Output arrays
+ **/
+static void orbit_batch_flush_lanes(struct orbit_batch_lanes *batch, struct predict_position_arrays *m)
+{
+	if (batch->num_used == 0) {
+		return;
+	}
+
+	//fill unused lanes with a copy of the first to keep the arithmetic well-defined
+	for (int lane=batch->num_used; lane < SGP4_LANES; lane++) {
+		#define ORBIT_COPY_LANE(field) batch->lanes.field[lane] = batch->lanes.field[0]
+		ORBIT_COPY_LANE(aodp); ORBIT_COPY_LANE(aycof); ORBIT_COPY_LANE(c1); ORBIT_COPY_LANE(c4); ORBIT_COPY_LANE(c5);
+		ORBIT_COPY_LANE(cosio); ORBIT_COPY_LANE(d2); ORBIT_COPY_LANE(d3); ORBIT_COPY_LANE(d4); ORBIT_COPY_LANE(delmo);
+		ORBIT_COPY_LANE(omgcof); ORBIT_COPY_LANE(eta); ORBIT_COPY_LANE(omgdot); ORBIT_COPY_LANE(sinio); ORBIT_COPY_LANE(xnodp);
+		ORBIT_COPY_LANE(sinmo); ORBIT_COPY_LANE(t2cof); ORBIT_COPY_LANE(t3cof); ORBIT_COPY_LANE(t4cof); ORBIT_COPY_LANE(t5cof);
+		ORBIT_COPY_LANE(x1mth2); ORBIT_COPY_LANE(x3thm1); ORBIT_COPY_LANE(x7thm1); ORBIT_COPY_LANE(xmcof); ORBIT_COPY_LANE(xmdot);
+		ORBIT_COPY_LANE(xnodcf); ORBIT_COPY_LANE(xnodot); ORBIT_COPY_LANE(xlcof); ORBIT_COPY_LANE(bstar); ORBIT_COPY_LANE(xincl);
+		ORBIT_COPY_LANE(xnodeo); ORBIT_COPY_LANE(eo); ORBIT_COPY_LANE(omegao); ORBIT_COPY_LANE(xmo);
+		#undef ORBIT_COPY_LANE
+		batch->tsince[lane] = batch->tsince[0];
+	}
+
+	double pos[3][SGP4_LANES];
+	double vel[3][SGP4_LANES];
+	sgp4_predict_lanes(&batch->lanes, batch->tsince, pos, vel);
+
+	for (int lane=0; lane < batch->num_used; lane++) {
+		double lane_pos[3] = {pos[0][lane], pos[1][lane], pos[2][lane]};
+		double lane_vel[3] = {vel[0][lane], vel[1][lane], vel[2][lane]};
+		orbit_batch_store(m, batch->index[lane], lane_pos, lane_vel);
+	}
+	batch->num_used = 0;
+}
+
+int predict_orbit_batch(const predict_orbital_elements_t *orbital_elements, size_t num_elements, predict_julian_date_t jul_time, struct predict_position_arrays *m)
+{
+	struct orbit_batch_lanes batch;
+	batch.num_used = 0;
+
+	int num_failed = 0;
+	for (size_t i=0; i < num_elements; i++) {
+		double tsince = (jul_time - orbit_julian_epoch(&orbital_elements[i]))*MINUTES_PER_DAY;
+
+		//near-earth satellites are propagated SGP4_LANES at a time
+		if (orbital_elements[i].ephemeris == EPHEMERIS_SGP4) {
+			sgp4_lanes_set(&batch.lanes, batch.num_used, (struct predict_sgp4*)orbital_elements[i].ephemeris_data);
+			batch.tsince[batch.num_used] = tsince;
+			batch.index[batch.num_used] = i;
+			batch.num_used++;
+			if (batch.num_used == SGP4_LANES) {
+				orbit_batch_flush_lanes(&batch, m);
+			}
+			continue;
+		}
+
+		struct model_output output;
+		if (orbit_model_predict(&orbital_elements[i], NULL, tsince, &output) < 0) {
+			vec3_set(output.pos, NAN, NAN, NAN);
+			vec3_set(output.vel, NAN, NAN, NAN);
+			num_failed++;
+		}
+		orbit_batch_store(m, i, output.pos, output.vel);
+	}
+	orbit_batch_flush_lanes(&batch, m);
+
+	return num_failed;
+}
+
+/**
+ * Write single precision normalized model position and velocity of one satellite into the output arrays of predict_orbit_float().
+ *
+ * \param m Output arrays
+ * \param i Index of satellite
+ * \param pos Position in normalized model units
+ * \param vel Velocity in normalized model units
+ **/
+static void orbit_float_store(struct predict_position_arrays_float *m, size_t i, const float pos[3], const float vel[3])
+{
+	m->position_x[i] = pos[0]*(float)ORBIT_POSITION_SCALE;
+	m->position_y[i] = pos[1]*(float)ORBIT_POSITION_SCALE;
+	m->position_z[i] = pos[2]*(float)ORBIT_POSITION_SCALE;
+
+	if (m->velocity_x != NULL) {
+		m->velocity_x[i] = vel[0]*(float)ORBIT_VELOCITY_SCALE;
+		m->velocity_y[i] = vel[1]*(float)ORBIT_VELOCITY_SCALE;
+		m->velocity_z[i] = vel[2]*(float)ORBIT_VELOCITY_SCALE;
+	}
+}
+
+bool predict_create_orbit_float(predict_orbit_float_t *orbits, const predict_orbital_elements_t *orbital_elements, size_t num_elements)
+{
+	size_t num_sgp4 = 0;
+	for (size_t i=0; i < num_elements; i++) {
+		if (orbital_elements[i].ephemeris == EPHEMERIS_SGP4) {
+			num_sgp4++;
+		}
+	}
+	size_t num_groups = (num_sgp4 + SGP4_FLOAT_LANES - 1)/SGP4_FLOAT_LANES;
+	size_t num_other = num_elements - num_sgp4;
+
+	orbits->elements = orbital_elements;
+	orbits->num_elements = num_elements;
+	orbits->sgp4_groups = malloc(num_groups*sizeof(struct sgp4_float_lanes) + 1);
+	orbits->num_sgp4_groups = num_groups;
+	orbits->sgp4_index = malloc(num_groups*SGP4_FLOAT_LANES*sizeof(size_t) + 1);
+	orbits->sgp4_epoch = malloc(num_groups*SGP4_FLOAT_LANES*sizeof(double) + 1);
+	orbits->other_index = malloc(num_other*sizeof(size_t) + 1);
+	orbits->num_other = num_other;
+	if ((orbits->sgp4_groups == NULL) || (orbits->sgp4_index == NULL) || (orbits->sgp4_epoch == NULL) || (orbits->other_index == NULL)) {
+		predict_destroy_orbit_float(orbits);
+		return false;
+	}
+
+	size_t num_lanes = 0;
+	size_t other = 0;
+	for (size_t i=0; i < num_elements; i++) {
+		if (orbital_elements[i].ephemeris != EPHEMERIS_SGP4) {
+			orbits->other_index[other++] = i;
+			continue;
+		}
+		sgp4_float_lanes_set(&orbits->sgp4_groups[num_lanes/SGP4_FLOAT_LANES], num_lanes % SGP4_FLOAT_LANES, (struct predict_sgp4*)orbital_elements[i].ephemeris_data);
+		orbits->sgp4_index[num_lanes] = i;
+		orbits->sgp4_epoch[num_lanes] = orbit_julian_epoch(&orbital_elements[i]);
+		num_lanes++;
+	}
+
+	//fill unused lanes of the last group with its first satellite to keep the arithmetic well-defined
+	for (; num_lanes < num_groups*SGP4_FLOAT_LANES; num_lanes++) {
+		size_t first = (num_groups - 1)*SGP4_FLOAT_LANES;
+		const predict_orbital_elements_t *elements = &orbital_elements[orbits->sgp4_index[first]];
+		sgp4_float_lanes_set(&orbits->sgp4_groups[num_groups - 1], num_lanes % SGP4_FLOAT_LANES, (struct predict_sgp4*)elements->ephemeris_data);
+		orbits->sgp4_index[num_lanes] = num_elements;
+		orbits->sgp4_epoch[num_lanes] = orbits->sgp4_epoch[first];
+	}
+	return true;
+}
+
+/**
+ * Collects deep-space satellites of predict_orbit_float() until there are enough to fill the lanes of sgp4_float_periodics_lanes().
+ **/
+struct orbit_float_mean_lanes {
+	///Mean elements of the collected satellites
+	struct sgp4_float_mean_lanes lanes;
+	///Index of each lane
+	size_t index[SGP4_FLOAT_LANES];
+	///Number of lanes in use
+	int num_used;
+};
+
+/**
+ * Calculate the periodic terms of the collected deep-space satellites and write them to the output arrays.
+ *
+ * \param batch Collected satellites. Emptied on return
+ * \param m Output arrays
+ **/
+static void orbit_float_flush_mean_lanes(struct orbit_float_mean_lanes *batch, struct predict_position_arrays_float *m)
+{
+	if (batch->num_used == 0) {
+		return;
+	}
+
+	//fill unused lanes with a copy of the first to keep the arithmetic well-defined
+	for (int lane=batch->num_used; lane < SGP4_FLOAT_LANES; lane++) {
+		#define ORBIT_COPY_LANE(field) batch->lanes.field[lane] = batch->lanes.field[0]
+		ORBIT_COPY_LANE(a); ORBIT_COPY_LANE(e); ORBIT_COPY_LANE(omega); ORBIT_COPY_LANE(xnode); ORBIT_COPY_LANE(xinc);
+		ORBIT_COPY_LANE(xlmn); ORBIT_COPY_LANE(xlcof); ORBIT_COPY_LANE(aycof); ORBIT_COPY_LANE(x1mth2); ORBIT_COPY_LANE(x3thm1);
+		ORBIT_COPY_LANE(x7thm1); ORBIT_COPY_LANE(cosio); ORBIT_COPY_LANE(sinio);
+		#undef ORBIT_COPY_LANE
+	}
+
+	float pos[3][SGP4_FLOAT_LANES];
+	float vel[3][SGP4_FLOAT_LANES];
+	sgp4_float_periodics_lanes(&batch->lanes, pos, vel);
+
+	for (int lane=0; lane < batch->num_used; lane++) {
+		float lane_pos[3] = {pos[0][lane], pos[1][lane], pos[2][lane]};
+		float lane_vel[3] = {vel[0][lane], vel[1][lane], vel[2][lane]};
+		orbit_float_store(m, batch->index[lane], lane_pos, lane_vel);
+	}
+	batch->num_used = 0;
+}
+
+int predict_orbit_float(const predict_orbit_float_t *orbits, predict_julian_date_t jul_time, struct predict_position_arrays_float *m)
+{
+	for (size_t group=0; group < orbits->num_sgp4_groups; group++) {
+		const size_t *index = &orbits->sgp4_index[group*SGP4_FLOAT_LANES];
+		const double *epoch = &orbits->sgp4_epoch[group*SGP4_FLOAT_LANES];
+		double tsince[SGP4_FLOAT_LANES];
+		for (int lane=0; lane < SGP4_FLOAT_LANES; lane++) {
+			tsince[lane] = (jul_time - epoch[lane])*MINUTES_PER_DAY;
+		}
+
+		float pos[3][SGP4_FLOAT_LANES];
+		float vel[3][SGP4_FLOAT_LANES];
+		sgp4_float_predict_lanes(&orbits->sgp4_groups[group], tsince, pos, vel);
+
+		for (int lane=0; (lane < SGP4_FLOAT_LANES) && (index[lane] < orbits->num_elements); lane++) {
+			float lane_pos[3] = {pos[0][lane], pos[1][lane], pos[2][lane]};
+			float lane_vel[3] = {vel[0][lane], vel[1][lane], vel[2][lane]};
+			orbit_float_store(m, index[lane], lane_pos, lane_vel);
+		}
+	}
+
+	//deep-space perturbations are calculated one satellite at a time in double precision, and the periodic terms in lanes
+	struct orbit_float_mean_lanes batch;
+	batch.num_used = 0;
+	int num_failed = 0;
+	for (size_t i=0; i < orbits->num_other; i++) {
+		size_t index = orbits->other_index[i];
+		const predict_orbital_elements_t *elements = &orbits->elements[index];
+		if (elements->ephemeris != EPHEMERIS_SDP4) {
+			float nan_vector[3] = {NAN, NAN, NAN};
+			orbit_float_store(m, index, nan_vector, nan_vector);
+			num_failed++;
+			continue;
+		}
+
+		const struct predict_sdp4 *model = (const struct predict_sdp4*)elements->ephemeris_data;
+		struct sdp4_mean_elements mean;
+		sdp4_mean_elements(model, NULL, (jul_time - orbit_julian_epoch(elements))*MINUTES_PER_DAY, &mean);
+		sgp4_float_mean_lanes_set(&batch.lanes, batch.num_used, model, &mean);
+		batch.index[batch.num_used] = index;
+		batch.num_used++;
+		if (batch.num_used == SGP4_FLOAT_LANES) {
+			orbit_float_flush_mean_lanes(&batch, m);
+		}
+	}
+	orbit_float_flush_mean_lanes(&batch, m);
+
+	return num_failed;
+}
+
+void predict_destroy_orbit_float(predict_orbit_float_t *orbits)
+{
+	free(orbits->sgp4_groups);
+	free(orbits->sgp4_index);
+	free(orbits->sgp4_epoch);
+	free(orbits->other_index);
+	orbits->sgp4_groups = NULL;
+	orbits->sgp4_index = NULL;
+	orbits->sgp4_epoch = NULL;
+	orbits->other_index = NULL;
+	orbits->num_sgp4_groups = 0;
+	orbits->num_other = 0;
+	orbits->num_elements = 0;
+}
+
+bool predict_decayed(const predict_orbital_elements_t *orbital_elements, predict_julian_date_t time)
+{
+	return orbital_elements->decay_time < time;
 }
 
 	/* Calculates if a position is eclipsed.  */
@@ -0,0 +1,212 @@
+#include "parallel.h"
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+//maximum number of threads used by parallel_for()
+#define PARALLEL_MAX_THREADS 1024
+
+//size of a cache line, to keep the ranges of different threads apart
+#define PARALLEL_CACHE_LINE 64
+
+/**
+ * Remaining range of items of one thread, packed as begin in the lower and
+ * end in the upper 32 bits so that it can be updated with a single compare-and-swap.
+ * The owner takes items from the front, thieves take them from the back.
+ **/
+struct parallel_range {
+	_Alignas(PARALLEL_CACHE_LINE) _Atomic uint64_t packed;
+};
+
+struct parallel_pool {
+	struct parallel_range *ranges;
+	int num_threads;
+	size_t grain;
+	parallel_range_func func;
+	void *context;
+};
+
+struct parallel_worker {
+	struct parallel_pool *pool;
+	int thread;
+};
+
+static uint64_t parallel_pack(uint32_t begin, uint32_t end)
+{
+	return ((uint64_t)end << 32) | begin;
+}
+
+static uint32_t parallel_begin(uint64_t packed)
+{
+	return (uint32_t)packed;
+}
+
+static uint32_t parallel_end(uint64_t packed)
+{
+	return (uint32_t)(packed >> 32);
+}
+
+/**
+ * Take up to grain items from the front of the own range.
+ *
+ * \return false if the range is empty
+ **/
+static bool parallel_take(struct parallel_range *range, size_t grain, uint32_t *begin, uint32_t *end)
+{
+	uint64_t packed = atomic_load(&range->packed);
+	while (true) {
+		uint32_t b = parallel_begin(packed);
+		uint32_t e = parallel_end(packed);
+		if (b >= e) {
+			return false;
+		}
+
+		uint32_t n = (e - b < grain) ? (e - b) : (uint32_t)grain;
+		if (atomic_compare_exchange_weak(&range->packed, &packed, parallel_pack(b + n, e))) {
+			*begin = b;
+			*end = b + n;
+			return true;
+		}
+	}
+}
+
+/**
+ * Steal the back half of the largest range of the other threads into the own range.
+ *
+ * \return false if there is nothing left to steal
+ **/
+static bool parallel_steal(struct parallel_pool *pool, int thread)
+{
+	while (true) {
+		//find the victim with most remaining items
+		int victim = -1;
+		uint64_t victim_packed = 0;
+		uint32_t victim_size = 0;
+		for (int i=0; i < pool->num_threads; i++) {
+			if (i == thread) {
+				continue;
+			}
+			uint64_t packed = atomic_load(&pool->ranges[i].packed);
+			uint32_t b = parallel_begin(packed);
+			uint32_t e = parallel_end(packed);
+			if ((b < e) && (e - b > victim_size)) {
+				victim = i;
+				victim_packed = packed;
+				victim_size = e - b;
+			}
+		}
+
+		if (victim < 0) {
+			return false;
+		}
+
+		//a single item is taken as a whole
+		uint32_t b = parallel_begin(victim_packed);
+		uint32_t e = parallel_end(victim_packed);
+		uint32_t mid = b + victim_size/2;
+		if (atomic_compare_exchange_strong(&pool->ranges[victim].packed, &victim_packed, parallel_pack(b, mid))) {
+			atomic_store(&pool->ranges[thread].packed, parallel_pack(mid, e));
+			return true;
+		}
+	}
+}
+
+static void *parallel_worker_run(void *arg)
+{
+	struct parallel_worker *worker = (struct parallel_worker*)arg;
+	struct parallel_pool *pool = worker->pool;
+
+	do {
+		uint32_t begin, end;
+		while (parallel_take(&pool->ranges[worker->thread], pool->grain, &begin, &end)) {
+			pool->func(pool->context, begin, end, worker->thread);
+		}
+	} while (parallel_steal(pool, worker->thread));
+
+	return NULL;
+}
+
+int parallel_default_threads(void)
+{
+	long num_processors = sysconf(_SC_NPROCESSORS_ONLN);
+	if (num_processors < 1) {
+		return 1;
+	}
+	if (num_processors > PARALLEL_MAX_THREADS) {
+		return PARALLEL_MAX_THREADS;
+	}
+	return num_processors;
+}
+
+int parallel_for(size_t num_items, size_t grain, int num_threads, parallel_range_func func, void *context)
+{
+	if (num_items == 0) {
+		return 0;
+	}
+	if (num_threads <= 0) {
+		num_threads = parallel_default_threads();
+	}
+	if (num_threads > PARALLEL_MAX_THREADS) {
+		num_threads = PARALLEL_MAX_THREADS;
+	}
+	if ((size_t)num_threads > num_items) {
+		num_threads = num_items;
+	}
+	if (grain == 0) {
+		grain = 1;
+	}
+
+	//no need for the machinery on a single thread
+	if (num_threads == 1) {
+		func(context, 0, num_items, 0);
+		return 0;
+	}
+
+	struct parallel_range *ranges = aligned_alloc(PARALLEL_CACHE_LINE, num_threads*sizeof(struct parallel_range));
+	struct parallel_worker *workers = malloc(num_threads*sizeof(struct parallel_worker));
+	pthread_t *threads = malloc(num_threads*sizeof(pthread_t));
+	if ((ranges == NULL) || (workers == NULL) || (threads == NULL)) {
+		free(ranges);
+		free(workers);
+		free(threads);
+		func(context, 0, num_items, 0);
+		return -1;
+	}
+
+	struct parallel_pool pool = {ranges, num_threads, grain, func, context};
+	for (int i=0; i < num_threads; i++) {
+		uint32_t begin = (uint64_t)num_items*i/num_threads;
+		uint32_t end = (uint64_t)num_items*(i + 1)/num_threads;
+		atomic_init(&ranges[i].packed, parallel_pack(begin, end));
+		workers[i].pool = &pool;
+		workers[i].thread = i;
+	}
+
+	//threads that fail to start leave their items to be stolen by the others
+	int ret = 0;
+	bool started[PARALLEL_MAX_THREADS] = {false};
+	for (int i=1; i < num_threads; i++) {
+		if (pthread_create(&threads[i], NULL, parallel_worker_run, &workers[i]) == 0) {
+			started[i] = true;
+		} else {
+			ret = -1;
+		}
+	}
+
+	parallel_worker_run(&workers[0]);
+
+	for (int i=1; i < num_threads; i++) {
+		if (started[i]) {
+			pthread_join(threads[i], NULL);
+		}
+	}
+
+	free(ranges);
+	free(workers);
+	free(threads);
+	return ret;
+}
@@ -0,0 +1,41 @@
+#ifndef PARALLEL_H_
+#define PARALLEL_H_
+
+#include <stddef.h>
+
+/**
+ * Function processing a range of work items in parallel_for().
+ *
+ * \param context Context passed to parallel_for()
+ * \param begin First item
+ * \param end One past the last item
+ * \param thread Index of the calling thread, 0 to num_threads-1
+ **/
+typedef void (*parallel_range_func)(void *context, size_t begin, size_t end, int thread);
+
+/**
+ * Get number of threads to use when the caller does not specify one.
+ *
+ * \return Number of online processors, at least 1
+ **/
+int parallel_default_threads(void);
+
+/**
+ * Process num_items work items on num_threads threads, with work stealing.
+ *
+ * The items are split evenly between the threads up front. Each thread takes
+ * grain items at a time from the front of its own range, and once its range
+ * is empty it steals the back half of the largest remaining range of another
+ * thread. This keeps all threads busy when the cost per item varies. The
+ * calling thread works as thread 0.
+ *
+ * \param num_items Number of work items, below 2^32
+ * \param grain Number of items taken at a time
+ * \param num_threads Number of threads, 0 for parallel_default_threads()
+ * \param func Function called on each taken range of items
+ * \param context Passed to func
+ * \return 0 on success, -1 if threads could not be created. The items are still processed, on fewer threads
+ **/
+int parallel_for(size_t num_items, size_t grain, int num_threads, parallel_range_func func, void *context);
+
+#endif
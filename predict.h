@@ -2,6 +2,7 @@
 #define _PREDICT_H_
 
 #include <time.h>
+#include <stddef.h>
 #include <stdint.h>
 #include <stdbool.h>
 
@@ -23,6 +24,42 @@ uint64_t timestamp_from_julian(predict_julian_date_t date);
 
 uint64_t timestamp_ms_from_julian(predict_julian_date_t date);
 
+/**
+ * Quantities that depend only on time, calculated once by
+ * predict_create_time_context() and shared by all orbits and observations
+ * at that time.
+ **/
+typedef struct {
+	///Julian day in UTC
+	predict_julian_date_t time;
+	///Greenwich mean sidereal time in radians
+	double gmst;
+	///Position of the sun in ECI coordinates, in km
+	double sun_position[3];
+	///Whether the moon fields below are set
+	bool has_moon;
+	///Right ascension of the moon in radians
+	double moon_right_ascension;
+	///Declination of the moon in radians
+	double moon_declination;
+	///Greenwich sidereal time of the moon model in radians
+	double moon_sidereal_time;
+	///Range approximation of the moon model, as in predict_observe_moon()
+	double moon_range;
+} predict_time_context_t;
+
+/**
+ * Calculate the sidereal time, the position of the sun and optionally that
+ * of the moon at a time, for predict_orbit_context(),
+ * predict_observe_orbit_context(), predict_observe_sun_context() and
+ * predict_observe_moon_context().
+ *
+ * \param context Returned time context
+ * \param time Julian day in UTC
+ * \param moon Whether to calculate the position of the moon
+ **/
+void predict_create_time_context(predict_time_context_t *context, predict_julian_date_t time, bool moon);
+
 /**
  * Simplified perturbation models used in modeling the satellite orbits.
  **/
@@ -67,6 +104,8 @@ typedef struct {
 	double bstar_drag_term;
 	///Number of revolutions around Earth at epoch (line 2, field 9)
 	int revolutions_at_epoch;
+	///Estimated time of orbit decay from the mean motion and its derivative, as Julian date
+	predict_julian_date_t decay_time;
 
 	///Which perturbation model to use
 	enum predict_ephemeris ephemeris;
@@ -147,6 +186,26 @@ struct predict_sdp4 {
 	double epoch;
 };
 
+/**
+ * State of the SDP4 resonance integrator, kept between predictions of a
+ * 12-hour or geosynchronous resonant orbit so that each prediction only
+ * integrates from the previous one instead of from epoch.
+ *
+ * Zero-initialize before first use. The state belongs to one set of orbital
+ * elements and is restarted from epoch when used with another; zero it
+ * again if the elements are parsed anew into the same predict_sdp4 struct.
+ **/
+struct predict_sdp4_resonance {
+	///Model parameters the state was integrated for
+	const struct predict_sdp4 *model;
+	///Time since epoch reached by the integrator, in minutes
+	double atime;
+	///Integrated mean longitude at atime
+	double xli;
+	///Integrated mean motion at atime
+	double xni;
+};
+
 /**
  * Create predict_orbital_elements_t from TLE strings.
  *
@@ -157,6 +216,204 @@ struct predict_sdp4 {
  **/
 bool predict_parse_tle(predict_orbital_elements_t *m, const char *tle_line_1, const char *tle_line_2, struct predict_sgp4 *sgp4, struct predict_sdp4 *sdp4);
 
+/**
+ * Catalog of satellites owning their orbital elements and model parameters.
+ *
+ * The elements and, behind them, an arena holding the SGP4 or SDP4
+ * parameters of each satellite in catalog order share one allocation.
+ * The elements can be passed directly to functions taking an array of
+ * orbital elements. Adding satellites may move the allocation, so pointers
+ * into the catalog (including the model of a predict_sdp4_resonance) are
+ * only valid until the next addition.
+ **/
+typedef struct {
+	///Orbital elements of the satellites, in the order they were added
+	predict_orbital_elements_t *elements;
+	///Number of satellites
+	size_t num_elements;
+	///Number of satellites there is room for
+	size_t capacity;
+	///Model parameters of the satellites
+	unsigned char *arena;
+	///Bytes of the arena in use
+	size_t arena_used;
+	///Size of the arena in bytes
+	size_t arena_size;
+	///Mapping of the binary catalog file holding the elements and the arena, NULL if they are allocated
+	void *mapping;
+	///Size of the mapping in bytes
+	size_t mapping_size;
+} predict_catalog_t;
+
+/**
+ * Create empty satellite catalog.
+ *
+ * \param catalog Catalog to initialize
+ * \param capacity Expected number of satellites. The catalog grows beyond this as needed
+ * \return false if out of memory
+ **/
+bool predict_create_catalog(predict_catalog_t *catalog, size_t capacity);
+
+/**
+ * Parse TLE and add the satellite to the catalog, with only the model parameters it needs.
+ *
+ * \param catalog Catalog, created by predict_create_catalog()
+ * \param tle_line_1 First line of NORAD two-line element set string
+ * \param tle_line_2 Second line of NORAD two-line element set string
+ * \return false if the TLE could not be parsed or out of memory, in which case the catalog is unchanged
+ **/
+bool predict_catalog_add_tle(predict_catalog_t *catalog, const char *tle_line_1, const char *tle_line_2);
+
+/**
+ * Outcome of parsing a TLE record.
+ **/
+enum predict_tle_status {
+  ///Record was parsed
+  PREDICT_TLE_OK = 0,
+  ///Line 1 or line 2 is missing or too short
+  PREDICT_TLE_FORMAT_ERROR,
+  ///Checksum of line 1 or line 2 does not match
+  PREDICT_TLE_CHECKSUM_ERROR,
+  ///Field contains characters that do not fit its format
+  PREDICT_TLE_FIELD_ERROR
+};
+
+/**
+ * Fields of a TLE, for reporting where decoding failed.
+ **/
+enum predict_tle_field {
+  PREDICT_TLE_FIELD_NONE = 0,
+  PREDICT_TLE_FIELD_LINE_NUMBER,
+  PREDICT_TLE_FIELD_SATELLITE_NUMBER,
+  PREDICT_TLE_FIELD_DESIGNATOR,
+  PREDICT_TLE_FIELD_EPOCH_YEAR,
+  PREDICT_TLE_FIELD_EPOCH_DAY,
+  PREDICT_TLE_FIELD_DERIVATIVE_MEAN_MOTION,
+  PREDICT_TLE_FIELD_SECOND_DERIVATIVE_MEAN_MOTION,
+  PREDICT_TLE_FIELD_BSTAR_DRAG_TERM,
+  PREDICT_TLE_FIELD_ELEMENT_NUMBER,
+  PREDICT_TLE_FIELD_INCLINATION,
+  PREDICT_TLE_FIELD_RIGHT_ASCENSION,
+  PREDICT_TLE_FIELD_ECCENTRICITY,
+  PREDICT_TLE_FIELD_ARGUMENT_OF_PERIGEE,
+  PREDICT_TLE_FIELD_MEAN_ANOMALY,
+  PREDICT_TLE_FIELD_MEAN_MOTION,
+  PREDICT_TLE_FIELD_REVOLUTIONS_AT_EPOCH,
+  PREDICT_TLE_FIELD_CHECKSUM
+};
+
+/**
+ * TLE record that could not be decoded or loaded.
+ **/
+struct predict_tle_error {
+	///Line number in the file of the first line of the record, starting at 1. 0 when not decoding from a file
+	size_t line;
+	///Reason the record was not loaded
+	enum predict_tle_status status;
+	///TLE line (1 or 2) of the error, 0 if unknown
+	int tle_line;
+	///Column of the error in the TLE line, starting at 1, 0 if unknown
+	int column;
+	///Field of the error
+	enum predict_tle_field field;
+};
+
+/**
+ * Decode the fields of a TLE into orbital elements, without initializing an ephemeris model.
+ *
+ * The fixed columns of each line are decoded in a single pass with integer
+ * arithmetic, and the checksum is accumulated in the same pass. No memory is
+ * allocated, and the result does not depend on the locale. Satellite numbers
+ * in Alpha-5 format (a letter for the first two digits) are accepted.
+ * The decay_time field is estimated from the decoded fields. The ephemeris
+ * and ephemeris_data fields are not set.
+ *
+ * \param elements Decoded orbital elements
+ * \param tle_line_1 First line of NORAD two-line element set string
+ * \param tle_line_2 Second line of NORAD two-line element set string
+ * \param error Returned status and location of the first error. May be NULL
+ * \return PREDICT_TLE_OK on success
+ **/
+enum predict_tle_status predict_tle_decode(predict_orbital_elements_t *elements, const char *tle_line_1, const char *tle_line_2, struct predict_tle_error *error);
+
+/**
+ * Load all TLE records of a file into the catalog.
+ *
+ * The file may contain two-line records or three-line records with a
+ * name line before each; name lines are not stored. The file is mapped
+ * into memory, the records are found in one pass and then parsed on
+ * several threads. Satellites are added in file order. Records that fail
+ * to parse are reported and skipped.
+ *
+ * \param catalog Catalog, created by predict_create_catalog()
+ * \param filename TLE file
+ * \param num_threads Number of threads, including the calling thread. 0 uses one per online processor
+ * \param errors Caller-provided array for reporting records that failed, in file order. May be NULL
+ * \param max_errors Size of the errors array
+ * \param num_errors Returned number of records that failed, which may exceed max_errors. May be NULL
+ * \return Number of satellites added, or -1 if the file could not be read or out of memory, in which case the catalog is unchanged
+ **/
+long predict_catalog_load_file(predict_catalog_t *catalog, const char *filename, int num_threads, struct predict_tle_error *errors, size_t max_errors, size_t *num_errors);
+
+/**
+ * Outcome of mapping a binary catalog file.
+ **/
+enum predict_catalog_status {
+  ///Catalog was mapped
+  PREDICT_CATALOG_OK = 0,
+  ///File could not be opened or mapped, or out of memory
+  PREDICT_CATALOG_IO_ERROR,
+  ///File is not a binary catalog, or is truncated or corrupt
+  PREDICT_CATALOG_FORMAT_ERROR,
+  ///File was written by another version of libpredict or on another platform
+  PREDICT_CATALOG_INCOMPATIBLE,
+  ///File was made from another source than expected
+  PREDICT_CATALOG_STALE
+};
+
+/**
+ * Stamp identifying the current contents of a source file of a binary catalog, from its size,
+ * modification time and inode. Any change of the file changes the stamp.
+ *
+ * \param filename Source file, typically a TLE file
+ * \return Stamp, or 0 if the file does not exist
+ **/
+uint64_t predict_catalog_source_stamp(const char *filename);
+
+/**
+ * Save the catalog as a binary catalog file, which predict_catalog_map() can load without parsing
+ * or initializing any model. The file holds the orbital elements and the initialized model parameters
+ * in native layout, after a header with the format version, the byte order and struct sizes of this
+ * platform, and the source stamp. The file is written under a temporary name and renamed, so readers
+ * never see a partial file.
+ *
+ * \param catalog Catalog
+ * \param filename Binary catalog file
+ * \param source_stamp Stamp of the source the catalog was made from, see predict_catalog_source_stamp()
+ * \return false if the file could not be written
+ **/
+bool predict_catalog_save(const predict_catalog_t *catalog, const char *filename, uint64_t source_stamp);
+
+/**
+ * Create a catalog from a binary catalog file written by predict_catalog_save(). The file is mapped
+ * into memory and used in place; only the model parameter pointers of the elements are set, which
+ * copies the pages holding the elements. Adding satellites moves the catalog to allocated memory.
+ * Destroy with predict_destroy_catalog().
+ *
+ * \param catalog Catalog to initialize. Empty unless PREDICT_CATALOG_OK is returned, and to be destroyed in either case
+ * \param filename Binary catalog file
+ * \param source_stamp Expected stamp of the source, as passed to predict_catalog_save()
+ * \return PREDICT_CATALOG_OK on success, otherwise why the file cannot be used and should be rebuilt from its source
+ **/
+enum predict_catalog_status predict_catalog_map(predict_catalog_t *catalog, const char *filename, uint64_t source_stamp);
+
+/**
+ * Free all memory of the catalog in one go, or unmap its file.
+ *
+ * \param catalog Catalog, created by predict_create_catalog() or predict_catalog_map()
+ **/
+void predict_destroy_catalog(predict_catalog_t *catalog);
+
 /**
  * Predicted orbital values for satellite at a given time.
  **/
@@ -213,6 +470,466 @@ typedef struct {
  **/
 int predict_orbit(const predict_orbital_elements_t *orbital_elements, struct predict_position *x, predict_julian_date_t time);
 
+/**
+ * Quantities of struct predict_position calculated by predict_orbit_fields(),
+ * combined into a bitmask.
+ **/
+enum predict_orbit_field {
+  ///ECI position and velocity, phase and osculating elements. Always calculated, as all other fields depend on it
+  PREDICT_ORBIT_ECI = 1 << 0,
+  ///Latitude, longitude and altitude
+  PREDICT_ORBIT_GEODETIC = 1 << 1,
+  ///Eclipse state and depth
+  PREDICT_ORBIT_ECLIPSE = 1 << 2,
+  ///Footprint. Implies PREDICT_ORBIT_GEODETIC
+  PREDICT_ORBIT_FOOTPRINT = 1 << 3,
+  ///Number of revolutions
+  PREDICT_ORBIT_REVOLUTIONS = 1 << 4,
+  ///Decay state
+  PREDICT_ORBIT_DECAY = 1 << 5,
+  ///Everything, as calculated by predict_orbit()
+  PREDICT_ORBIT_ALL = (1 << 6) - 1
+};
+
+/**
+ * Predict satellite orbit at given time, calculating only the requested
+ * quantities. With PREDICT_ORBIT_ALL, this is the same as predict_orbit().
+ * Fields of the output that are not requested are left unchanged.
+ *
+ * \param orbital_elements Orbital elements
+ * \param fields Bitmask of enum predict_orbit_field
+ * \param x Predicted orbit
+ * \param time Julian day in UTC
+ * \return 0 if everything went fine
+ **/
+int predict_orbit_fields(const predict_orbital_elements_t *orbital_elements, unsigned int fields, struct predict_position *x, predict_julian_date_t time);
+
+/**
+ * Predict satellite orbit at the time of a time context, as
+ * predict_orbit_fields() does. The sidereal time and the position of the
+ * sun are taken from the context instead of being calculated again.
+ *
+ * \param orbital_elements Orbital elements
+ * \param fields Bitmask of enum predict_orbit_field
+ * \param context Time context, from predict_create_time_context()
+ * \param x Predicted orbit
+ * \return 0 if everything went fine
+ **/
+int predict_orbit_context(const predict_orbital_elements_t *orbital_elements, unsigned int fields, const predict_time_context_t *context, struct predict_position *x);
+
+/**
+ * Predict satellite orbit at given time, keeping the resonance integrator
+ * state of deep-space orbits between calls.
+ *
+ * predict_orbit() integrates resonant deep-space orbits from epoch in 720
+ * minute steps on every call. Here the integration continues from the time
+ * of the previous call, so that predictions at sequential times moving away
+ * from epoch take a constant number of steps. A time closer to epoch than
+ * the last integrator step restarts the integration from epoch. Gives the
+ * same result as predict_orbit() in either case. Orbits without resonance,
+ * including all SGP4 orbits, ignore the state.
+ *
+ * \param orbital_elements Orbital elements
+ * \param state Resonance integrator state, updated on return
+ * \param x Predicted orbit
+ * \param time Julian day in UTC
+ * \return 0 if everything went fine
+ **/
+int predict_orbit_resonant(const predict_orbital_elements_t *orbital_elements, struct predict_sdp4_resonance *state, struct predict_position *x, predict_julian_date_t time);
+
+/**
+ * Predict satellite orbit at a series of equidistant times.
+ *
+ * Gives the same result as calling predict_orbit() for each time, but the
+ * time-independent quantities of the satellite are only calculated once and
+ * the resonance integrator of deep-space orbits continues from one time to
+ * the next, as in predict_orbit_resonant().
+ *
+ * \param orbital_elements Orbital elements
+ * \param start_time Julian day in UTC of the first prediction
+ * \param time_step Time between predictions in days
+ * \param num_steps Number of predictions
+ * \param x Caller-provided array of num_steps predicted orbits
+ * \return 0 if everything went fine
+ **/
+int predict_orbit_series(const predict_orbital_elements_t *orbital_elements, predict_julian_date_t start_time, double time_step, size_t num_steps, struct predict_position *x);
+
+/**
+ * Predict orbits of a catalog of satellites at a list of times, on several threads.
+ *
+ * The satellites are shared between the threads with work stealing, so that
+ * expensive deep-space orbits do not leave threads idle. Each satellite is
+ * propagated over all times by one thread, continuing the resonance
+ * integrator as in predict_orbit_resonant(); times sorted away from epoch
+ * are therefore cheapest. The results equal those of predict_orbit_fields().
+ *
+ * \param orbital_elements Array of orbital elements
+ * \param num_elements Number of orbital elements, below 2^32
+ * \param times Array of Julian days in UTC
+ * \param num_times Number of times
+ * \param fields Bitmask of enum predict_orbit_field to calculate
+ * \param num_threads Number of threads, including the calling thread. 0 uses one per online processor
+ * \param output Caller-provided array of num_elements*num_times predicted orbits. The orbit of satellite i at time j is written to output[i*num_times + j]
+ * \return Number of satellites that could not be propagated
+ **/
+int predict_orbit_parallel(const predict_orbital_elements_t *orbital_elements, size_t num_elements, const predict_julian_date_t *times, size_t num_times, unsigned int fields, int num_threads, struct predict_position *output);
+
+/**
+ * Structure-of-arrays output buffers for predict_orbit_batch(). All arrays are
+ * allocated by the caller and hold one entry per orbit.
+ **/
+struct predict_position_arrays {
+	///ECI position in km
+	double *position_x;
+	double *position_y;
+	double *position_z;
+	///ECI velocity in km/s. Set velocity_x to NULL if velocities are not needed.
+	double *velocity_x;
+	double *velocity_y;
+	double *velocity_z;
+};
+
+/**
+ * Predict ECI position and velocity of a whole catalog of satellites at a single time.
+ *
+ * Only the position and velocity from the SGP4/SDP4 models are calculated.
+ * Use predict_orbit() for the derived quantities (geodetic position, eclipse,
+ * footprint, decay, ...).
+ *
+ * Near-earth (SGP4) satellites are propagated several at a time with vector
+ * instructions. Their positions agree with predict_orbit() to within 2 cm and
+ * velocities to within 2e-5 km/s; deep-space satellites agree exactly.
+ *
+ * \param orbital_elements Array of orbital elements
+ * \param num_elements Number of orbital elements
+ * \param time Julian day in UTC
+ * \param output Caller-provided output arrays with room for num_elements entries
+ * \return Number of orbits that could not be propagated. Their output entries are set to NAN
+ **/
+int predict_orbit_batch(const predict_orbital_elements_t *orbital_elements, size_t num_elements, predict_julian_date_t time, struct predict_position_arrays *output);
+
+/**
+ * Single precision structure-of-arrays output buffers for predict_orbit_float(). All arrays are
+ * allocated by the caller and hold one entry per orbit.
+ **/
+struct predict_position_arrays_float {
+	///ECI position in km
+	float *position_x;
+	float *position_y;
+	float *position_z;
+	///ECI velocity in km/s. Set velocity_x to NULL if velocities are not needed.
+	float *velocity_x;
+	float *velocity_y;
+	float *velocity_z;
+};
+
+struct sgp4_float_lanes;
+
+/**
+ * Satellites prepared for single precision propagation with predict_orbit_float().
+ *
+ * Near-earth satellites are kept in single precision model parameters derived
+ * from their predict_sgp4 parameters, grouped for vector instructions.
+ * Deep-space satellites use the predict_sdp4 parameters of the orbital
+ * elements, which must stay valid as long as the prepared satellites are used.
+ **/
+typedef struct {
+	///Orbital elements the satellites were prepared from
+	const predict_orbital_elements_t *elements;
+	///Number of satellites
+	size_t num_elements;
+	///Near-earth satellites in groups of SGP4_FLOAT_LANES
+	struct sgp4_float_lanes *sgp4_groups;
+	///Number of groups
+	size_t num_sgp4_groups;
+	///Satellite index of each lane of the groups, num_elements for unused lanes
+	size_t *sgp4_index;
+	///Julian date of TLE epoch of each lane of the groups
+	double *sgp4_epoch;
+	///Satellite index of the other satellites
+	size_t *other_index;
+	///Number of other satellites
+	size_t num_other;
+} predict_orbit_float_t;
+
+/**
+ * Prepare satellites for single precision propagation.
+ *
+ * \param orbits Prepared satellites
+ * \param orbital_elements Array of orbital elements, kept by reference
+ * \param num_elements Number of orbital elements
+ * \return false if out of memory
+ **/
+bool predict_create_orbit_float(predict_orbit_float_t *orbits, const predict_orbital_elements_t *orbital_elements, size_t num_elements);
+
+/**
+ * Predict ECI position and velocity of the prepared satellites at a single time in single precision.
+ *
+ * Meant for visualisation and other uses needing no better than kilometre
+ * accuracy. The secular angles and deep-space perturbations are calculated
+ * in double precision; Kepler's equation and the periodic terms, which take
+ * most of the time, in single precision with twice as many satellites per
+ * vector instruction as predict_orbit_batch(). Against predict_orbit_batch()
+ * positions agree to within 0.1 km and velocities to within 1e-4 km/s while
+ * the orbit stays above the atmosphere (measured within 30 days of epoch:
+ * 0.011 km and 1e-5 km/s near-earth, 0.05 km and 3e-5 km/s deep-space).
+ *
+ * \param orbits Satellites, prepared by predict_create_orbit_float()
+ * \param time Julian day in UTC
+ * \param output Caller-provided output arrays with room for orbits->num_elements entries
+ * \return Number of orbits that could not be propagated. Their output entries are set to NAN
+ **/
+int predict_orbit_float(const predict_orbit_float_t *orbits, predict_julian_date_t time, struct predict_position_arrays_float *output);
+
+/**
+ * Free the prepared satellites.
+ *
+ * \param orbits Satellites, prepared by predict_create_orbit_float()
+ **/
+void predict_destroy_orbit_float(predict_orbit_float_t *orbits);
+
+///Number of Chebyshev coefficients per position component and segment of predict_chebyshev_t
+#define PREDICT_CHEBYSHEV_COEFFICIENTS 12
+
+/**
+ * Chebyshev polynomial approximation of the ECI position of a satellite over
+ * a time span, for answering repeated queries over the same window without
+ * running the orbit model. The span is divided into segments of equal length,
+ * each with one polynomial per position component.
+ **/
+typedef struct {
+	///Start of the span, Julian date in UTC. May be earlier than requested, see predict_create_chebyshev()
+	predict_julian_date_t start_time;
+	///End of the span, Julian date in UTC. May be later than requested
+	predict_julian_date_t end_time;
+	///Length of each segment in days
+	double segment_length;
+	///Number of segments
+	size_t num_segments;
+	///Coefficients of segment i for component j at coefficients[(3*i + j)*PREDICT_CHEBYSHEV_COEFFICIENTS]
+	double *coefficients;
+	///Largest difference in position (km) from the orbit model found when checking the segments
+	double max_position_error;
+	///Largest difference in velocity (km/s) from the orbit model found when checking the segments
+	double max_velocity_error;
+} predict_chebyshev_t;
+
+/**
+ * Fit Chebyshev segments to the ECI position of a satellite over a time span.
+ *
+ * The segments start at half an orbital period and are halved until the
+ * fit is within the tolerance, down to one minute. Each segment is checked
+ * against the orbit model halfway between its fit points, and the largest
+ * differences found are reported in the max_position_error and
+ * max_velocity_error fields. Deep-space orbits are sampled in time order,
+ * continuing the resonance integrator as in predict_orbit_resonant(). For
+ * resonant orbits the span is widened to whole half-day integration steps
+ * from epoch, so that the segments do not straddle the steps.
+ *
+ * \param chebyshev Approximation to create
+ * \param orbital_elements Orbital elements
+ * \param start_time Start of the span, Julian date in UTC
+ * \param end_time End of the span, Julian date in UTC
+ * \param tolerance Position tolerance in km. If it cannot be met, max_position_error exceeds it
+ * \return false if the orbit could not be predicted or out of memory
+ **/
+bool predict_create_chebyshev(predict_chebyshev_t *chebyshev, const predict_orbital_elements_t *orbital_elements, predict_julian_date_t start_time, predict_julian_date_t end_time, double tolerance);
+
+/**
+ * Evaluate the Chebyshev approximation of the position of a satellite.
+ *
+ * \param chebyshev Approximation, created by predict_create_chebyshev()
+ * \param time Julian date in UTC, within the span
+ * \param position Returned ECI position in km
+ * \param velocity Returned ECI velocity in km/s, from the derivative of the polynomials. May be NULL
+ * \return 0 on success, -1 if the time is outside the span
+ **/
+int predict_chebyshev_position(const predict_chebyshev_t *chebyshev, predict_julian_date_t time, double position[3], double velocity[3]);
+
+/**
+ * Free the Chebyshev approximation.
+ *
+ * \param chebyshev Approximation, created by predict_create_chebyshev()
+ **/
+void predict_destroy_chebyshev(predict_chebyshev_t *chebyshev);
+
+/**
+ * Chebyshev approximation of the positions of the sun and the moon over a
+ * time span, for creating time contexts at many times without evaluating
+ * their series. It is only read once created, so threads can share it.
+ **/
+typedef struct {
+	///Start of the span, Julian date in UTC
+	predict_julian_date_t start_time;
+	///End of the span, Julian date in UTC
+	predict_julian_date_t end_time;
+	///Length of each segment in days
+	double segment_length;
+	///Number of segments
+	size_t num_segments;
+	///Coefficients of segment i for component j at coefficients[(6*i + j)*PREDICT_CHEBYSHEV_COEFFICIENTS]: the ECI position of the sun for j = 0 to 2, and the direction of the moon scaled by its range approximation for j = 3 to 5
+	double *coefficients;
+	///Largest difference from the series of the sun found when checking the segments, relative to its distance
+	double max_sun_error;
+	///Largest difference from the series of the moon found when checking the segments, relative to its range
+	double max_moon_error;
+} predict_ephemeris_t;
+
+/**
+ * Fit Chebyshev segments to the positions of the sun and the moon over a
+ * time span.
+ *
+ * The segments start at four days and are halved until the fit is within
+ * the tolerance, down to one hour. Each segment is checked against the
+ * series halfway between its fit points, and the largest differences found
+ * are reported in the max_sun_error and max_moon_error fields. The first
+ * segments already meet a tolerance of 1e-9. Below about 1e-10 the
+ * rounding of the series themselves dominates and the tolerance may not be
+ * met.
+ *
+ * \param ephemeris Table to create
+ * \param start_time Start of the span, Julian date in UTC
+ * \param end_time End of the span, Julian date in UTC
+ * \param tolerance Tolerance relative to the distance, roughly the error in direction in radians. If it cannot be met, max_sun_error or max_moon_error exceeds it
+ * \return false if the span is empty or out of memory
+ **/
+bool predict_create_ephemeris(predict_ephemeris_t *ephemeris, predict_julian_date_t start_time, predict_julian_date_t end_time, double tolerance);
+
+/**
+ * Create a time context as predict_create_time_context() does, taking the
+ * sun and the moon from a table. The sidereal times are calculated exactly.
+ * Outside the span of the table, predict_create_time_context() is used.
+ *
+ * \param context Returned time context
+ * \param ephemeris Table, created by predict_create_ephemeris()
+ * \param time Julian date in UTC
+ * \param moon Whether to calculate the moon as well
+ **/
+void predict_create_time_context_ephemeris(predict_time_context_t *context, const predict_ephemeris_t *ephemeris, predict_julian_date_t time, bool moon);
+
+/**
+ * Free the sun and moon table.
+ *
+ * \param ephemeris Table, created by predict_create_ephemeris()
+ **/
+void predict_destroy_ephemeris(predict_ephemeris_t *ephemeris);
+
+/**
+ * Close approach between two satellites, found by predict_screen_conjunctions().
+ **/
+struct predict_conjunction {
+	///Index of the first satellite in the screened array
+	size_t primary;
+	///Index of the second satellite in the screened array, above primary
+	size_t secondary;
+	///Time of closest approach, Julian date in UTC
+	predict_julian_date_t time;
+	///Distance between the satellites at closest approach in km
+	double miss_distance;
+	///Relative speed of the satellites at closest approach in km/s
+	double relative_velocity;
+};
+
+/**
+ * Close approaches found by predict_screen_conjunctions(), in order of time.
+ **/
+typedef struct {
+	struct predict_conjunction *conjunctions;
+	size_t num_conjunctions;
+} predict_conjunctions_t;
+
+/**
+ * Find all close approaches between the satellites of a catalog during a time span.
+ *
+ * Pairs of satellites whose ranges between perigee and apogee do not come
+ * within the threshold are sieved out first. The remaining satellites are
+ * propagated with predict_orbit_batch() at coarse time steps and put in a
+ * spatial hash, so that only pairs near each other are compared. Each pair
+ * that may come within the threshold during a time step is refined to the
+ * time of closest approach, where the range rate is zero, with
+ * predict_orbit(). Only minima of the distance within the span are
+ * reported, not approaches still closing at its ends.
+ *
+ * \param conjunctions Returned close approaches. Free with predict_destroy_conjunctions()
+ * \param orbital_elements Array of orbital elements
+ * \param num_elements Number of orbital elements, below UINT32_MAX
+ * \param start_time Start of the span, Julian date in UTC
+ * \param end_time End of the span, Julian date in UTC
+ * \param threshold Largest miss distance reported, in km
+ * \param num_threads Number of threads, 0 for the number of online processors
+ * \return false if out of memory, or if num_elements is UINT32_MAX or more
+ **/
+bool predict_screen_conjunctions(predict_conjunctions_t *conjunctions, const predict_orbital_elements_t *orbital_elements, size_t num_elements, predict_julian_date_t start_time, predict_julian_date_t end_time, double threshold, int num_threads);
+
+/**
+ * Free the close approaches found by predict_screen_conjunctions().
+ *
+ * \param conjunctions Close approaches
+ **/
+void predict_destroy_conjunctions(predict_conjunctions_t *conjunctions);
+
+/**
+ * Type of eclipse event found by predict_eclipse_events().
+ **/
+enum predict_eclipse_event_type {
+	///The satellite enters the penumbra, where the earth starts to cover the sun
+	PREDICT_PENUMBRA_ENTRY,
+	///The satellite enters the umbra, where the earth covers the whole sun
+	PREDICT_UMBRA_ENTRY,
+	///The satellite leaves the umbra
+	PREDICT_UMBRA_EXIT,
+	///The satellite leaves the penumbra, back into full sunlight
+	PREDICT_PENUMBRA_EXIT
+};
+
+/**
+ * Satellite entering or leaving the shadow of the earth.
+ **/
+struct predict_eclipse_event {
+	///Time of the event, Julian date in UTC
+	predict_julian_date_t time;
+	///Type of the event
+	enum predict_eclipse_event_type type;
+};
+
+/**
+ * Eclipse events found by predict_eclipse_events(), in order of time.
+ **/
+typedef struct {
+	struct predict_eclipse_event *events;
+	size_t num_events;
+} predict_eclipse_events_t;
+
+/**
+ * Find the times a satellite enters and leaves the penumbra and the umbra of
+ * the earth within a time interval.
+ *
+ * The shadow depths are scanned with time steps as long as neither can
+ * reach zero within, given the largest angular speed of the satellite, so
+ * that sunlit arcs and the middle of eclipses are crossed in a few steps.
+ * Each sign change is then refined with Brent's method. The umbra is where
+ * predict_orbit() reports the satellite as eclipsed. Crossings less than a
+ * second apart may be missed.
+ *
+ * Only crossings within the interval are reported: a satellite in shadow at
+ * the start has no entry event for it. Use predict_orbit() for the state at
+ * the start of the interval.
+ *
+ * \param orbital_elements Orbital elements of satellite
+ * \param start_time Start of the interval, Julian date in UTC
+ * \param end_time End of the interval, Julian date in UTC
+ * \param events Returned events. Free with predict_destroy_eclipse_events()
+ * \return false if out of memory
+ **/
+bool predict_eclipse_events(const predict_orbital_elements_t *orbital_elements, predict_julian_date_t start_time, predict_julian_date_t end_time, predict_eclipse_events_t *events);
+
+/**
+ * Free the events found by predict_eclipse_events().
+ *
+ * \param events Eclipse events
+ **/
+void predict_destroy_eclipse_events(predict_eclipse_events_t *events);
+
 /**
  * Find whether an orbit is geosynchronous.
  *
@@ -325,6 +1042,57 @@ void predict_create_observer(predict_observer_t *obs, const char *name, double l
  **/
 void predict_observe_orbit(const predict_observer_t *observer, const struct predict_position *orbit, struct predict_observation *obs);
 
+/**
+ * Find relative position of satellite with respect to an observer, as
+ * predict_observe_orbit() does, taking the sidereal time and the position of
+ * the sun from a time context.
+ *
+ * \param observer Point of observation
+ * \param orbit Satellite orbit, at the time of the context
+ * \param context Time context, from predict_create_time_context()
+ * \param obs Return of object for position of the satellite relative to the observer
+ **/
+void predict_observe_orbit_context(const predict_observer_t *observer, const struct predict_position *orbit, const predict_time_context_t *context, struct predict_observation *obs);
+
+/**
+ * Observer with its position and local frame in Earth-fixed coordinates
+ * calculated in advance, by predict_prepare_observer().
+ **/
+typedef struct {
+	///Position in the Earth-fixed frame, in km
+	double position[3];
+	///Unit vector to the south in the Earth-fixed frame
+	double south[3];
+	///Unit vector to the east in the Earth-fixed frame
+	double east[3];
+	///Unit vector to zenith in the Earth-fixed frame
+	double zenith[3];
+} predict_prepared_observer_t;
+
+/**
+ * Prepare an observer for repeated observations with
+ * predict_observe_orbit_prepared(). The prepared observer does not refer to
+ * the observer, and stays valid after it is changed or freed.
+ *
+ * \param prepared Returned prepared observer
+ * \param observer Point of observation
+ **/
+void predict_prepare_observer(predict_prepared_observer_t *prepared, const predict_observer_t *observer);
+
+/**
+ * Find relative position of satellite with respect to a prepared observer,
+ * as predict_observe_orbit() does. The satellite is rotated into the
+ * Earth-fixed frame once, instead of the observer being moved to inertial
+ * coordinates at every call. The results agree with predict_observe_orbit()
+ * to rounding.
+ *
+ * \param observer Prepared observer, from predict_prepare_observer()
+ * \param orbit Satellite orbit
+ * \param context Time context at the time of the orbit, from predict_create_time_context(), or NULL to calculate the sidereal time and the position of the sun
+ * \param obs Return of object for position of the satellite relative to the observer
+ **/
+void predict_observe_orbit_prepared(const predict_prepared_observer_t *observer, const struct predict_position *orbit, const predict_time_context_t *context, struct predict_observation *obs);
+
 /**
  * Estimate relative position of the moon.
  *
@@ -335,6 +1103,17 @@ void predict_observe_orbit(const predict_observer_t *observer, const struct pred
  **/
 void predict_observe_moon(const predict_observer_t *observer, predict_julian_date_t time, struct predict_observation *obs);
 
+/**
+ * Estimate relative position of the moon, as predict_observe_moon() does,
+ * at the time of a time context. The position of the moon is taken from the
+ * context if it was created with it.
+ *
+ * \param observer Point of observation
+ * \param context Time context, from predict_create_time_context()
+ * \param obs Return object for position of the moon relative to the observer
+ **/
+void predict_observe_moon_context(const predict_observer_t *observer, const predict_time_context_t *context, struct predict_observation *obs);
+
 /**
  * Calculate the greenwich hour angle (longitude) of the moon.
  *
@@ -354,6 +1133,16 @@ double predict_moon_gha(predict_julian_date_t time);
  **/
 void predict_observe_sun(const predict_observer_t *observer, predict_julian_date_t time, struct predict_observation *obs);
 
+/**
+ * Estimate relative position of the sun, as predict_observe_sun() does,
+ * taking the sidereal time and the position of the sun from a time context.
+ *
+ * \param observer Point of observation
+ * \param context Time context, from predict_create_time_context()
+ * \param obs Return object for position of the sun relative to the observer
+ **/
+void predict_observe_sun_context(const predict_observer_t *observer, const predict_time_context_t *context, struct predict_observation *obs);
+
 /**
  * Calculate right ascension of the sun.
  *
@@ -442,6 +1231,137 @@ struct predict_observation predict_next_los(const predict_observer_t *observer,
  **/
 struct predict_observation predict_at_max_elevation(const predict_observer_t *observer, const predict_orbital_elements_t *orbital_elements, predict_julian_date_t start_time);
 
+/**
+ * Satellite pass over an observer, found by predict_passes().
+ **/
+struct predict_pass {
+	///Acquisition of signal, when the satellite rises above the horizon
+	struct predict_observation aos;
+	///Time of closest approach, when the range is smallest
+	struct predict_observation tca;
+	///Maximum elevation
+	struct predict_observation max_elevation;
+	///Loss of signal, when the satellite sets below the horizon
+	struct predict_observation los;
+};
+
+/**
+ * Passes found by predict_passes(), in order of time.
+ **/
+typedef struct {
+	struct predict_pass *passes;
+	size_t num_passes;
+} predict_passes_t;
+
+/**
+ * Find all passes of a satellite over an observer within a time interval.
+ *
+ * The elevation is scanned with time steps as long as the satellite cannot
+ * cross the horizon within, given its largest speed relative to the
+ * observer. Each crossing and each extremum of the elevation and the range
+ * is then refined with Brent's method. This is several times faster than
+ * chaining predict_next_aos(), predict_next_los() and
+ * predict_at_max_elevation() for each pass. Passes shorter than about ten
+ * seconds may be missed.
+ *
+ * A pass in progress at the start or the end of the interval, or when the
+ * satellite decays, is cut there: its AOS or LOS is the observation at that
+ * time, and its maximum elevation and closest approach may be too. The
+ * elevations are geometric, without refraction.
+ *
+ * \param observer Ground station
+ * \param orbital_elements Orbital elements of satellite
+ * \param start_time Start of the interval, Julian date in UTC
+ * \param end_time End of the interval, Julian date in UTC
+ * \param passes Returned passes. Free with predict_destroy_passes()
+ * \return false if out of memory
+ **/
+bool predict_passes(const predict_observer_t *observer, const predict_orbital_elements_t *orbital_elements, predict_julian_date_t start_time, predict_julian_date_t end_time, predict_passes_t *passes);
+
+/**
+ * Find all passes of a satellite over each of several observers within a
+ * time interval, as predict_passes() does for one.
+ *
+ * Each observer is scanned with its own time steps, but observations are
+ * brought forward by up to half a step to share a propagation of the
+ * satellite, which is then rotated into the Earth-fixed frame once for all
+ * observers. Only the refinement of AOS, LOS, TCA and maximum elevation
+ * propagates separately for each observer.
+ *
+ * \param observers Ground stations
+ * \param num_observers Number of ground stations
+ * \param orbital_elements Orbital elements of satellite
+ * \param start_time Start of the interval, Julian date in UTC
+ * \param end_time End of the interval, Julian date in UTC
+ * \param passes Returned passes of each ground station, num_observers long. Free each with predict_destroy_passes()
+ * \return false if out of memory
+ **/
+bool predict_passes_observers(const predict_observer_t *observers, size_t num_observers, const predict_orbital_elements_t *orbital_elements, predict_julian_date_t start_time, predict_julian_date_t end_time, predict_passes_t *passes);
+
+/**
+ * Free the passes found by predict_passes() or predict_passes_observers().
+ *
+ * \param passes Passes
+ **/
+void predict_destroy_passes(predict_passes_t *passes);
+
+/**
+ * Access windows of satellites over ground stations, found by
+ * predict_access_matrix().
+ *
+ * The windows are stored by column: window i is over observer[i], from
+ * aos[i] to los[i]. The windows of satellite s are those from
+ * satellite_offsets[s] to satellite_offsets[s+1], ordered by ground station
+ * and then by time.
+ **/
+typedef struct {
+	///Number of satellites
+	size_t num_satellites;
+	///Number of windows
+	size_t num_windows;
+	///First window of each satellite, num_satellites + 1 long
+	size_t *satellite_offsets;
+	///Index of the ground station of each window
+	uint32_t *observer;
+	///Julian date in UTC when the satellite rises above the horizon
+	predict_julian_date_t *aos;
+	///Julian date in UTC when the satellite sets below the horizon
+	predict_julian_date_t *los;
+	///Julian date in UTC of the maximum elevation
+	predict_julian_date_t *max_elevation_time;
+	///Maximum elevation in radians
+	double *max_elevation;
+} predict_access_t;
+
+/**
+ * Find the access windows of every satellite over every ground station
+ * within a time interval.
+ *
+ * The satellites are shared between the threads with work stealing. Each
+ * satellite is scanned over all ground stations at once with
+ * predict_passes_observers(), and ground stations the satellite never rises
+ * over are left out by predict_aos_happens() beforehand. Windows in progress
+ * at the start or the end of the interval are cut there.
+ *
+ * \param access Returned access windows. Free with predict_destroy_access()
+ * \param orbital_elements Array of orbital elements
+ * \param num_satellites Number of orbital elements, below 2^32
+ * \param observers Array of ground stations
+ * \param num_observers Number of ground stations, below 2^32
+ * \param start_time Start of the interval, Julian date in UTC
+ * \param end_time End of the interval, Julian date in UTC
+ * \param num_threads Number of threads, including the calling thread. 0 uses one per online processor
+ * \return false if out of memory
+ **/
+bool predict_access_matrix(predict_access_t *access, const predict_orbital_elements_t *orbital_elements, size_t num_satellites, const predict_observer_t *observers, size_t num_observers, predict_julian_date_t start_time, predict_julian_date_t end_time, int num_threads);
+
+/**
+ * Free the access windows found by predict_access_matrix().
+ *
+ * \param access Access windows
+ **/
+void predict_destroy_access(predict_access_t *access);
+
 /**
  * Calculate doppler shift of a given downlink frequency with respect to an observer.
  *
@@ -452,6 +1372,126 @@ struct predict_observation predict_at_max_elevation(const predict_observer_t *ob
  **/
 double predict_doppler_shift(const struct predict_observation *observation, double downlink_frequency);
 
+/**
+ * Doppler shifts of one or more carrier frequencies at regular times,
+ * created by predict_create_doppler_profile().
+ **/
+typedef struct {
+	///Time of the first sample, Julian date in UTC
+	predict_julian_date_t start_time;
+	///Time between samples in seconds
+	double time_step;
+	///Number of samples
+	size_t num_samples;
+	///Carrier frequencies
+	double *frequencies;
+	///Number of carrier frequencies
+	size_t num_frequencies;
+	///Range rate of each sample, km/s
+	double *range_rate;
+	///Derivative of the range rate of each sample, km/s^2. The drift of the shift of frequency f is -f*1000*range_rate_derivative/c
+	double *range_rate_derivative;
+	///Shift of frequency j at sample i at doppler_shift[i*num_frequencies + j], as predict_doppler_shift() returns it
+	double *doppler_shift;
+	///Number of knots the range rate was interpolated between
+	size_t num_knots;
+	///Largest interpolation error of the shift of the highest frequency found when checking the knots
+	double max_error;
+} predict_doppler_profile_t;
+
+/**
+ * Calculate the doppler shifts of carrier frequencies over a time interval,
+ * at a sample rate high enough to retune a receiver from.
+ *
+ * The range rate and its derivative are calculated at knots no more than two
+ * minutes apart, and interpolated between them with cubic Hermite
+ * polynomials. The knots are placed closer until the interpolated shift of
+ * the highest frequency is within the tolerance halfway between them, down
+ * to half a second, and the largest error found there is reported in the
+ * max_error field. A pass typically needs a few dozen propagations whatever
+ * the sample rate.
+ *
+ * \param profile Returned profile. Free with predict_destroy_doppler_profile()
+ * \param observer Ground station
+ * \param orbital_elements Orbital elements of satellite
+ * \param start_time Start of the interval, Julian date in UTC
+ * \param end_time End of the interval, Julian date in UTC. The interval is cut where the satellite decays
+ * \param time_step Time between samples in seconds
+ * \param frequencies Carrier frequencies
+ * \param num_frequencies Number of carrier frequencies
+ * \param tolerance Tolerance on the shift of the highest frequency, in the unit of the frequencies. If it cannot be met, max_error exceeds it
+ * \return false if the interval is empty, there are no frequencies, the orbit could not be predicted or out of memory
+ **/
+bool predict_create_doppler_profile(predict_doppler_profile_t *profile, const predict_observer_t *observer, const predict_orbital_elements_t *orbital_elements, predict_julian_date_t start_time, predict_julian_date_t end_time, double time_step, const double *frequencies, size_t num_frequencies, double tolerance);
+
+/**
+ * Free the doppler profile.
+ *
+ * \param profile Profile, created by predict_create_doppler_profile()
+ **/
+void predict_destroy_doppler_profile(predict_doppler_profile_t *profile);
+
+struct tracker_state;
+
+/**
+ * Observations of a satellite calculated ahead of time on a producer thread,
+ * for pointing an antenna from a control loop, created by
+ * predict_create_tracker().
+ **/
+typedef struct {
+	///Time between observations in seconds
+	double time_step;
+	///Number of observations the ring holds
+	size_t capacity;
+	///Ring and producer thread
+	struct tracker_state *state;
+} predict_tracker_t;
+
+/**
+ * Start tracking a satellite.
+ *
+ * A producer thread observes the satellite at regular times from the start
+ * time, with the resonance integrator continued as in
+ * predict_orbit_resonant(), and writes the observations into a lock-free
+ * single-producer single-consumer ring. It keeps the ring filled up to the
+ * lookahead, and when the consumer asks for a time beyond the ring, it
+ * skips ahead to that time. It stops when the orbit cannot be predicted.
+ *
+ * \param tracker Returned tracker. Stop and free with predict_destroy_tracker()
+ * \param observer Ground station
+ * \param orbital_elements Orbital elements of satellite, kept by reference until the tracker is destroyed
+ * \param start_time Time of the first observation, Julian date in UTC
+ * \param time_step Time between observations in seconds
+ * \param lookahead Time in seconds the producer keeps observed ahead of the consumer
+ * \return false if the time step or the lookahead is invalid, out of memory, or the thread could not be created
+ **/
+bool predict_create_tracker(predict_tracker_t *tracker, const predict_observer_t *observer, const predict_orbital_elements_t *orbital_elements, predict_julian_date_t start_time, double time_step, double lookahead);
+
+/**
+ * Get the observation of a tracked satellite at a time, interpolated between
+ * the observations of the producer thread.
+ *
+ * Does not predict the orbit, block or allocate, and takes time bounded by
+ * the capacity of the ring. The azimuth, elevation and range are interpolated
+ * with cubic Hermite polynomials from their rates, the rates from the
+ * derivatives of the polynomials, and the range vector linearly. Observations
+ * before the one preceding the time are released to the producer, so times
+ * should not decrease. Must only be called from one thread at a time.
+ *
+ * \param tracker Tracker, created by predict_create_tracker()
+ * \param time Julian date in UTC
+ * \param obs Returned observation
+ * \return 0 on success, -1 if the producer has not observed the satellite at that time yet
+ **/
+int predict_tracker_observe(predict_tracker_t *tracker, predict_julian_date_t time, struct predict_observation *obs);
+
+/**
+ * Stop the producer thread and free the tracker.
+ *
+ * \param tracker Tracker, created by predict_create_tracker()
+ **/
+void predict_destroy_tracker(predict_tracker_t *tracker);
+
 /**
  * Calculate squint angle for satellite, i.e. angle between the satellite antenna and the QTH antenna.
  *
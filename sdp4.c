@@ -118,23 +118,26 @@ void sdp4_init(const predict_orbital_elements_t *tle, struct predict_sdp4 *m)
 
 void sdp4_predict(const struct predict_sdp4 *m, double tsince, struct model_output *output)
 {
+	sdp4_predict_resonant(m, NULL, tsince, output);
+}
 
-	int i;
-	double a, axn, ayn, aynl, beta, betal, capu, cos2u, cosepw, cosik,
-	cosnok, cosu, cosuk, ecose, elsq, epw, esine, pl,
-	rdot,
-	rdotk, rfdot, rfdotk, rk, sin2u, sinepw, sinik, sinnok, sinu,
-	sinuk, tempe, templ, tsq, u, uk, ux, uy, uz, vx, vy, vz, xl,
-	xlt, xmam, xmdf, xmx, xmy, xnoddf, xll,
-	r,
-	temp, tempa, temp1,
-	temp2, temp3, temp4, temp5, temp6;
-	double xnodek, xinck;
+void sdp4_mean_elements(const struct predict_sdp4 *m, struct predict_sdp4_resonance *state, double tsince, struct sdp4_mean_elements *mean)
+{
+	double xmam, xmdf, xnoddf, tempa, tempe, templ, tsq;
 
 	/* Initialize dynamic part of deep_arg */
 	deep_arg_dynamic_t deep_dyn;
 	deep_arg_dynamic_init(m, &deep_dyn);
 
+	/* Continue resonance integration from the previous call. Integrating */
+	/* back towards epoch would not reproduce the forward integration, */
+	/* so restart from epoch in that case. */
+	if ((state != NULL) && (state->model == m) && (fabs(tsince) >= fabs(state->atime)) && ((tsince < 0) == (state->atime < 0))) {
+		deep_dyn.atime = state->atime;
+		deep_dyn.xli = state->xli;
+		deep_dyn.xni = state->xni;
+	}
+
 	/* Update for secular gravity and atmospheric drag */
 	xmdf=m->xmo+m->deep_arg.xmdot*tsince;
 	deep_dyn.omgadf=m->omegao+m->deep_arg.omgdot*tsince;
@@ -152,8 +155,15 @@ void sdp4_predict(const struct predict_sdp4 *m, double tsince, struct model_outp
 
 	sdp4_deep(m, DPSecular, &m->deep_arg, &deep_dyn);
 
+	if ((state != NULL) && m->resonanceFlag) {
+		state->model = m;
+		state->atime = deep_dyn.atime;
+		state->xli = deep_dyn.xli;
+		state->xni = deep_dyn.xni;
+	}
+
 	xmdf=deep_dyn.xll;
-	a=pow(XKE/deep_dyn.xn,TWO_THIRD)*tempa*tempa;
+	mean->a=pow(XKE/deep_dyn.xn,TWO_THIRD)*tempa*tempa;
 	deep_dyn.em=deep_dyn.em-tempe;
 	xmam=xmdf+m->deep_arg.xnodp*templ;
 
@@ -163,20 +173,47 @@ void sdp4_predict(const struct predict_sdp4 *m, double tsince, struct model_outp
 	sdp4_deep(m, DPPeriodic,&m->deep_arg, &deep_dyn);
 
 	xmam=deep_dyn.xll;
-	xl=xmam+deep_dyn.omgadf+deep_dyn.xnode;
-	beta=sqrt(1-deep_dyn.em*deep_dyn.em);
-	deep_dyn.xn=XKE/pow(a,1.5);
+	mean->xl=xmam+deep_dyn.omgadf+deep_dyn.xnode;
+	mean->em=deep_dyn.em;
+	mean->omgadf=deep_dyn.omgadf;
+	mean->xnode=deep_dyn.xnode;
+	mean->xinc=deep_dyn.xinc;
+}
+
+void sdp4_predict_resonant(const struct predict_sdp4 *m, struct predict_sdp4_resonance *state, double tsince, struct model_output *output)
+{
+
+	int i;
+	double a, axn, ayn, aynl, beta, betal, capu, cos2u, cosepw, cosik,
+	cosnok, cosu, cosuk, ecose, elsq, epw, esine, pl,
+	rdot,
+	rdotk, rfdot, rfdotk, rk, sin2u, sinepw, sinik, sinnok, sinu,
+	sinuk, u, uk, ux, uy, uz, vx, vy, vz, xl,
+	xlt, xmx, xmy, xll, xn,
+	r,
+	temp, temp1,
+	temp2, temp3, temp4, temp5, temp6;
+	double xnodek, xinck;
+
+	/* Secular and deep-space updates */
+	struct sdp4_mean_elements mean;
+	sdp4_mean_elements(m, state, tsince, &mean);
+
+	a=mean.a;
+	xl=mean.xl;
+	beta=sqrt(1-mean.em*mean.em);
+	xn=XKE/pow(a,1.5);
 
 	/* Long period periodics */
-	axn=deep_dyn.em*cos(deep_dyn.omgadf);
+	axn=mean.em*cos(mean.omgadf);
 	temp=1/(a*beta*beta);
 	xll=temp*m->xlcof*axn;
 	aynl=temp*m->aycof;
 	xlt=xl+xll;
-	ayn=deep_dyn.em*sin(deep_dyn.omgadf)+aynl;
+	ayn=mean.em*sin(mean.omgadf)+aynl;
 
 	/* Solve Kepler's Equation */
-	capu=FMod2p(xlt-deep_dyn.xnode);
+	capu=FMod2p(xlt-mean.xnode);
 	temp2=capu;
 	i=0;
 
@@ -222,10 +259,10 @@ void sdp4_predict(const struct predict_sdp4 *m, double tsince, struct model_outp
 	/* Update for short periodics */
 	rk=r*(1-1.5*temp2*betal*m->x3thm1)+0.5*temp1*m->x1mth2*cos2u;
 	uk=u-0.25*temp2*m->x7thm1*sin2u;
-	xnodek=deep_dyn.xnode+1.5*temp2*m->deep_arg.cosio*sin2u;
-	xinck=deep_dyn.xinc+1.5*temp2*m->deep_arg.cosio*m->deep_arg.sinio*cos2u;
-	rdotk=rdot-deep_dyn.xn*temp1*m->x1mth2*sin2u;
-	rfdotk=rfdot+deep_dyn.xn*temp1*(m->x1mth2*cos2u+1.5*m->x3thm1);
+	xnodek=mean.xnode+1.5*temp2*m->deep_arg.cosio*sin2u;
+	xinck=mean.xinc+1.5*temp2*m->deep_arg.cosio*m->deep_arg.sinio*cos2u;
+	rdotk=rdot-xn*temp1*m->x1mth2*sin2u;
+	rfdotk=rfdot+xn*temp1*(m->x1mth2*cos2u+1.5*m->x3thm1);
 
 	/* Orientation vectors */
 	sinuk=sin(uk);
@@ -252,7 +289,7 @@ void sdp4_predict(const struct predict_sdp4 *m, double tsince, struct model_outp
 	output->vel[2] = rdotk*uz+rfdotk*vz;
 
 	/* Phase in radians */
-	double phase=xlt-deep_dyn.xnode-deep_dyn.omgadf+TWO_PI;
+	double phase=xlt-mean.xnode-mean.omgadf+TWO_PI;
 
 	if (phase<0.0)
 		phase+=TWO_PI;
@@ -260,7 +297,7 @@ void sdp4_predict(const struct predict_sdp4 *m, double tsince, struct model_outp
 	phase=FMod2p(phase);
 	output->phase = phase;
 
-	output->omgadf = deep_dyn.omgadf;
+	output->omgadf = mean.omgadf;
 	output->xnodek = xnodek;
 	output->xinck = xinck;
 }
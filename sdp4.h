@@ -48,6 +48,46 @@ void sdp4_init(const predict_orbital_elements_t *orbital_elements, struct predic
  **/
 void sdp4_predict(const struct predict_sdp4 *m, double tsince, struct model_output *output);
 
+/**
+ * Mean elements of a deep-space orbit after the secular and deep-space updates of SDP4, from which its periodic terms are calculated.
+ **/
+struct sdp4_mean_elements {
+	///Semi-major axis
+	double a;
+	///Eccentricity
+	double em;
+	///Argument of perigee
+	double omgadf;
+	///Right ascension of the ascending node
+	double xnode;
+	///Inclination
+	double xinc;
+	///Mean longitude, the sum of mean anomaly, argument of perigee and node
+	double xl;
+};
+
+/**
+ * Calculate the mean elements of a deep-space orbit at a time, the first part of sdp4_predict_resonant().
+ *
+ * \param m SDP4 model parameters
+ * \param state Resonance integrator state as in sdp4_predict_resonant(). May be NULL
+ * \param tsince Time since epoch of TLE in minutes
+ * \param mean Output mean elements
+ * \copyright GPLv2+
+ **/
+void sdp4_mean_elements(const struct predict_sdp4 *m, struct predict_sdp4_resonance *state, double tsince, struct sdp4_mean_elements *mean);
+
+/**
+ * Predict ECI position and velocity of deep-space orbit like sdp4_predict(), but continue the resonance integration from a previous call. Gives the same result as sdp4_predict().
+ *
+ * \param m SDP4 model parameters
+ * \param state Resonance integrator state, restarted from epoch if it belongs to another model or is further from epoch than tsince. Updated on return. NULL integrates from epoch
+ * \param tsince Time since epoch of TLE in minutes
+ * \param output Modeled output parameters
+ * \copyright GPLv2+
+ **/
+void sdp4_predict_resonant(const struct predict_sdp4 *m, struct predict_sdp4_resonance *state, double tsince, struct model_output *output);
+
 /**
  * Deep space perturbations. Original Deep() function.
  *
@@ -1,5 +1,7 @@
 #include "sgp4.h"
 
+#include <string.h>
+
 #include "defs.h"
 #include "unsorted.h"
 
@@ -258,3 +260,570 @@ void sgp4_predict(const struct predict_sgp4 *m, double tsince, struct model_outp
 	output->xnodek = xnodek;
 
 }
+
+/* .... Vectorised SGP4 across satellites .... */
+
+/**
+ * Vector of one double per lane. Arithmetic on this type compiles to SSE2,
+ * AVX2 or AVX-512 instructions depending on the clone selected at runtime.
+ **/
+typedef double sgp4_vec_t __attribute__((vector_size(SGP4_LANES*sizeof(double))));
+
+/**
+ * Integer vectors with the same lane layout as sgp4_vec_t, used for quadrant
+ * selection and sign manipulation.
+ **/
+typedef long long sgp4_ivec_t __attribute__((vector_size(SGP4_LANES*sizeof(long long))));
+typedef unsigned long long sgp4_uvec_t __attribute__((vector_size(SGP4_LANES*sizeof(long long))));
+
+#if defined(__x86_64__) && defined(__has_attribute)
+#if __has_attribute(target_clones)
+//GCC only clears the upper vector registers on return from the AVX clones with -fexpensive-optimizations (on at -O2).
+//Without it, the SSE code running afterwards, such as the SDP4 model in a mixed batch, slows down several times.
+#define SGP4_LANES_TARGETS __attribute__((target_clones("avx512f", "avx2", "default"), optimize("expensive-optimizations")))
+#endif
+#endif
+
+#ifndef SGP4_LANES_TARGETS
+#define SGP4_LANES_TARGETS
+#endif
+
+/**
+ * Unaligned view of SGP4_LANES doubles, for loading and storing sgp4_vec_t from plain arrays.
+ **/
+typedef double sgp4_vec_unaligned_t __attribute__((vector_size(SGP4_LANES*sizeof(double)), aligned(sizeof(double)), may_alias));
+
+#define SGP4_VEC_LOAD(x) (*(const sgp4_vec_unaligned_t*)(x))
+#define SGP4_VEC_STORE(x, v) (*(sgp4_vec_unaligned_t*)(x) = (v))
+
+///Round to nearest integer, valid for |x| < 2^51. Adding 1.5*2^52 leaves no fraction bits.
+#define SGP4_VEC_ROUND(x) (((x) + 6755399441055744.0) - 6755399441055744.0)
+
+///Pick lanes from a where mask is set, otherwise from b
+#define SGP4_VEC_SELECT(mask, a, b) ((sgp4_vec_t)(((sgp4_ivec_t)(a) & (mask)) | ((sgp4_ivec_t)(b) & ~(mask))))
+
+//vectors are passed by pointer, since passing them by value depends on the instruction set of the clone
+
+static inline __attribute__((always_inline)) void sgp4_vec_sqrt(const sgp4_vec_t *x, sgp4_vec_t *result)
+{
+	for (int i=0; i < SGP4_LANES; i++) {
+		(*result)[i] = sqrt((*x)[i]);
+	}
+}
+
+///pi/2 split into three parts for Cody-Waite argument reduction (from fdlibm)
+#define SGP4_PIO2_1	1.57079632673412561417e+00
+#define SGP4_PIO2_2	6.07710050630396597660e-11
+#define SGP4_PIO2_3	2.02226624871116645580e-21
+
+/**
+ * Sine and cosine of each lane. Argument reduction is accurate for |x| < 1e5
+ * radians, and the kernel polynomials are the fdlibm ones, giving results
+ * within a few ulps of libm.
+ **/
+static inline __attribute__((always_inline)) void sgp4_vec_sincos(const sgp4_vec_t *x, sgp4_vec_t *s, sgp4_vec_t *c)
+{
+	sgp4_vec_t q = SGP4_VEC_ROUND(*x*(2.0/M_PI));
+	sgp4_vec_t r = ((*x - q*SGP4_PIO2_1) - q*SGP4_PIO2_2) - q*SGP4_PIO2_3;
+	sgp4_ivec_t quadrant = __builtin_convertvector(q, sgp4_ivec_t);
+
+	sgp4_vec_t z = r*r;
+	sgp4_vec_t sin_r = r + r*z*(-1.66666666666666324348e-01 + z*(8.33333333332248946124e-03 + z*(-1.98412698298579493134e-04 + z*(2.75573137070700676789e-06 + z*(-2.50507602534068634195e-08 + z*1.58969099521155010221e-10)))));
+	sgp4_vec_t cos_r = 1.0 - 0.5*z + z*z*(4.16666666666666019037e-02 + z*(-1.38888888888741095749e-03 + z*(2.48015872894767294178e-05 + z*(-2.75573143513906633035e-07 + z*(2.08757232129817482790e-09 + z*-1.13596475577881948265e-11)))));
+
+	//odd quadrants swap sine and cosine, quadrants 2 and 3 negate sine, quadrants 1 and 2 negate cosine
+	sgp4_ivec_t swap = (quadrant & 1) != 0;
+	sgp4_uvec_t sin_sign = ((sgp4_uvec_t)quadrant & 2) << 62;
+	sgp4_uvec_t cos_sign = ((sgp4_uvec_t)(quadrant + 1) & 2) << 62;
+	*s = (sgp4_vec_t)((sgp4_uvec_t)SGP4_VEC_SELECT(swap, cos_r, sin_r) ^ sin_sign);
+	*c = (sgp4_vec_t)((sgp4_uvec_t)SGP4_VEC_SELECT(swap, sin_r, cos_r) ^ cos_sign);
+}
+
+void sgp4_lanes_set(struct sgp4_lanes *lanes, int lane, const struct predict_sgp4 *m)
+{
+	//the terms below are dropped by sgp4_predict() for simple orbits. Zeroing them makes the lane kernel branch-free.
+	bool full = !m->simpleFlag;
+
+	lanes->aodp[lane] = m->aodp;
+	lanes->aycof[lane] = m->aycof;
+	lanes->c1[lane] = m->c1;
+	lanes->c4[lane] = m->c4;
+	lanes->c5[lane] = full ? m->c5 : 0.0;
+	lanes->cosio[lane] = m->cosio;
+	lanes->d2[lane] = full ? m->d2 : 0.0;
+	lanes->d3[lane] = full ? m->d3 : 0.0;
+	lanes->d4[lane] = full ? m->d4 : 0.0;
+	lanes->delmo[lane] = m->delmo;
+	lanes->omgcof[lane] = full ? m->omgcof : 0.0;
+	lanes->eta[lane] = m->eta;
+	lanes->omgdot[lane] = m->omgdot;
+	lanes->sinio[lane] = m->sinio;
+	lanes->xnodp[lane] = m->xnodp;
+	lanes->sinmo[lane] = m->sinmo;
+	lanes->t2cof[lane] = m->t2cof;
+	lanes->t3cof[lane] = full ? m->t3cof : 0.0;
+	lanes->t4cof[lane] = full ? m->t4cof : 0.0;
+	lanes->t5cof[lane] = full ? m->t5cof : 0.0;
+	lanes->x1mth2[lane] = m->x1mth2;
+	lanes->x3thm1[lane] = m->x3thm1;
+	lanes->x7thm1[lane] = m->x7thm1;
+	lanes->xmcof[lane] = full ? m->xmcof : 0.0;
+	lanes->xmdot[lane] = m->xmdot;
+	lanes->xnodcf[lane] = m->xnodcf;
+	lanes->xnodot[lane] = m->xnodot;
+	lanes->xlcof[lane] = m->xlcof;
+	lanes->bstar[lane] = m->bstar;
+	lanes->xincl[lane] = m->xincl;
+	lanes->xnodeo[lane] = m->xnodeo;
+	lanes->eo[lane] = m->eo;
+	lanes->omegao[lane] = m->omegao;
+	lanes->xmo[lane] = m->xmo;
+}
+
+#define LANE(field) SGP4_VEC_LOAD(m->field)
+
+SGP4_LANES_TARGETS
+void sgp4_predict_lanes(const struct sgp4_lanes *m, const double tsince_lanes[SGP4_LANES], double pos[3][SGP4_LANES], double vel[3][SGP4_LANES])
+{
+	sgp4_vec_t tsince = SGP4_VEC_LOAD(tsince_lanes);
+
+	/* Update for secular gravity and atmospheric drag. */
+	sgp4_vec_t xmdf = LANE(xmo) + LANE(xmdot)*tsince;
+	sgp4_vec_t omgadf = LANE(omegao) + LANE(omgdot)*tsince;
+	sgp4_vec_t xnoddf = LANE(xnodeo) + LANE(xnodot)*tsince;
+	sgp4_vec_t tsq = tsince*tsince;
+	sgp4_vec_t xnode = xnoddf + LANE(xnodcf)*tsq;
+	sgp4_vec_t tcube = tsq*tsince;
+	sgp4_vec_t tfour = tsince*tcube;
+
+	/* Terms only used for non-simple orbits have zero coefficients for simple orbits */
+	sgp4_vec_t sin_xmdf, cos_xmdf;
+	sgp4_vec_sincos(&xmdf, &sin_xmdf, &cos_xmdf);
+	sgp4_vec_t delomg = LANE(omgcof)*tsince;
+	sgp4_vec_t delm_base = 1.0 + LANE(eta)*cos_xmdf;
+	sgp4_vec_t delm = LANE(xmcof)*(delm_base*delm_base*delm_base - LANE(delmo));
+	sgp4_vec_t temp = delomg + delm;
+	sgp4_vec_t xmp = xmdf + temp;
+	sgp4_vec_t omega = omgadf - temp;
+	sgp4_vec_t tempa = 1.0 - LANE(c1)*tsince - LANE(d2)*tsq - LANE(d3)*tcube - LANE(d4)*tfour;
+
+	sgp4_vec_t sin_xmp, cos_xmp;
+	sgp4_vec_sincos(&xmp, &sin_xmp, &cos_xmp);
+	sgp4_vec_t tempe = LANE(bstar)*LANE(c4)*tsince + LANE(bstar)*LANE(c5)*(sin_xmp - LANE(sinmo));
+	sgp4_vec_t templ = LANE(t2cof)*tsq + LANE(t3cof)*tcube + tfour*(LANE(t4cof) + tsince*LANE(t5cof));
+
+	sgp4_vec_t a = LANE(aodp)*tempa*tempa;
+	sgp4_vec_t e = LANE(eo) - tempe;
+	sgp4_vec_t xl = xmp + omega + xnode + LANE(xnodp)*templ;
+	sgp4_vec_t beta, sqrt_a;
+	temp = 1.0 - e*e;
+	sgp4_vec_sqrt(&temp, &beta);
+	sgp4_vec_sqrt(&a, &sqrt_a);
+	sgp4_vec_t xn = XKE/(a*sqrt_a);
+
+	/* Long period periodics */
+	sgp4_vec_t sin_omega, cos_omega;
+	sgp4_vec_sincos(&omega, &sin_omega, &cos_omega);
+	sgp4_vec_t axn = e*cos_omega;
+	temp = 1.0/(a*beta*beta);
+	sgp4_vec_t xll = temp*LANE(xlcof)*axn;
+	sgp4_vec_t aynl = temp*LANE(aycof);
+	sgp4_vec_t xlt = xl + xll;
+	sgp4_vec_t ayn = e*sin_omega + aynl;
+
+	/* Solve Kepler's Equation with a fixed number of iterations. */
+	/* The argument is reduced to [-pi, pi] instead of [0, 2pi]. */
+	sgp4_vec_t capu = xlt - xnode;
+	sgp4_vec_t revs = SGP4_VEC_ROUND(capu*(1.0/TWO_PI));
+	capu = (capu - revs*(4.0*SGP4_PIO2_1)) - revs*(4.0*SGP4_PIO2_2);
+
+	sgp4_vec_t epw = capu;
+	sgp4_vec_t sinepw, cosepw, temp3, temp4, temp5, temp6;
+	for (int i=0; i < SGP4_KEPLER_ITERATIONS; i++) {
+		sgp4_vec_t temp2 = epw;
+		sgp4_vec_sincos(&temp2, &sinepw, &cosepw);
+		temp3 = axn*sinepw;
+		temp4 = ayn*cosepw;
+		temp5 = axn*cosepw;
+		temp6 = ayn*sinepw;
+		epw = (capu - temp4 + temp3 - temp2)/(1.0 - temp5 - temp6) + temp2;
+	}
+
+	/* Short period preliminary quantities */
+	sgp4_vec_t ecose = temp5 + temp6;
+	sgp4_vec_t esine = temp3 - temp4;
+	sgp4_vec_t elsq = axn*axn + ayn*ayn;
+	temp = 1.0 - elsq;
+	sgp4_vec_t pl = a*temp;
+	sgp4_vec_t r = a*(1.0 - ecose);
+	sgp4_vec_t temp1 = 1.0/r;
+	sgp4_vec_t rdot = XKE*sqrt_a*esine*temp1;
+	sgp4_vec_t sqrt_pl, betal;
+	sgp4_vec_sqrt(&pl, &sqrt_pl);
+	sgp4_vec_sqrt(&temp, &betal);
+	sgp4_vec_t rfdot = XKE*sqrt_pl*temp1;
+	sgp4_vec_t temp2 = a*temp1;
+	temp3 = 1.0/(1.0 + betal);
+	sgp4_vec_t cosu = temp2*(cosepw - axn + ayn*esine*temp3);
+	sgp4_vec_t sinu = temp2*(sinepw - ayn - axn*esine*temp3);
+	sgp4_vec_t sin2u = 2.0*sinu*cosu;
+	sgp4_vec_t cos2u = 2.0*cosu*cosu - 1.0;
+	temp = 1.0/pl;
+	temp1 = CK2*temp;
+	temp2 = temp1*temp;
+
+	/* Update for short periodics. uk = u - delu is applied through the */
+	/* angle difference identities instead of atan2(). */
+	sgp4_vec_t rk = r*(1.0 - 1.5*temp2*betal*LANE(x3thm1)) + 0.5*temp1*LANE(x1mth2)*cos2u;
+	sgp4_vec_t delu = 0.25*temp2*LANE(x7thm1)*sin2u;
+	sgp4_vec_t xnodek = xnode + 1.5*temp2*LANE(cosio)*sin2u;
+	sgp4_vec_t xinck = LANE(xincl) + 1.5*temp2*LANE(cosio)*LANE(sinio)*cos2u;
+	sgp4_vec_t rdotk = rdot - xn*temp1*LANE(x1mth2)*sin2u;
+	sgp4_vec_t rfdotk = rfdot + xn*temp1*(LANE(x1mth2)*cos2u + 1.5*LANE(x3thm1));
+
+	/* Orientation vectors */
+	sgp4_vec_t unorm;
+	temp = sinu*sinu + cosu*cosu;
+	sgp4_vec_sqrt(&temp, &unorm);
+	unorm = 1.0/unorm;
+	sgp4_vec_t sindelu, cosdelu;
+	sgp4_vec_sincos(&delu, &sindelu, &cosdelu);
+	sgp4_vec_t sinuk = unorm*(sinu*cosdelu - cosu*sindelu);
+	sgp4_vec_t cosuk = unorm*(cosu*cosdelu + sinu*sindelu);
+	sgp4_vec_t sinik, cosik, sinnok, cosnok;
+	sgp4_vec_sincos(&xinck, &sinik, &cosik);
+	sgp4_vec_sincos(&xnodek, &sinnok, &cosnok);
+	sgp4_vec_t xmx = -sinnok*cosik;
+	sgp4_vec_t xmy = cosnok*cosik;
+	sgp4_vec_t ux = xmx*sinuk + cosnok*cosuk;
+	sgp4_vec_t uy = xmy*sinuk + sinnok*cosuk;
+	sgp4_vec_t uz = sinik*sinuk;
+	sgp4_vec_t vx = xmx*cosuk - cosnok*sinuk;
+	sgp4_vec_t vy = xmy*cosuk - sinnok*sinuk;
+	sgp4_vec_t vz = sinik*cosuk;
+
+	/* Position and velocity */
+	SGP4_VEC_STORE(pos[0], rk*ux);
+	SGP4_VEC_STORE(pos[1], rk*uy);
+	SGP4_VEC_STORE(pos[2], rk*uz);
+	SGP4_VEC_STORE(vel[0], rdotk*ux + rfdotk*vx);
+	SGP4_VEC_STORE(vel[1], rdotk*uy + rfdotk*vy);
+	SGP4_VEC_STORE(vel[2], rdotk*uz + rfdotk*vz);
+}
+
+/**
+ * Vector of SGP4_FLOAT_LANES floats, twice as many lanes as sgp4_vec_t in the same register width.
+ **/
+typedef float sgp4_fvec_t __attribute__((vector_size(SGP4_FLOAT_LANES*sizeof(float))));
+
+/**
+ * Integer vectors with the same lane layout as sgp4_fvec_t.
+ **/
+typedef int sgp4_fivec_t __attribute__((vector_size(SGP4_FLOAT_LANES*sizeof(int))));
+typedef unsigned int sgp4_fuvec_t __attribute__((vector_size(SGP4_FLOAT_LANES*sizeof(int))));
+
+/**
+ * Double precision vector with the lanes of sgp4_fvec_t, for the secular angles.
+ **/
+typedef double sgp4_fdvec_t __attribute__((vector_size(SGP4_FLOAT_LANES*sizeof(double))));
+
+/**
+ * Unaligned views of SGP4_FLOAT_LANES floats and doubles, for loading and storing from plain arrays.
+ **/
+typedef float sgp4_fvec_unaligned_t __attribute__((vector_size(SGP4_FLOAT_LANES*sizeof(float)), aligned(sizeof(float)), may_alias));
+typedef double sgp4_fdvec_unaligned_t __attribute__((vector_size(SGP4_FLOAT_LANES*sizeof(double)), aligned(sizeof(double)), may_alias));
+
+#define SGP4_FVEC_LOAD(x) (*(const sgp4_fvec_unaligned_t*)(x))
+#define SGP4_FVEC_STORE(x, v) (*(sgp4_fvec_unaligned_t*)(x) = (v))
+#define SGP4_FDVEC_LOAD(x) (*(const sgp4_fdvec_unaligned_t*)(x))
+
+///Round to nearest integer, valid for |x| < 2^22. Adding 1.5*2^23 leaves no fraction bits.
+#define SGP4_FVEC_ROUND(x) (((x) + 12582912.0f) - 12582912.0f)
+
+///Pick lanes from a where mask is set, otherwise from b
+#define SGP4_FVEC_SELECT(mask, a, b) ((sgp4_fvec_t)(((sgp4_fivec_t)(a) & (mask)) | ((sgp4_fivec_t)(b) & ~(mask))))
+
+static inline __attribute__((always_inline)) void sgp4_fvec_sqrt(const sgp4_fvec_t *x, sgp4_fvec_t *result)
+{
+	for (int i=0; i < SGP4_FLOAT_LANES; i++) {
+		(*result)[i] = sqrtf((*x)[i]);
+	}
+}
+
+/**
+ * Reduce angles in double precision to [-pi, pi] and round them to single precision.
+ **/
+static inline __attribute__((always_inline)) void sgp4_fdvec_reduce(const sgp4_fdvec_t *x, sgp4_fvec_t *result)
+{
+	sgp4_fdvec_t revs = SGP4_VEC_ROUND(*x*(1.0/TWO_PI));
+	*result = __builtin_convertvector((*x - revs*(4.0*SGP4_PIO2_1)) - revs*(4.0*SGP4_PIO2_2), sgp4_fvec_t);
+}
+
+///pi/2 split into three parts for Cody-Waite argument reduction in single precision (from Cephes)
+#define SGP4_FLOAT_PIO2_1	1.5703125f
+#define SGP4_FLOAT_PIO2_2	4.837512969970703125e-4f
+#define SGP4_FLOAT_PIO2_3	7.54978995489188216e-8f
+
+/**
+ * Sine and cosine of each lane in single precision. Argument reduction is
+ * accurate for |x| < 1e3 radians, and the kernel polynomials are the Cephes
+ * sinf() and cosf() ones, giving results within 2 ulps.
+ **/
+static inline __attribute__((always_inline)) void sgp4_fvec_sincos(const sgp4_fvec_t *x, sgp4_fvec_t *s, sgp4_fvec_t *c)
+{
+	sgp4_fvec_t q = SGP4_FVEC_ROUND(*x*(float)(2.0/M_PI));
+	sgp4_fvec_t r = ((*x - q*SGP4_FLOAT_PIO2_1) - q*SGP4_FLOAT_PIO2_2) - q*SGP4_FLOAT_PIO2_3;
+	sgp4_fivec_t quadrant = __builtin_convertvector(q, sgp4_fivec_t);
+
+	sgp4_fvec_t z = r*r;
+	sgp4_fvec_t sin_r = r + r*z*(-1.6666654611e-1f + z*(8.3321608736e-3f + z*-1.9515295891e-4f));
+	sgp4_fvec_t cos_r = 1.0f - 0.5f*z + z*z*(4.166664568298827e-2f + z*(-1.388731625493765e-3f + z*2.443315711809948e-5f));
+
+	//odd quadrants swap sine and cosine, quadrants 2 and 3 negate sine, quadrants 1 and 2 negate cosine
+	sgp4_fivec_t swap = (quadrant & 1) != 0;
+	sgp4_fuvec_t sin_sign = ((sgp4_fuvec_t)quadrant & 2) << 30;
+	sgp4_fuvec_t cos_sign = ((sgp4_fuvec_t)(quadrant + 1) & 2) << 30;
+	*s = (sgp4_fvec_t)((sgp4_fuvec_t)SGP4_FVEC_SELECT(swap, cos_r, sin_r) ^ sin_sign);
+	*c = (sgp4_fvec_t)((sgp4_fuvec_t)SGP4_FVEC_SELECT(swap, sin_r, cos_r) ^ cos_sign);
+}
+
+/**
+ * Mean elements and periodic coefficients of SGP4_FLOAT_LANES orbits in vectors, input to sgp4_fvec_periodics().
+ **/
+struct sgp4_fvec_mean {
+	sgp4_fvec_t a, e, omega, xlmn, xnode, xinc;
+	sgp4_fvec_t xlcof, aycof, x1mth2, x3thm1, x7thm1, cosio, sinio;
+};
+
+/**
+ * Long period periodics, Kepler's equation and short period periodics in single precision,
+ * the part shared by SGP4 and SDP4. Follows sgp4_predict_lanes().
+ **/
+static inline __attribute__((always_inline)) void sgp4_fvec_periodics(const struct sgp4_fvec_mean *m, float pos[3][SGP4_FLOAT_LANES], float vel[3][SGP4_FLOAT_LANES])
+{
+	sgp4_fvec_t a = m->a;
+	sgp4_fvec_t e = m->e;
+	sgp4_fvec_t beta2 = 1.0f - e*e;
+	sgp4_fvec_t sqrt_a;
+	sgp4_fvec_sqrt(&a, &sqrt_a);
+	sgp4_fvec_t xn = (float)XKE/(a*sqrt_a);
+
+	/* Long period periodics */
+	sgp4_fvec_t sin_omega, cos_omega;
+	sgp4_fvec_sincos(&m->omega, &sin_omega, &cos_omega);
+	sgp4_fvec_t axn = e*cos_omega;
+	sgp4_fvec_t temp = 1.0f/(a*beta2);
+	sgp4_fvec_t xll = temp*m->xlcof*axn;
+	sgp4_fvec_t aynl = temp*m->aycof;
+	sgp4_fvec_t ayn = e*sin_omega + aynl;
+
+	/* Solve Kepler's Equation with a fixed number of iterations. */
+	/* The mean longitude relative to the node is already reduced. */
+	sgp4_fvec_t capu = m->xlmn + xll;
+	sgp4_fvec_t epw = capu;
+	sgp4_fvec_t sinepw, cosepw, temp3, temp4, temp5, temp6;
+	for (int i=0; i < SGP4_KEPLER_ITERATIONS; i++) {
+		sgp4_fvec_t temp2 = epw;
+		sgp4_fvec_sincos(&temp2, &sinepw, &cosepw);
+		temp3 = axn*sinepw;
+		temp4 = ayn*cosepw;
+		temp5 = axn*cosepw;
+		temp6 = ayn*sinepw;
+		epw = (capu - temp4 + temp3 - temp2)/(1.0f - temp5 - temp6) + temp2;
+	}
+
+	/* Short period preliminary quantities */
+	sgp4_fvec_t ecose = temp5 + temp6;
+	sgp4_fvec_t esine = temp3 - temp4;
+	sgp4_fvec_t elsq = axn*axn + ayn*ayn;
+	temp = 1.0f - elsq;
+	sgp4_fvec_t pl = a*temp;
+	sgp4_fvec_t r = a*(1.0f - ecose);
+	sgp4_fvec_t temp1 = 1.0f/r;
+	sgp4_fvec_t rdot = (float)XKE*sqrt_a*esine*temp1;
+	sgp4_fvec_t sqrt_pl, betal;
+	sgp4_fvec_sqrt(&pl, &sqrt_pl);
+	sgp4_fvec_sqrt(&temp, &betal);
+	sgp4_fvec_t rfdot = (float)XKE*sqrt_pl*temp1;
+	sgp4_fvec_t temp2 = a*temp1;
+	temp3 = 1.0f/(1.0f + betal);
+	sgp4_fvec_t cosu = temp2*(cosepw - axn + ayn*esine*temp3);
+	sgp4_fvec_t sinu = temp2*(sinepw - ayn - axn*esine*temp3);
+	sgp4_fvec_t sin2u = 2.0f*sinu*cosu;
+	sgp4_fvec_t cos2u = 2.0f*cosu*cosu - 1.0f;
+	temp = 1.0f/pl;
+	temp1 = (float)CK2*temp;
+	temp2 = temp1*temp;
+
+	/* Update for short periodics */
+	sgp4_fvec_t rk = r*(1.0f - 1.5f*temp2*betal*m->x3thm1) + 0.5f*temp1*m->x1mth2*cos2u;
+	sgp4_fvec_t delu = 0.25f*temp2*m->x7thm1*sin2u;
+	sgp4_fvec_t xnodek = m->xnode + 1.5f*temp2*m->cosio*sin2u;
+	sgp4_fvec_t xinck = m->xinc + 1.5f*temp2*m->cosio*m->sinio*cos2u;
+	sgp4_fvec_t rdotk = rdot - xn*temp1*m->x1mth2*sin2u;
+	sgp4_fvec_t rfdotk = rfdot + xn*temp1*(m->x1mth2*cos2u + 1.5f*m->x3thm1);
+
+	/* Orientation vectors */
+	sgp4_fvec_t unorm;
+	temp = sinu*sinu + cosu*cosu;
+	sgp4_fvec_sqrt(&temp, &unorm);
+	unorm = 1.0f/unorm;
+	sgp4_fvec_t sindelu, cosdelu;
+	sgp4_fvec_sincos(&delu, &sindelu, &cosdelu);
+	sgp4_fvec_t sinuk = unorm*(sinu*cosdelu - cosu*sindelu);
+	sgp4_fvec_t cosuk = unorm*(cosu*cosdelu + sinu*sindelu);
+	sgp4_fvec_t sinik, cosik, sinnok, cosnok;
+	sgp4_fvec_sincos(&xinck, &sinik, &cosik);
+	sgp4_fvec_sincos(&xnodek, &sinnok, &cosnok);
+	sgp4_fvec_t xmx = -sinnok*cosik;
+	sgp4_fvec_t xmy = cosnok*cosik;
+	sgp4_fvec_t ux = xmx*sinuk + cosnok*cosuk;
+	sgp4_fvec_t uy = xmy*sinuk + sinnok*cosuk;
+	sgp4_fvec_t uz = sinik*sinuk;
+	sgp4_fvec_t vx = xmx*cosuk - cosnok*sinuk;
+	sgp4_fvec_t vy = xmy*cosuk - sinnok*sinuk;
+	sgp4_fvec_t vz = sinik*cosuk;
+
+	/* Position and velocity */
+	SGP4_FVEC_STORE(pos[0], rk*ux);
+	SGP4_FVEC_STORE(pos[1], rk*uy);
+	SGP4_FVEC_STORE(pos[2], rk*uz);
+	SGP4_FVEC_STORE(vel[0], rdotk*ux + rfdotk*vx);
+	SGP4_FVEC_STORE(vel[1], rdotk*uy + rfdotk*vy);
+	SGP4_FVEC_STORE(vel[2], rdotk*uz + rfdotk*vz);
+}
+
+void sgp4_float_lanes_set(struct sgp4_float_lanes *lanes, int lane, const struct predict_sgp4 *m)
+{
+	//as in sgp4_lanes_set()
+	bool full = !m->simpleFlag;
+
+	lanes->xmo[lane] = m->xmo;
+	lanes->xmdot[lane] = m->xmdot;
+	lanes->omegao[lane] = m->omegao;
+	lanes->omgdot[lane] = m->omgdot;
+	lanes->xnodeo[lane] = m->xnodeo;
+	lanes->xnodot[lane] = m->xnodot;
+	lanes->xnodcf[lane] = m->xnodcf;
+	lanes->xnodp[lane] = m->xnodp;
+	lanes->t2cof[lane] = m->t2cof;
+	lanes->t3cof[lane] = full ? m->t3cof : 0.0;
+	lanes->t4cof[lane] = full ? m->t4cof : 0.0;
+	lanes->t5cof[lane] = full ? m->t5cof : 0.0;
+
+	lanes->aodp[lane] = m->aodp;
+	lanes->aycof[lane] = m->aycof;
+	lanes->c1[lane] = m->c1;
+	lanes->c4[lane] = m->c4;
+	lanes->c5[lane] = full ? m->c5 : 0.0;
+	lanes->cosio[lane] = m->cosio;
+	lanes->d2[lane] = full ? m->d2 : 0.0;
+	lanes->d3[lane] = full ? m->d3 : 0.0;
+	lanes->d4[lane] = full ? m->d4 : 0.0;
+	lanes->delmo[lane] = m->delmo;
+	lanes->omgcof[lane] = full ? m->omgcof : 0.0;
+	lanes->eta[lane] = m->eta;
+	lanes->sinio[lane] = m->sinio;
+	lanes->sinmo[lane] = m->sinmo;
+	lanes->x1mth2[lane] = m->x1mth2;
+	lanes->x3thm1[lane] = m->x3thm1;
+	lanes->x7thm1[lane] = m->x7thm1;
+	lanes->xmcof[lane] = full ? m->xmcof : 0.0;
+	lanes->xlcof[lane] = m->xlcof;
+	lanes->bstar[lane] = m->bstar;
+	lanes->xincl[lane] = m->xincl;
+	lanes->eo[lane] = m->eo;
+}
+
+#define FLOAT_LANE(field) SGP4_FVEC_LOAD(m->field)
+#define DOUBLE_LANE(field) SGP4_FDVEC_LOAD(m->field)
+
+SGP4_LANES_TARGETS
+void sgp4_float_predict_lanes(const struct sgp4_float_lanes *m, const double tsince_lanes[SGP4_FLOAT_LANES], float pos[3][SGP4_FLOAT_LANES], float vel[3][SGP4_FLOAT_LANES])
+{
+	/* Secular angles in double precision, reduced before they lose their fraction */
+	sgp4_fdvec_t tsince_double = SGP4_FDVEC_LOAD(tsince_lanes);
+	sgp4_fdvec_t tsq_double = tsince_double*tsince_double;
+	sgp4_fdvec_t xmdf_double = DOUBLE_LANE(xmo) + DOUBLE_LANE(xmdot)*tsince_double;
+	sgp4_fdvec_t omgadf_double = DOUBLE_LANE(omegao) + DOUBLE_LANE(omgdot)*tsince_double;
+	sgp4_fdvec_t xnode_double = DOUBLE_LANE(xnodeo) + DOUBLE_LANE(xnodot)*tsince_double + DOUBLE_LANE(xnodcf)*tsq_double;
+	sgp4_fdvec_t templ = DOUBLE_LANE(t2cof)*tsq_double + tsq_double*tsince_double*(DOUBLE_LANE(t3cof) + tsince_double*(DOUBLE_LANE(t4cof) + tsince_double*DOUBLE_LANE(t5cof)));
+	sgp4_fdvec_t xlmn_double = xmdf_double + omgadf_double + DOUBLE_LANE(xnodp)*templ;
+
+	sgp4_fvec_t xmdf, omgadf;
+	struct sgp4_fvec_mean mean;
+	sgp4_fdvec_reduce(&xmdf_double, &xmdf);
+	sgp4_fdvec_reduce(&omgadf_double, &omgadf);
+	sgp4_fdvec_reduce(&xnode_double, &mean.xnode);
+	sgp4_fdvec_reduce(&xlmn_double, &mean.xlmn);
+
+	/* Drag corrections in single precision */
+	sgp4_fvec_t tsince = __builtin_convertvector(tsince_double, sgp4_fvec_t);
+	sgp4_fvec_t tsq = tsince*tsince;
+	sgp4_fvec_t tcube = tsq*tsince;
+	sgp4_fvec_t tfour = tsince*tcube;
+
+	sgp4_fvec_t sin_xmdf, cos_xmdf;
+	sgp4_fvec_sincos(&xmdf, &sin_xmdf, &cos_xmdf);
+	sgp4_fvec_t delomg = FLOAT_LANE(omgcof)*tsince;
+	sgp4_fvec_t delm_base = 1.0f + FLOAT_LANE(eta)*cos_xmdf;
+	sgp4_fvec_t delm = FLOAT_LANE(xmcof)*(delm_base*delm_base*delm_base - FLOAT_LANE(delmo));
+	sgp4_fvec_t temp = delomg + delm;
+	sgp4_fvec_t xmp = xmdf + temp;
+	sgp4_fvec_t tempa = 1.0f - FLOAT_LANE(c1)*tsince - FLOAT_LANE(d2)*tsq - FLOAT_LANE(d3)*tcube - FLOAT_LANE(d4)*tfour;
+
+	sgp4_fvec_t sin_xmp, cos_xmp;
+	sgp4_fvec_sincos(&xmp, &sin_xmp, &cos_xmp);
+	sgp4_fvec_t tempe = FLOAT_LANE(bstar)*FLOAT_LANE(c4)*tsince + FLOAT_LANE(bstar)*FLOAT_LANE(c5)*(sin_xmp - FLOAT_LANE(sinmo));
+
+	mean.a = FLOAT_LANE(aodp)*tempa*tempa;
+	mean.e = FLOAT_LANE(eo) - tempe;
+	mean.omega = omgadf - temp;
+	mean.xinc = FLOAT_LANE(xincl);
+	mean.xlcof = FLOAT_LANE(xlcof);
+	mean.aycof = FLOAT_LANE(aycof);
+	mean.x1mth2 = FLOAT_LANE(x1mth2);
+	mean.x3thm1 = FLOAT_LANE(x3thm1);
+	mean.x7thm1 = FLOAT_LANE(x7thm1);
+	mean.cosio = FLOAT_LANE(cosio);
+	mean.sinio = FLOAT_LANE(sinio);
+	sgp4_fvec_periodics(&mean, pos, vel);
+}
+
+void sgp4_float_mean_lanes_set(struct sgp4_float_mean_lanes *lanes, int lane, const struct predict_sdp4 *m, const struct sdp4_mean_elements *mean)
+{
+	lanes->a[lane] = mean->a;
+	lanes->e[lane] = mean->em;
+	lanes->omega[lane] = remainder(mean->omgadf, TWO_PI);
+	lanes->xnode[lane] = remainder(mean->xnode, TWO_PI);
+	lanes->xinc[lane] = mean->xinc;
+	lanes->xlmn[lane] = remainder(mean->xl - mean->xnode, TWO_PI);
+
+	lanes->xlcof[lane] = m->xlcof;
+	lanes->aycof[lane] = m->aycof;
+	lanes->x1mth2[lane] = m->x1mth2;
+	lanes->x3thm1[lane] = m->x3thm1;
+	lanes->x7thm1[lane] = m->x7thm1;
+	lanes->cosio[lane] = m->deep_arg.cosio;
+	lanes->sinio[lane] = m->deep_arg.sinio;
+}
+
+SGP4_LANES_TARGETS
+void sgp4_float_periodics_lanes(const struct sgp4_float_mean_lanes *m, float pos[3][SGP4_FLOAT_LANES], float vel[3][SGP4_FLOAT_LANES])
+{
+	struct sgp4_fvec_mean mean;
+	mean.a = FLOAT_LANE(a);
+	mean.e = FLOAT_LANE(e);
+	mean.omega = FLOAT_LANE(omega);
+	mean.xlmn = FLOAT_LANE(xlmn);
+	mean.xnode = FLOAT_LANE(xnode);
+	mean.xinc = FLOAT_LANE(xinc);
+	mean.xlcof = FLOAT_LANE(xlcof);
+	mean.aycof = FLOAT_LANE(aycof);
+	mean.x1mth2 = FLOAT_LANE(x1mth2);
+	mean.x3thm1 = FLOAT_LANE(x3thm1);
+	mean.x7thm1 = FLOAT_LANE(x7thm1);
+	mean.cosio = FLOAT_LANE(cosio);
+	mean.sinio = FLOAT_LANE(sinio);
+	sgp4_fvec_periodics(&mean, pos, vel);
+}
@@ -23,4 +23,117 @@ void sgp4_init(const predict_orbital_elements_t *orbital_elements, struct predic
  **/
 void sgp4_predict(const struct predict_sgp4 *m, double tsince, struct model_output *output);
 
+///Number of satellites propagated together by sgp4_predict_lanes()
+#define SGP4_LANES 8
+
+///Fixed number of Newton iterations on Kepler's equation in sgp4_predict_lanes(). Converges to 1e-12 for eccentricities up to 0.5.
+#define SGP4_KEPLER_ITERATIONS 6
+
+/**
+ * Largest difference in position (km) between sgp4_predict_lanes() and sgp4_predict() within +-10 days of epoch,
+ * for eccentricities up to 0.5. sgp4_predict() stops solving Kepler's equation at a step of E6A, which accounts
+ * for nearly all of the difference (measured 1.0e-2 km); against a fully converged solution the lanes agree to 1e-8 km.
+ **/
+#define SGP4_LANES_POSITION_TOLERANCE_KM 2.0e-2
+
+///Largest difference in velocity (km/s) between sgp4_predict_lanes() and sgp4_predict(), as above (measured 1.1e-5 km/s)
+#define SGP4_LANES_VELOCITY_TOLERANCE_KM_S 2.0e-5
+
+/**
+ * SGP4 model parameters of SGP4_LANES satellites, stored one array per parameter.
+ **/
+struct sgp4_lanes {
+	double aodp[SGP4_LANES], aycof[SGP4_LANES], c1[SGP4_LANES], c4[SGP4_LANES], c5[SGP4_LANES], cosio[SGP4_LANES], d2[SGP4_LANES], d3[SGP4_LANES], d4[SGP4_LANES], delmo[SGP4_LANES], omgcof[SGP4_LANES], eta[SGP4_LANES], omgdot[SGP4_LANES], sinio[SGP4_LANES], xnodp[SGP4_LANES], sinmo[SGP4_LANES], t2cof[SGP4_LANES], t3cof[SGP4_LANES], t4cof[SGP4_LANES], t5cof[SGP4_LANES], x1mth2[SGP4_LANES], x3thm1[SGP4_LANES], x7thm1[SGP4_LANES], xmcof[SGP4_LANES], xmdot[SGP4_LANES], xnodcf[SGP4_LANES], xnodot[SGP4_LANES], xlcof[SGP4_LANES];
+	double bstar[SGP4_LANES], xincl[SGP4_LANES], xnodeo[SGP4_LANES], eo[SGP4_LANES], omegao[SGP4_LANES], xmo[SGP4_LANES];
+};
+
+/**
+ * Copy SGP4 model parameters of one satellite into a lane.
+ *
+ * \param lanes Lanes to modify
+ * \param lane Lane index, 0 to SGP4_LANES-1
+ * \param m SGP4 model parameters, initialized by sgp4_init()
+ **/
+void sgp4_lanes_set(struct sgp4_lanes *lanes, int lane, const struct predict_sgp4 *m);
+
+/**
+ * Predict ECI position and velocity of SGP4_LANES near-earth orbits at once. Gives the same result as
+ * sgp4_predict() on each lane, within SGP4_LANES_POSITION_TOLERANCE_KM and SGP4_LANES_VELOCITY_TOLERANCE_KM_S
+ * after scaling with Convert_Sat_State(), but uses vector instructions. The instruction set is selected at runtime.
+ *
+ * \param m SGP4 model parameters of each lane, filled by sgp4_lanes_set()
+ * \param tsince Time since epoch of TLE in minutes, per lane
+ * \param pos Output position, normalized as in struct model_output, indexed as pos[component][lane]
+ * \param vel Output velocity, normalized as in struct model_output, indexed as vel[component][lane]
+ * \copyright GPLv2+
+ **/
+void sgp4_predict_lanes(const struct sgp4_lanes *m, const double tsince[SGP4_LANES], double pos[3][SGP4_LANES], double vel[3][SGP4_LANES]);
+
+///Number of satellites propagated together in single precision by sgp4_float_predict_lanes() and sgp4_float_periodics_lanes()
+#define SGP4_FLOAT_LANES 16
+
+/**
+ * SGP4 model parameters of SGP4_FLOAT_LANES satellites for single precision propagation, derived from
+ * struct predict_sgp4 and stored one array per parameter. The parameters of the secular angles stay in
+ * double precision, since the angles grow without bound and must be reduced to [-pi, pi] before rounding.
+ **/
+struct sgp4_float_lanes {
+	double xmo[SGP4_FLOAT_LANES], xmdot[SGP4_FLOAT_LANES], omegao[SGP4_FLOAT_LANES], omgdot[SGP4_FLOAT_LANES], xnodeo[SGP4_FLOAT_LANES], xnodot[SGP4_FLOAT_LANES], xnodcf[SGP4_FLOAT_LANES], xnodp[SGP4_FLOAT_LANES], t2cof[SGP4_FLOAT_LANES], t3cof[SGP4_FLOAT_LANES], t4cof[SGP4_FLOAT_LANES], t5cof[SGP4_FLOAT_LANES];
+	float aodp[SGP4_FLOAT_LANES], aycof[SGP4_FLOAT_LANES], c1[SGP4_FLOAT_LANES], c4[SGP4_FLOAT_LANES], c5[SGP4_FLOAT_LANES], cosio[SGP4_FLOAT_LANES], d2[SGP4_FLOAT_LANES], d3[SGP4_FLOAT_LANES], d4[SGP4_FLOAT_LANES], delmo[SGP4_FLOAT_LANES], omgcof[SGP4_FLOAT_LANES], eta[SGP4_FLOAT_LANES], sinio[SGP4_FLOAT_LANES], sinmo[SGP4_FLOAT_LANES], x1mth2[SGP4_FLOAT_LANES], x3thm1[SGP4_FLOAT_LANES], x7thm1[SGP4_FLOAT_LANES], xmcof[SGP4_FLOAT_LANES], xlcof[SGP4_FLOAT_LANES], bstar[SGP4_FLOAT_LANES], xincl[SGP4_FLOAT_LANES], eo[SGP4_FLOAT_LANES];
+};
+
+/**
+ * Copy SGP4 model parameters of one satellite into a single precision lane.
+ *
+ * \param lanes Lanes to modify
+ * \param lane Lane index, 0 to SGP4_FLOAT_LANES-1
+ * \param m SGP4 model parameters, initialized by sgp4_init()
+ **/
+void sgp4_float_lanes_set(struct sgp4_float_lanes *lanes, int lane, const struct predict_sgp4 *m);
+
+/**
+ * Predict ECI position and velocity of SGP4_FLOAT_LANES near-earth orbits at once in single precision, for
+ * uses that need kilometre accuracy at most. The secular angles are calculated in double precision, the drag
+ * corrections, Kepler's equation and the periodic terms in single precision.
+ *
+ * \param m SGP4 model parameters of each lane, filled by sgp4_float_lanes_set()
+ * \param tsince Time since epoch of TLE in minutes, per lane
+ * \param pos Output position, normalized as in struct model_output, indexed as pos[component][lane]
+ * \param vel Output velocity, normalized as in struct model_output, indexed as vel[component][lane]
+ * \copyright GPLv2+
+ **/
+void sgp4_float_predict_lanes(const struct sgp4_float_lanes *m, const double tsince[SGP4_FLOAT_LANES], float pos[3][SGP4_FLOAT_LANES], float vel[3][SGP4_FLOAT_LANES]);
+
+/**
+ * Mean elements of SGP4_FLOAT_LANES deep-space orbits at the time of prediction, and the coefficients of their
+ * periodic terms, in single precision. The angles are reduced to [-pi, pi].
+ **/
+struct sgp4_float_mean_lanes {
+	float a[SGP4_FLOAT_LANES], e[SGP4_FLOAT_LANES], omega[SGP4_FLOAT_LANES], xnode[SGP4_FLOAT_LANES], xinc[SGP4_FLOAT_LANES];
+	///Mean longitude minus node
+	float xlmn[SGP4_FLOAT_LANES];
+	float xlcof[SGP4_FLOAT_LANES], aycof[SGP4_FLOAT_LANES], x1mth2[SGP4_FLOAT_LANES], x3thm1[SGP4_FLOAT_LANES], x7thm1[SGP4_FLOAT_LANES], cosio[SGP4_FLOAT_LANES], sinio[SGP4_FLOAT_LANES];
+};
+
+/**
+ * Copy the mean elements of a deep-space orbit, calculated in double precision by sdp4_mean_elements(), into a single precision lane.
+ *
+ * \param lanes Lanes to modify
+ * \param lane Lane index, 0 to SGP4_FLOAT_LANES-1
+ * \param m SDP4 model parameters the mean elements were calculated with
+ * \param mean Mean elements
+ **/
+void sgp4_float_mean_lanes_set(struct sgp4_float_mean_lanes *lanes, int lane, const struct predict_sdp4 *m, const struct sdp4_mean_elements *mean);
+
+/**
+ * Calculate the periodic terms of SGP4_FLOAT_LANES deep-space orbits in single precision, the last part of
+ * sdp4_predict() and the same as in sgp4_float_predict_lanes().
+ *
+ * \param m Mean elements of each lane, filled by sgp4_float_mean_lanes_set()
+ * \param pos Output position, normalized as in struct model_output, indexed as pos[component][lane]
+ * \param vel Output velocity, normalized as in struct model_output, indexed as vel[component][lane]
+ * \copyright GPLv2+
+ **/
+void sgp4_float_periodics_lanes(const struct sgp4_float_mean_lanes *m, float pos[3][SGP4_FLOAT_LANES], float vel[3][SGP4_FLOAT_LANES]);
+
 #endif
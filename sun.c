@@ -59,12 +59,8 @@ void sun_predict(predict_julian_date_t jul_time, double position[3])
 	position[2] = R*sin(Lsa)*sin(eps);
 }
 
-void predict_observe_sun(const predict_observer_t *observer, predict_julian_date_t jul_time, struct predict_observation *obs)
+void sun_observe(const predict_observer_t *observer, predict_julian_date_t jul_time, double gmst, const double solar_vector[3], struct predict_observation *obs)
 {
-	// Find sun position
-	double solar_vector[3];
-	sun_predict(jul_time, solar_vector);
-
 	/* Zero vector for initializations */
 	double zero_vector[3] = {0,0,0};
 
@@ -77,7 +73,7 @@ void predict_observe_sun(const predict_observer_t *observer, predict_julian_date
 	geodetic.alt = observer->altitude / 1000.0;
 	geodetic.theta = 0.0;
 
-	Calculate_Obs(jul_time, solar_vector, zero_vector, &geodetic, &solar_set);
+	Calculate_Obs_gmst(gmst, solar_vector, zero_vector, &geodetic, &solar_set);
 
 	double sun_azi = solar_set.x;
 	double sun_ele = solar_set.y;
@@ -92,6 +88,20 @@ void predict_observe_sun(const predict_observer_t *observer, predict_julian_date
 	obs->range_rate = sun_range_rate;
 }
 
+void predict_observe_sun(const predict_observer_t *observer, predict_julian_date_t jul_time, struct predict_observation *obs)
+{
+	// Find sun position
+	double solar_vector[3];
+	sun_predict(jul_time, solar_vector);
+
+	sun_observe(observer, jul_time, ThetaG_JD(jul_time), solar_vector, obs);
+}
+
+void predict_observe_sun_context(const predict_observer_t *observer, const predict_time_context_t *context, struct predict_observation *obs)
+{
+	sun_observe(observer, context->time, context->gmst, context->sun_position, obs);
+}
+
 /**
  * Calculate RA and dec for the sun.
  *
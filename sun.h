@@ -1,6 +1,19 @@
 #ifndef _SUN_H_
 #define _SUN_H_
 
+#include "predict.h"
+
 void sun_predict(double time, double position[3]);
 
+/**
+ * Observe the sun at a known position and sidereal time.
+ *
+ * \param observer Observer
+ * \param jul_time Julian day in UTC
+ * \param gmst Greenwich mean sidereal time, from ThetaG_JD()
+ * \param solar_vector ECI position of the sun, from sun_predict()
+ * \param obs Returned observation
+ **/
+void sun_observe(const predict_observer_t *observer, predict_julian_date_t jul_time, double gmst, const double solar_vector[3], struct predict_observation *obs);
+
 #endif
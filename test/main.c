@@ -4,9 +4,12 @@
 #include <stdlib.h>
 #include <time.h>
 #include <string.h>
+#include <ctype.h>
 
 #include "../predict.h"
 #include "../unsorted.h"
+#include "../sgp4.h"
+#include "../moon.h"
 
 #define TXT_NORM "\x1B[0m"
 #define TXT_RED  "\x1B[31m"
@@ -29,78 +32,1438 @@ const char* sample_tles[2*2] = {
   "2 11801U 46.7916 230.4354 7318036  47.4722  10.4117  2.28537848     2"
 };
 
+/* Deep-space orbits with geopotential resonance */
+const char* resonant_tles[2*2] = {
+  /* Geosynchronous */
+  "1 40000U 98067A   17001.00000000  .00000100  00000-0  00000-0 0  9994",
+  "2 40000   0.0500  80.0000 0002000 120.0000 200.0000  1.00270000360139",
+  /* Molniya, 12 hour resonance */
+  "1 40001U 98067A   17001.00000000  .00000100  00000-0  10000-4 0  9990",
+  "2 40001  63.4000 100.0000 7200000 270.0000  10.0000  2.00600000360131"
+};
+
 typedef struct {
   double position[3];
   double velocity[3];
 } sample_row_t;
 
-typedef struct {
-  sample_row_t tsince[5]; // 0, 360, 720, 1080, 1440
-} sample_set_t;
+typedef struct {
+  sample_row_t tsince[5]; // 0, 360, 720, 1080, 1440
+} sample_set_t;
+
+static sample_set_t sample_results[] = {
+  /* SGP4 Results */
+  {
+    .tsince = {
+      {
+        // 0
+        .position = { 2328.97048951,  -5995.22076416,   1719.97067261 },
+        .velocity = { 2.91207230,     -0.98341546,      -7.09081703 }
+      },
+      {
+        // 360
+        .position = { 2456.10705566,  -6071.93853760,   1222.89727783 },
+        .velocity = { 2.67938992,     -0.44829041,      -7.22879231 }
+      },
+      {
+        // 720
+        .position = { 2567.56195068,  -6112.50384522,    713.96397400 },
+        .velocity = { 2.44024599,      0.09810869,      -7.31995916 }
+      },
+      {
+        // 1080
+        .position = { 2663.09078980,  -6115.48229980,    196.39640427 },
+        .velocity = { 2.19611958,      0.65241995,      -7.36282432 }
+      },
+      {
+        // 1440
+        .position = { 2742.55133057,  -6079.67144775,   -326.38095856 },
+        .velocity = { 1.94850229,      1.21106251,      -7.35619372 }
+      }
+    }
+  },
+
+  /* SDP4 Results */
+  {
+    .tsince = {
+      {
+        // 0
+        .position = { 7473.37066650,    428.95261765,   5828.74786377 },
+        .velocity = { 5.10715413,      6.44468284,      -0.18613096 }
+      },
+      {
+        // 360
+        .position = { -3305.22537232,  32410.86328125, -24697.1767581 },
+        .velocity = { -1.30113538,     -1.15131518,      -0.28333528 }
+      },
+      {
+        // 720
+        .position = { 14271.28759766,  24110.46411133,  -4725.76837158 },
+        .velocity = { -0.32050445,      2.67984074,      -2.08405289 }
+      },
+      {
+        // 1080
+        .position = { -9990.05883789,  22717.35522461, -23616.89062501 },
+        .velocity = { -1.01667246,     -2.29026759,       0.72892364 }
+      },
+      {
+        // 1440
+        .position = { 9787.86975097,  33753.34667969, -15030.81176758 },
+        .velocity = { -1.09425066,      0.92358845,      -1.52230928 }
+      }
+    }
+  }        
+};
+
+
+/* Check that predict_orbit_batch() matches predict_orbit() for a catalog mixing SGP4 and SDP4 objects. */
+/* SGP4 objects go through the vectorised kernel, which has its own tolerance. */
+#define BATCH_SIZE (2*SGP4_LANES + 3)
+static void test_batch(void)
+{
+  predict_orbital_elements_t elements[BATCH_SIZE];
+  struct predict_sgp4 sgp;
+  struct predict_sdp4 sdp;
+  struct predict_position orbit_position;
+  double px[BATCH_SIZE], py[BATCH_SIZE], pz[BATCH_SIZE], vx[BATCH_SIZE], vy[BATCH_SIZE], vz[BATCH_SIZE];
+  struct predict_position_arrays arrays = {px, py, pz, vx, vy, vz};
+
+  printf("Batch propagation..                     ");
+  for(int i = 0; i < BATCH_SIZE; i++)
+  {
+    bool parsed = (i % 5 == 3) ? predict_parse_tle(&elements[i], sample_tles[2], sample_tles[3], NULL, &sdp)
+                               : predict_parse_tle(&elements[i], sample_tles[0], sample_tles[1], &sgp, NULL);
+    if(!parsed)
+    {
+      printf(TXT_RED"Error!"TXT_NORM"\n");
+      exit(1);
+    }
+  }
+
+  double epoch = Julian_Date_of_Epoch((1000.0*elements[0].epoch_year) + elements[0].epoch_day);
+  for(double time = epoch - 2.0; time < epoch + 2.0; time += 0.0731)
+  {
+    if(predict_orbit_batch(elements, BATCH_SIZE, time, &arrays) != 0)
+    {
+      printf(TXT_RED"Error!"TXT_NORM"\n");
+      exit(1);
+    }
+
+    for(int i = 0; i < BATCH_SIZE; i++)
+    {
+      bool sgp4 = (elements[i].ephemeris == EPHEMERIS_SGP4);
+      double position_tolerance = sgp4 ? SGP4_LANES_POSITION_TOLERANCE_KM : 1e-6;
+      double velocity_tolerance = sgp4 ? SGP4_LANES_VELOCITY_TOLERANCE_KM_S : 1e-9;
+
+      predict_orbit(&elements[i], &orbit_position, time);
+      if(fabs(orbit_position.position[0] - px[i]) > position_tolerance || fabs(orbit_position.position[1] - py[i]) > position_tolerance
+        || fabs(orbit_position.position[2] - pz[i]) > position_tolerance || fabs(orbit_position.velocity[0] - vx[i]) > velocity_tolerance
+        || fabs(orbit_position.velocity[1] - vy[i]) > velocity_tolerance || fabs(orbit_position.velocity[2] - vz[i]) > velocity_tolerance)
+      {
+        printf(TXT_RED"Mismatch!"TXT_NORM"\n");
+        exit(1);
+      }
+    }
+  }
+  printf(TXT_GRN"OK"TXT_NORM"\n");
+}
+
+
+/* Mix of near-earth and deep-space satellites, filling more than two groups of lanes */
+#define FLOAT_SIZE (2*SGP4_FLOAT_LANES + 5)
+
+/* Check that single precision propagation stays within its error envelope of the double precision batch */
+static void test_float(void)
+{
+  const char *tles[] = {sample_tles[0], sample_tles[1], sample_tles[2], sample_tles[3],
+    resonant_tles[0], resonant_tles[1], resonant_tles[2], resonant_tles[3]};
+  predict_catalog_t catalog;
+  predict_orbit_float_t orbits;
+  double px[FLOAT_SIZE], py[FLOAT_SIZE], pz[FLOAT_SIZE], vx[FLOAT_SIZE], vy[FLOAT_SIZE], vz[FLOAT_SIZE];
+  float fpx[FLOAT_SIZE], fpy[FLOAT_SIZE], fpz[FLOAT_SIZE], fvx[FLOAT_SIZE], fvy[FLOAT_SIZE], fvz[FLOAT_SIZE];
+  struct predict_position_arrays arrays = {px, py, pz, vx, vy, vz};
+  struct predict_position_arrays_float float_arrays = {fpx, fpy, fpz, fvx, fvy, fvz};
+
+  printf("Single precision propagation..          ");
+  predict_create_catalog(&catalog, FLOAT_SIZE);
+  for(int i = 0; i < FLOAT_SIZE; i++)
+  {
+    int tle = (i % 3 == 0) ? (i/3) % 4 : 0;
+    predict_catalog_add_tle(&catalog, tles[2*tle], tles[2*tle+1]);
+  }
+  if((catalog.num_elements != FLOAT_SIZE) || !predict_create_orbit_float(&orbits, catalog.elements, catalog.num_elements))
+  {
+    printf(TXT_RED"Error!"TXT_NORM"\n");
+    exit(1);
+  }
+
+  double epoch = Julian_Date_of_Epoch((1000.0*catalog.elements[0].epoch_year) + catalog.elements[0].epoch_day);
+  for(double time = epoch - 2.0; time < epoch + 2.0; time += 0.0731)
+  {
+    if((predict_orbit_batch(catalog.elements, FLOAT_SIZE, time, &arrays) != 0) || (predict_orbit_float(&orbits, time, &float_arrays) != 0))
+    {
+      printf(TXT_RED"Error!"TXT_NORM"\n");
+      exit(1);
+    }
+
+    for(int i = 0; i < FLOAT_SIZE; i++)
+    {
+      if(fabs(px[i] - fpx[i]) > 0.1 || fabs(py[i] - fpy[i]) > 0.1 || fabs(pz[i] - fpz[i]) > 0.1
+        || fabs(vx[i] - fvx[i]) > 1e-4 || fabs(vy[i] - fvy[i]) > 1e-4 || fabs(vz[i] - fvz[i]) > 1e-4)
+      {
+        printf(TXT_RED"Mismatch!"TXT_NORM"\n");
+        exit(1);
+      }
+    }
+  }
+  predict_destroy_orbit_float(&orbits);
+  predict_destroy_catalog(&catalog);
+  printf(TXT_GRN"OK"TXT_NORM"\n");
+}
+
+
+/* Check that the Chebyshev approximation follows the orbit model within its tolerance, for near-earth and resonant orbits.
+   The Kepler solver leaves jumps of some metres in the high eccentricity Molniya orbit, which sets its tolerance. */
+static void test_chebyshev(void)
+{
+  const char *tles[] = {sample_tles[0], sample_tles[1], resonant_tles[2], resonant_tles[3]};
+  double position_tolerance[] = {1e-3, 0.05};
+  double velocity_tolerance[] = {1e-3, 0.01};
+
+  printf("Chebyshev approximation..               ");
+  for(int i = 0; i < 2; i++)
+  {
+    predict_orbital_elements_t elements;
+    predict_chebyshev_t chebyshev;
+    struct predict_sgp4 sgp;
+    struct predict_sdp4 sdp;
+    if(!predict_parse_tle(&elements, tles[2*i], tles[2*i+1], &sgp, &sdp))
+    {
+      printf(TXT_RED"Error!"TXT_NORM"\n");
+      exit(1);
+    }
+
+    double epoch = Julian_Date_of_Epoch((1000.0*elements.epoch_year) + elements.epoch_day);
+    double start = epoch - 0.3, end = epoch + 1.5;
+    if(!predict_create_chebyshev(&chebyshev, &elements, start, end, position_tolerance[i]) || (chebyshev.max_position_error > position_tolerance[i])
+      || (chebyshev.start_time > start) || (chebyshev.end_time < end))
+    {
+      printf(TXT_RED"Error!"TXT_NORM"\n");
+      exit(1);
+    }
+
+    for(double time = start; time <= end; time += 0.00731)
+    {
+      struct predict_position orbit_position;
+      double position[3], velocity[3];
+      predict_orbit(&elements, &orbit_position, time);
+      if(predict_chebyshev_position(&chebyshev, time, position, velocity) != 0)
+      {
+        printf(TXT_RED"Error!"TXT_NORM"\n");
+        exit(1);
+      }
+      for(int j = 0; j < 3; j++)
+      {
+        if(fabs(position[j] - orbit_position.position[j]) > 2*position_tolerance[i] || fabs(velocity[j] - orbit_position.velocity[j]) > velocity_tolerance[i])
+        {
+          printf(TXT_RED"Mismatch!"TXT_NORM"\n");
+          exit(1);
+        }
+      }
+    }
+
+    double position[3];
+    if((predict_chebyshev_position(&chebyshev, chebyshev.start_time - 0.001, position, NULL) != -1)
+      || (predict_chebyshev_position(&chebyshev, chebyshev.end_time + 0.001, position, NULL) != -1)
+      || (predict_chebyshev_position(&chebyshev, chebyshev.end_time, position, NULL) != 0))
+    {
+      printf(TXT_RED"Mismatch!"TXT_NORM"\n");
+      exit(1);
+    }
+    predict_destroy_chebyshev(&chebyshev);
+  }
+  printf(TXT_GRN"OK"TXT_NORM"\n");
+}
+
+
+/* Check that the decay state switches at the decay time estimated when parsing */
+static void test_decay(void)
+{
+  predict_orbital_elements_t elements;
+  struct predict_sgp4 sgp;
+  struct predict_position orbit_position;
+
+  printf("Decay estimate..                        ");
+  if(!predict_parse_tle(&elements, sample_tles[0], sample_tles[1], &sgp, NULL))
+  {
+    printf(TXT_RED"Error!"TXT_NORM"\n");
+    exit(1);
+  }
+
+  /* (16.666666 - mean motion)/(10*|first derivative|) days after epoch */
+  double epoch = Julian_Date_of_Epoch((1000.0*elements.epoch_year) + elements.epoch_day);
+  double expected = epoch + (16.666666 - 16.05824518)/(10.0*0.00073094);
+  predict_orbit(&elements, &orbit_position, expected - 0.01);
+  bool before = orbit_position.decayed;
+  predict_orbit(&elements, &orbit_position, expected + 0.01);
+  bool after = orbit_position.decayed;
+
+  if((fabs(elements.decay_time - expected) > 1e-6) || before || !after)
+  {
+    printf(TXT_RED"Mismatch!"TXT_NORM"\n");
+    exit(1);
+  }
+  printf(TXT_GRN"OK"TXT_NORM"\n");
+}
+
+
+/* Check that predict_orbit_parallel() matches predict_orbit() for a mixed catalog on several threads */
+#define PARALLEL_CATALOG_SIZE 37
+#define PARALLEL_NUM_TIMES 5
+static void test_parallel(void)
+{
+  predict_orbital_elements_t elements[PARALLEL_CATALOG_SIZE];
+  struct predict_sgp4 sgp[PARALLEL_CATALOG_SIZE];
+  struct predict_sdp4 sdp[PARALLEL_CATALOG_SIZE];
+  static struct predict_position output[PARALLEL_CATALOG_SIZE*PARALLEL_NUM_TIMES];
+  const char *tles[] = {sample_tles[0], sample_tles[1], sample_tles[2], sample_tles[3],
+    resonant_tles[0], resonant_tles[1], resonant_tles[2], resonant_tles[3]};
+
+  printf("Parallel propagation..                  ");
+  for(int i = 0; i < PARALLEL_CATALOG_SIZE; i++)
+  {
+    int tle = i % 4;
+    if(!predict_parse_tle(&elements[i], tles[2*tle], tles[2*tle+1], &sgp[i], &sdp[i]))
+    {
+      printf(TXT_RED"Error!"TXT_NORM"\n");
+      exit(1);
+    }
+  }
+
+  double times[PARALLEL_NUM_TIMES];
+  for(int j = 0; j < PARALLEL_NUM_TIMES; j++)
+  {
+    times[j] = Julian_Date_of_Epoch((1000.0*elements[0].epoch_year) + elements[0].epoch_day) + 3.3*j;
+  }
+
+  if(predict_orbit_parallel(elements, PARALLEL_CATALOG_SIZE, times, PARALLEL_NUM_TIMES, PREDICT_ORBIT_ALL, 4, output) != 0)
+  {
+    printf(TXT_RED"Error!"TXT_NORM"\n");
+    exit(1);
+  }
+
+  for(int i = 0; i < PARALLEL_CATALOG_SIZE; i++)
+  {
+    for(int j = 0; j < PARALLEL_NUM_TIMES; j++)
+    {
+      struct predict_position orbit_position;
+      const struct predict_position *parallel_position = &output[i*PARALLEL_NUM_TIMES + j];
+      predict_orbit(&elements[i], &orbit_position, times[j]);
+      if(memcmp(parallel_position->position, orbit_position.position, sizeof(orbit_position.position)) != 0
+        || memcmp(parallel_position->velocity, orbit_position.velocity, sizeof(orbit_position.velocity)) != 0
+        || (parallel_position->latitude != orbit_position.latitude) || (parallel_position->revolutions != orbit_position.revolutions))
+      {
+        printf(TXT_RED"Mismatch!"TXT_NORM"\n");
+        exit(1);
+      }
+    }
+  }
+  printf(TXT_GRN"OK"TXT_NORM"\n");
+}
+
+
+/* Check that satellites keep their orbits through growth of a catalog */
+static void test_catalog(void)
+{
+  const char *tles[] = {sample_tles[0], sample_tles[1], sample_tles[2], sample_tles[3],
+    resonant_tles[0], resonant_tles[1], resonant_tles[2], resonant_tles[3]};
+  predict_catalog_t catalog;
+
+  printf("Satellite catalog..                     ");
+  if(!predict_create_catalog(&catalog, 1))
+  {
+    printf(TXT_RED"Error!"TXT_NORM"\n");
+    exit(1);
+  }
+
+  for(int i = 0; i < 41; i++)
+  {
+    int tle = (i*7) % 4;
+    if(!predict_catalog_add_tle(&catalog, tles[2*tle], tles[2*tle+1]))
+    {
+      printf(TXT_RED"Error!"TXT_NORM"\n");
+      exit(1);
+    }
+  }
+  char corrupt_line[70];
+  strcpy(corrupt_line, tles[1]);
+  corrupt_line[10] = (corrupt_line[10] == '9') ? '0' : corrupt_line[10] + 1;
+  if(predict_catalog_add_tle(&catalog, tles[0], corrupt_line) || (catalog.num_elements != 41))
+  {
+    printf(TXT_RED"Error!"TXT_NORM"\n");
+    exit(1);
+  }
+
+  for(size_t i = 0; i < catalog.num_elements; i++)
+  {
+    int tle = (i*7) % 4;
+    predict_orbital_elements_t elements;
+    struct predict_sgp4 sgp;
+    struct predict_sdp4 sdp;
+    predict_parse_tle(&elements, tles[2*tle], tles[2*tle+1], &sgp, &sdp);
+
+    struct predict_position catalog_position, orbit_position;
+    double time = Julian_Date_of_Epoch((1000.0*elements.epoch_year) + elements.epoch_day) + 1.7;
+    predict_orbit(&catalog.elements[i], &catalog_position, time);
+    predict_orbit(&elements, &orbit_position, time);
+    if(memcmp(catalog_position.position, orbit_position.position, sizeof(orbit_position.position)) != 0
+      || (catalog.elements[i].ephemeris_data < (void*)catalog.arena)
+      || (catalog.elements[i].ephemeris_data >= (void*)(catalog.arena + catalog.arena_used)))
+    {
+      printf(TXT_RED"Mismatch!"TXT_NORM"\n");
+      exit(1);
+    }
+  }
+
+  predict_destroy_catalog(&catalog);
+  printf(TXT_GRN"OK"TXT_NORM"\n");
+}
+
+
+/* Check loading of a 3LE file with CRLF line endings and broken records */
+static void test_catalog_file(void)
+{
+  char filename[] = "/tmp/libpredict_test_XXXXXX";
+  char corrupt_line[70];
+  strcpy(corrupt_line, sample_tles[1]);
+  corrupt_line[10] = (corrupt_line[10] == '9') ? '0' : corrupt_line[10] + 1;
+
+  printf("Catalog file loading..                  ");
+  int fd = mkstemp(filename);
+  FILE *file = (fd < 0) ? NULL : fdopen(fd, "w");
+  if(file == NULL)
+  {
+    printf(TXT_RED"Error!"TXT_NORM"\n");
+    exit(1);
+  }
+  fprintf(file, "SGP4 TEST\r\n%s\r\n%s\r\n", sample_tles[0], sample_tles[1]);   /* lines 1-3 */
+  fprintf(file, "BROKEN CHECKSUM\r\n%s\r\n%s\r\n", sample_tles[0], corrupt_line); /* lines 4-6 */
+  fprintf(file, "MISSING LINE 2\r\n%s\r\n", sample_tles[0]);                        /* lines 7-8 */
+  fprintf(file, "\r\nSDP4 TEST\r\n%s\r\n%s\r\n", sample_tles[2], sample_tles[3]); /* lines 9-12 */
+  fprintf(file, "%s\n%s", resonant_tles[0], resonant_tles[1]);                         /* lines 13-14 */
+  fclose(file);
+
+  predict_catalog_t catalog;
+  struct predict_tle_error errors[4];
+  size_t num_errors;
+  predict_create_catalog(&catalog, 1);
+  long num_added = predict_catalog_load_file(&catalog, filename, 2, errors, 4, &num_errors);
+  unlink(filename);
+
+  if((num_added != 3) || (catalog.num_elements != 3) || (num_errors != 2)
+    || (errors[0].line != 5) || (errors[0].status != PREDICT_TLE_CHECKSUM_ERROR) || (errors[0].tle_line != 2) || (errors[0].column != 69)
+    || (errors[1].line != 8) || (errors[1].status != PREDICT_TLE_FORMAT_ERROR)
+    || (catalog.elements[0].satellite_number != 88888) || (catalog.elements[1].satellite_number != 11801)
+    || (catalog.elements[2].satellite_number != 40000) || (catalog.elements[2].ephemeris != EPHEMERIS_SDP4))
+  {
+    printf(TXT_RED"Mismatch!"TXT_NORM"\n");
+    exit(1);
+  }
+
+  struct predict_position position;
+  if((predict_orbit(&catalog.elements[1], &position, 2444238.5) != 0) || (predict_catalog_load_file(&catalog, filename, 2, NULL, 0, NULL) != -1))
+  {
+    printf(TXT_RED"Error!"TXT_NORM"\n");
+    exit(1);
+  }
+  predict_destroy_catalog(&catalog);
+  printf(TXT_GRN"OK"TXT_NORM"\n");
+}
+
+
+/* Check that a catalog saved as binary catalog file maps back to the same satellites, */
+/* and that stale and incompatible files are detected */
+static void test_catalog_binary(void)
+{
+  char filename[] = "/tmp/libpredict_test_XXXXXX";
+  const char *tles[] = {sample_tles[0], sample_tles[1], sample_tles[2], sample_tles[3],
+    resonant_tles[0], resonant_tles[1], resonant_tles[2], resonant_tles[3]};
+  predict_catalog_t catalog, mapped;
+
+  printf("Binary catalog file..                   ");
+  int fd = mkstemp(filename);
+  if(fd < 0)
+  {
+    printf(TXT_RED"Error!"TXT_NORM"\n");
+    exit(1);
+  }
+  close(fd);
+  predict_create_catalog(&catalog, 1);
+  for(int i = 0; i < 4; i++)
+  {
+    predict_catalog_add_tle(&catalog, tles[2*i], tles[2*i+1]);
+  }
+  uint64_t stamp = predict_catalog_source_stamp(filename);
+  if((stamp == 0) || !predict_catalog_save(&catalog, filename, stamp)
+    || (predict_catalog_map(&mapped, filename, stamp) != PREDICT_CATALOG_OK) || (mapped.num_elements != 4))
+  {
+    printf(TXT_RED"Error!"TXT_NORM"\n");
+    exit(1);
+  }
+
+  /* same predictions from the mapped models, also after the catalog has grown out of the mapping */
+  for(int pass = 0; pass < 2; pass++)
+  {
+    for(size_t i = 0; i < catalog.num_elements; i++)
+    {
+      struct predict_position catalog_position, mapped_position;
+      double time = Julian_Date_of_Epoch((1000.0*catalog.elements[i].epoch_year) + catalog.elements[i].epoch_day) + 2.3;
+      predict_orbit(&catalog.elements[i], &catalog_position, time);
+      predict_orbit(&mapped.elements[i], &mapped_position, time);
+      if(memcmp(catalog_position.position, mapped_position.position, sizeof(mapped_position.position)) != 0
+        || memcmp(catalog_position.velocity, mapped_position.velocity, sizeof(mapped_position.velocity)) != 0)
+      {
+        printf(TXT_RED"Mismatch!"TXT_NORM"\n");
+        exit(1);
+      }
+    }
+    if(pass == 0 && (!predict_catalog_add_tle(&mapped, tles[0], tles[1]) || (mapped.mapping != NULL) || (mapped.num_elements != 5)))
+    {
+      printf(TXT_RED"Error!"TXT_NORM"\n");
+      exit(1);
+    }
+  }
+  predict_destroy_catalog(&mapped);
+
+  /* other source, and other version */
+  enum predict_catalog_status stale = predict_catalog_map(&mapped, filename, stamp + 1);
+  predict_destroy_catalog(&mapped);
+  FILE *file = fopen(filename, "r+b");
+  fseek(file, 12, SEEK_SET);
+  fputc(0xff, file);
+  fclose(file);
+  enum predict_catalog_status incompatible = predict_catalog_map(&mapped, filename, stamp);
+  predict_destroy_catalog(&mapped);
+  unlink(filename);
+  enum predict_catalog_status missing = predict_catalog_map(&mapped, filename, stamp);
+  predict_destroy_catalog(&mapped);
+  predict_destroy_catalog(&catalog);
+
+  if((stale != PREDICT_CATALOG_STALE) || (incompatible != PREDICT_CATALOG_INCOMPATIBLE) || (missing != PREDICT_CATALOG_IO_ERROR))
+  {
+    printf(TXT_RED"Mismatch!"TXT_NORM"\n");
+    exit(1);
+  }
+  printf(TXT_GRN"OK"TXT_NORM"\n");
+}
+
+
+/* Replace the checksum of a TLE line by the correct one */
+static void fix_tle_checksum(char *line)
+{
+  int sum = 0;
+  for(int i = 0; i < 68; i++)
+  {
+    if(isdigit((unsigned char)line[i])) sum += line[i] - '0';
+    else if(line[i] == '-') sum++;
+  }
+  line[68] = '0' + sum % 10;
+}
+
+
+/* Check that predict_tle_decode() decodes the sample TLEs as predict_parse_tle() does, */
+/* and reports where broken TLEs fail */
+static void test_tle_decode(void)
+{
+  predict_orbital_elements_t parsed, decoded;
+  struct predict_sgp4 sgp;
+  struct predict_sdp4 sdp;
+  struct predict_tle_error error;
+  char line_1[70], line_2[70];
+
+  printf("TLE decoding..                          ");
+  for(int i = 0; i < 2; i++)
+  {
+    memset(&parsed, 0, sizeof(parsed));
+    memset(&decoded, 0, sizeof(decoded));
+    if(!predict_parse_tle(&parsed, sample_tles[2*i], sample_tles[2*i+1], &sgp, &sdp)
+      || (predict_tle_decode(&decoded, sample_tles[2*i], sample_tles[2*i+1], &error) != PREDICT_TLE_OK) || (error.status != PREDICT_TLE_OK)
+      || (decoded.satellite_number != parsed.satellite_number) || (decoded.epoch_day != parsed.epoch_day)
+      || (decoded.bstar_drag_term != parsed.bstar_drag_term) || (decoded.eccentricity != parsed.eccentricity)
+      || (decoded.mean_motion != parsed.mean_motion) || (decoded.revolutions_at_epoch != parsed.revolutions_at_epoch)
+      || !(decoded.decay_time > 0.0) || (decoded.decay_time != parsed.decay_time))
+    {
+      printf(TXT_RED"Mismatch!"TXT_NORM"\n");
+      exit(1);
+    }
+  }
+
+  /* wrong checksum */
+  strcpy(line_1, sample_tles[0]);
+  strcpy(line_2, sample_tles[1]);
+  line_2[68] = (line_2[68] == '9') ? '0' : line_2[68] + 1;
+  bool checksum_ok = (predict_tle_decode(&decoded, line_1, line_2, &error) == PREDICT_TLE_CHECKSUM_ERROR)
+    && (error.tle_line == 2) && (error.column == 69) && (error.field == PREDICT_TLE_FIELD_CHECKSUM);
+
+  /* letter in the mean motion */
+  strcpy(line_2, sample_tles[1]);
+  line_2[56] = 'x';
+  bool field_ok = (predict_tle_decode(&decoded, line_1, line_2, &error) == PREDICT_TLE_FIELD_ERROR)
+    && (error.tle_line == 2) && (error.column == 57) && (error.field == PREDICT_TLE_FIELD_MEAN_MOTION);
+
+  /* truncated in the B* drag term */
+  line_1[55] = '\0';
+  bool format_ok = (predict_tle_decode(&decoded, line_1, sample_tles[1], &error) == PREDICT_TLE_FORMAT_ERROR)
+    && (error.tle_line == 1) && (error.column == 56) && (error.field == PREDICT_TLE_FIELD_BSTAR_DRAG_TERM);
+
+  /* Alpha-5 satellite number */
+  strcpy(line_1, sample_tles[0]);
+  strcpy(line_2, sample_tles[1]);
+  memcpy(line_1 + 2, "Z0001", 5);
+  memcpy(line_2 + 2, "Z0001", 5);
+  fix_tle_checksum(line_1);
+  fix_tle_checksum(line_2);
+  bool alpha_ok = (predict_tle_decode(&decoded, line_1, line_2, &error) == PREDICT_TLE_OK) && (decoded.satellite_number == 330001);
+
+  if(!checksum_ok || !field_ok || !format_ok || !alpha_ok)
+  {
+    printf(TXT_RED"Mismatch!"TXT_NORM"\n");
+    exit(1);
+  }
+  printf(TXT_GRN"OK"TXT_NORM"\n");
+}
+
+
+/* Check that predict_screen_conjunctions() finds the closest approaches of a mixed catalog that sampling every second finds */
+#define CONJUNCTION_CATALOG_SIZE 40
+#define CONJUNCTION_SECONDS (3*3600)
+#define CONJUNCTION_THRESHOLD_KM 100.0
+static void test_conjunctions(void)
+{
+  predict_catalog_t catalog;
+  predict_conjunctions_t conjunctions;
+  char line_1[70], line_2[70];
+
+  printf("Conjunction screening..                 ");
+  predict_create_catalog(&catalog, CONJUNCTION_CATALOG_SIZE);
+  for(int i = 0; i < CONJUNCTION_CATALOG_SIZE; i++)
+  {
+    /* near-circular low orbits in many planes, and some eccentric ones crossing them */
+    snprintf(line_1, sizeof(line_1), "1 %05dU          80275.98708465  .00000000  00000-0  00000-0 0    80", i + 1);
+    if(i % 5 == 4)
+      snprintf(line_2, sizeof(line_2), "2 %05d %8.4f %8.4f 2500000 %8.4f %8.4f %11.8f    10", i + 1, 30.0 + (i*13) % 60, (i*97) % 360 + 0.5, (i*53) % 360 + 0.5, (i*211) % 360 + 0.5, 10.0);
+    else
+      snprintf(line_2, sizeof(line_2), "2 %05d %8.4f %8.4f 0001000   0.0000 %8.4f %11.8f    10", i + 1, 50.0 + (i*37) % 48, (i*97) % 360 + 0.5, (i*211) % 360 + 0.5, 14.2 + (i % 7)*0.003);
+    fix_tle_checksum(line_1);
+    fix_tle_checksum(line_2);
+    predict_catalog_add_tle(&catalog, line_1, line_2);
+  }
+
+  double epoch = Julian_Date_of_Epoch((1000.0*catalog.elements[0].epoch_year) + catalog.elements[0].epoch_day);
+  double (*positions)[3] = malloc(CONJUNCTION_CATALOG_SIZE*(CONJUNCTION_SECONDS + 1)*sizeof(*positions));
+  if((catalog.num_elements != CONJUNCTION_CATALOG_SIZE) || (positions == NULL)
+    || !predict_screen_conjunctions(&conjunctions, catalog.elements, CONJUNCTION_CATALOG_SIZE, epoch, epoch + CONJUNCTION_SECONDS/86400.0, CONJUNCTION_THRESHOLD_KM, 0))
+  {
+    printf(TXT_RED"Error!"TXT_NORM"\n");
+    exit(1);
+  }
+  for(int i = 0; i < CONJUNCTION_CATALOG_SIZE; i++)
+  {
+    for(int k = 0; k <= CONJUNCTION_SECONDS; k++)
+    {
+      struct predict_position orbit_position;
+      predict_orbit(&catalog.elements[i], &orbit_position, epoch + k/86400.0);
+      memcpy(positions[i*(CONJUNCTION_SECONDS + 1) + k], orbit_position.position, sizeof(orbit_position.position));
+    }
+  }
+
+  /* every minimum of the sampled distance well within the threshold is found, to within a second and no further apart */
+  int num_minima = 0;
+  for(int i = 0; i < CONJUNCTION_CATALOG_SIZE; i++)
+  {
+    for(int j = i + 1; j < CONJUNCTION_CATALOG_SIZE; j++)
+    {
+      double distance[3] = {INFINITY, INFINITY, INFINITY};
+      for(int k = 0; k <= CONJUNCTION_SECONDS; k++)
+      {
+        const double *pi = positions[i*(CONJUNCTION_SECONDS + 1) + k], *pj = positions[j*(CONJUNCTION_SECONDS + 1) + k];
+        distance[0] = distance[1];
+        distance[1] = distance[2];
+        distance[2] = sqrt((pi[0] - pj[0])*(pi[0] - pj[0]) + (pi[1] - pj[1])*(pi[1] - pj[1]) + (pi[2] - pj[2])*(pi[2] - pj[2]));
+        if((distance[1] >= distance[0]) || (distance[1] > distance[2]) || (distance[1] > 0.9*CONJUNCTION_THRESHOLD_KM))
+          continue;
+
+        num_minima++;
+        bool found = false;
+        for(size_t c = 0; c < conjunctions.num_conjunctions; c++)
+        {
+          const struct predict_conjunction *conjunction = &conjunctions.conjunctions[c];
+          found = found || ((conjunction->primary == (size_t)i) && (conjunction->secondary == (size_t)j)
+            && (fabs(conjunction->time - (epoch + (k - 1)/86400.0)) < 1.5/86400.0) && (conjunction->miss_distance <= distance[1]));
+        }
+        if(!found)
+        {
+          printf(TXT_RED"Mismatch!"TXT_NORM"\n");
+          exit(1);
+        }
+      }
+    }
+  }
+
+  for(size_t c = 0; c < conjunctions.num_conjunctions; c++)
+  {
+    const struct predict_conjunction *conjunction = &conjunctions.conjunctions[c];
+    if((conjunction->miss_distance > CONJUNCTION_THRESHOLD_KM) || (conjunction->primary >= conjunction->secondary)
+      || ((c > 0) && (conjunction->time < conjunctions.conjunctions[c - 1].time)))
+    {
+      printf(TXT_RED"Mismatch!"TXT_NORM"\n");
+      exit(1);
+    }
+  }
+  if((num_minima == 0) || (conjunctions.num_conjunctions < (size_t)num_minima))
+  {
+    printf(TXT_RED"Mismatch!"TXT_NORM"\n");
+    exit(1);
+  }
+  free(positions);
+  predict_destroy_conjunctions(&conjunctions);
+  predict_destroy_catalog(&catalog);
+  printf(TXT_GRN"OK"TXT_NORM"\n");
+}
+
+
+/* Check that predict_passes() finds the passes that predict_next_aos(), predict_next_los() and */
+/* predict_at_max_elevation() find one at a time */
+#define PASSES_DAYS 3
+static void test_passes(void)
+{
+  const char *tle[2] = {"1 25544U 98067A   15129.86961041  .00015753  00000-0  23097-3 0  9998",
+                        "2 25544  51.6459 275.1962 0006103 329.4680 153.4522 15.55705328942633"};
+  predict_orbital_elements_t elements;
+  struct predict_sgp4 sgp;
+  predict_observer_t observer;
+  predict_passes_t passes;
+
+  printf("Pass list..                             ");
+  predict_create_observer(&observer, "Trondheim", 63.42*M_PI/180.0, 10.39*M_PI/180.0, 0);
+  double epoch = 0;
+  if(predict_parse_tle(&elements, tle[0], tle[1], &sgp, NULL))
+    epoch = Julian_Date_of_Epoch((1000.0*elements.epoch_year) + elements.epoch_day);
+  if((epoch == 0) || !predict_passes(&observer, &elements, epoch, epoch + PASSES_DAYS, &passes) || (passes.num_passes == 0))
+  {
+    printf(TXT_RED"Error!"TXT_NORM"\n");
+    exit(1);
+  }
+
+  /* the same passes, with AOS and LOS at the horizon rather than where predict_next_aos() stops short of it */
+  double time = epoch;
+  for(size_t i = 0; i <= passes.num_passes; i++)
+  {
+    struct predict_observation aos = predict_next_aos(&observer, &elements, time);
+    if(i == passes.num_passes)
+    {
+      if(aos.time < epoch + PASSES_DAYS)
+      {
+        printf(TXT_RED"Mismatch!"TXT_NORM"\n");
+        exit(1);
+      }
+      break;
+    }
+    struct predict_observation los = predict_next_los(&observer, &elements, aos.time);
+    struct predict_observation max_elevation = predict_at_max_elevation(&observer, &elements, aos.time);
+    const struct predict_pass *pass = &passes.passes[i];
+    if((fabs(pass->aos.time - aos.time) > 40.0/86400.0) || (fabs(pass->los.time - los.time) > 40.0/86400.0)
+      || (fabs(pass->max_elevation.time - max_elevation.time) > 0.05/86400.0) || (fabs(pass->max_elevation.elevation - max_elevation.elevation) > 1e-6)
+      || (fabs(pass->aos.elevation) > 1e-5) || (fabs(pass->los.elevation) > 1e-5)
+      || !(pass->aos.time < pass->max_elevation.time) || !(pass->max_elevation.time < pass->los.time)
+      || !(pass->aos.time < pass->tca.time) || !(pass->tca.time < pass->los.time) || (pass->tca.range > pass->max_elevation.range))
+    {
+      printf(TXT_RED"Mismatch!"TXT_NORM"\n");
+      exit(1);
+    }
+    time = los.time;
+  }
+  predict_destroy_passes(&passes);
+  printf(TXT_GRN"OK"TXT_NORM"\n");
+}
+
+
+/* Check that predict_passes_observers() finds the passes predict_passes() finds for each observer, */
+/* including one the satellite never rises over */
+#define PASSES_NUM_OBSERVERS 6
+static void test_passes_observers(void)
+{
+  const char *tle[2] = {"1 25544U 98067A   15129.86961041  .00015753  00000-0  23097-3 0  9998",
+                        "2 25544  51.6459 275.1962 0006103 329.4680 153.4522 15.55705328942633"};
+  const double coordinates[PASSES_NUM_OBSERVERS][3] = {{63.42, 10.39, 0}, {-33.9, 18.4, 50}, {0.0, -78.5, 2800}, {35.7, 139.7, 40}, {51.5, -0.1, 10}, {89.0, 0.0, 0}};
+  predict_orbital_elements_t elements;
+  struct predict_sgp4 sgp;
+  predict_observer_t observers[PASSES_NUM_OBSERVERS];
+  predict_passes_t passes[PASSES_NUM_OBSERVERS];
+
+  printf("Pass list of several observers..        ");
+  for(int i = 0; i < PASSES_NUM_OBSERVERS; i++)
+    predict_create_observer(&observers[i], "Observer", coordinates[i][0]*M_PI/180.0, coordinates[i][1]*M_PI/180.0, coordinates[i][2]);
+  double epoch = 0;
+  if(predict_parse_tle(&elements, tle[0], tle[1], &sgp, NULL))
+    epoch = Julian_Date_of_Epoch((1000.0*elements.epoch_year) + elements.epoch_day);
+  if((epoch == 0) || !predict_passes_observers(observers, PASSES_NUM_OBSERVERS, &elements, epoch + 0.3, epoch + 0.3 + PASSES_DAYS, passes))
+  {
+    printf(TXT_RED"Error!"TXT_NORM"\n");
+    exit(1);
+  }
+
+  for(int i = 0; i < PASSES_NUM_OBSERVERS; i++)
+  {
+    predict_passes_t expected;
+    if(!predict_passes(&observers[i], &elements, epoch + 0.3, epoch + 0.3 + PASSES_DAYS, &expected))
+    {
+      printf(TXT_RED"Error!"TXT_NORM"\n");
+      exit(1);
+    }
+    if((passes[i].num_passes != expected.num_passes) || ((i == PASSES_NUM_OBSERVERS - 1) != (expected.num_passes == 0)))
+    {
+      printf(TXT_RED"Mismatch!"TXT_NORM"\n");
+      exit(1);
+    }
+    for(size_t j = 0; j < expected.num_passes; j++)
+    {
+      const struct predict_pass *pass = &passes[i].passes[j], *expected_pass = &expected.passes[j];
+      if((fabs(pass->aos.time - expected_pass->aos.time) > 0.05/86400.0) || (fabs(pass->los.time - expected_pass->los.time) > 0.05/86400.0)
+        || (fabs(pass->tca.time - expected_pass->tca.time) > 0.05/86400.0) || (fabs(pass->max_elevation.elevation - expected_pass->max_elevation.elevation) > 1e-6))
+      {
+        printf(TXT_RED"Mismatch!"TXT_NORM"\n");
+        exit(1);
+      }
+    }
+    predict_destroy_passes(&expected);
+    predict_destroy_passes(&passes[i]);
+  }
+  printf(TXT_GRN"OK"TXT_NORM"\n");
+}
+
+
+/* Check that predict_access_matrix() stores the passes predict_passes_observers() finds for each */
+/* satellite of a mixed catalog, on several threads */
+#define ACCESS_CATALOG_SIZE 11
+#define ACCESS_NUM_OBSERVERS 4
+static void test_access_matrix(void)
+{
+  predict_orbital_elements_t elements[ACCESS_CATALOG_SIZE];
+  struct predict_sgp4 sgp[ACCESS_CATALOG_SIZE];
+  struct predict_sdp4 sdp[ACCESS_CATALOG_SIZE];
+  const char *tles[] = {sample_tles[0], sample_tles[1], sample_tles[2], sample_tles[3],
+    resonant_tles[0], resonant_tles[1], resonant_tles[2], resonant_tles[3]};
+  const double coordinates[ACCESS_NUM_OBSERVERS][3] = {{63.42, 10.39, 0}, {-33.9, 18.4, 50}, {0.0, -78.5, 2800}, {89.0, 0.0, 0}};
+  predict_observer_t observers[ACCESS_NUM_OBSERVERS];
+  predict_access_t access;
+
+  printf("Access matrix..                         ");
+  for(int i = 0; i < ACCESS_NUM_OBSERVERS; i++)
+    predict_create_observer(&observers[i], "Observer", coordinates[i][0]*M_PI/180.0, coordinates[i][1]*M_PI/180.0, coordinates[i][2]);
+  for(int i = 0; i < ACCESS_CATALOG_SIZE; i++)
+  {
+    int tle = i % 4;
+    if(!predict_parse_tle(&elements[i], tles[2*tle], tles[2*tle+1], &sgp[i], &sdp[i]))
+    {
+      printf(TXT_RED"Error!"TXT_NORM"\n");
+      exit(1);
+    }
+  }
+  double start = Julian_Date_of_Epoch((1000.0*elements[0].epoch_year) + elements[0].epoch_day) + 1.0;
+  if(!predict_access_matrix(&access, elements, ACCESS_CATALOG_SIZE, observers, ACCESS_NUM_OBSERVERS, start, start + 2.0, 3)
+    || (access.num_satellites != ACCESS_CATALOG_SIZE) || (access.satellite_offsets[0] != 0) || (access.num_windows == 0))
+  {
+    printf(TXT_RED"Error!"TXT_NORM"\n");
+    exit(1);
+  }
+
+  for(int i = 0; i < ACCESS_CATALOG_SIZE; i++)
+  {
+    predict_passes_t passes[ACCESS_NUM_OBSERVERS];
+    if(!predict_passes_observers(observers, ACCESS_NUM_OBSERVERS, &elements[i], start, start + 2.0, passes))
+    {
+      printf(TXT_RED"Error!"TXT_NORM"\n");
+      exit(1);
+    }
+    size_t window = access.satellite_offsets[i];
+    for(int j = 0; j < ACCESS_NUM_OBSERVERS; j++)
+    {
+      for(size_t k = 0; k < passes[j].num_passes; k++, window++)
+      {
+        const struct predict_pass *pass = &passes[j].passes[k];
+        if((window >= access.satellite_offsets[i + 1]) || (access.observer[window] != (uint32_t)j) || (access.aos[window] != pass->aos.time)
+          || (access.los[window] != pass->los.time) || (access.max_elevation_time[window] != pass->max_elevation.time)
+          || (access.max_elevation[window] != pass->max_elevation.elevation))
+        {
+          printf(TXT_RED"Mismatch!"TXT_NORM"\n");
+          exit(1);
+        }
+      }
+      predict_destroy_passes(&passes[j]);
+    }
+    if(window != access.satellite_offsets[i + 1])
+    {
+      printf(TXT_RED"Mismatch!"TXT_NORM"\n");
+      exit(1);
+    }
+  }
+  predict_destroy_access(&access);
+  printf(TXT_GRN"OK"TXT_NORM"\n");
+}
 
-static sample_set_t sample_results[] = {
-  /* SGP4 Results */
+
+/* Check the right ascension of the moon against the direction from its ecliptic coordinates, over two months */
+/* that include times where the quadrant differs from that of the ecliptic longitude */
+static void test_moon_right_ascension(void)
+{
+  size_t num_quadrant_differs = 0;
+
+  printf("Moon right ascension..                  ");
+  for(double time = 2457000.5; time < 2457060.5; time += 1.0/24.0)
   {
-    .tsince = {
+    double longitude, latitude, obliquity, ra, dec, sidereal_time, range;
+    moon_ecliptic(time, &longitude, &latitude, &obliquity);
+    moon_equatorial(time, &ra, &dec, &sidereal_time, &range);
+    double x = cos(latitude)*cos(longitude);
+    double y = cos(latitude)*sin(longitude)*cos(obliquity) - sin(latitude)*sin(obliquity);
+    double expected = atan2(y, x);
+    if(expected < 0.0)
+      expected += 2.0*M_PI;
+    if((y < 0.0) != (sin(longitude) < 0.0))
+      num_quadrant_differs++;
+
+    struct predict_observation obs;
+    predict_observer_t observer;
+    predict_create_observer(&observer, "Trondheim", 63.42*M_PI/180.0, 10.39*M_PI/180.0, 0);
+    predict_observe_moon(&observer, time, &obs);
+    double h = sidereal_time + observer.longitude - expected;
+    double elevation = asin(sin(observer.latitude)*sin(dec) + cos(observer.latitude)*cos(dec)*cos(h));
+    if((fabs(remainder(ra - expected, 2.0*M_PI)) > 1e-6) || (fabs(remainder(predict_moon_gha(time) - (sidereal_time - expected), 2.0*M_PI)) > 1e-6)
+      || (fabs(obs.elevation - elevation) > 1e-6))
+    {
+      printf(TXT_RED"Mismatch!"TXT_NORM"\n");
+      exit(1);
+    }
+  }
+  if(num_quadrant_differs == 0)
+  {
+    printf(TXT_RED"Error!"TXT_NORM"\n");
+    exit(1);
+  }
+  printf(TXT_GRN"OK"TXT_NORM"\n");
+}
+
+
+/* Check the right ascension, declination and GHA of the sun, and its observation from Trondheim, against */
+/* values from before the sidereal time was passed through as GMST, so that no caller passes a Julian date instead */
+static void test_sun(void)
+{
+  /* time, right ascension, declination, GHA, azimuth, elevation */
+  const double expected[][6] = {
+    {2444238.5, 4.8777171642333128, -0.40407910268350561, 3.1303659632759553, 0.24058328594936199, -0.85891087966160284},
+    {2457000.5, 4.4624787552603697, -0.39758932783516376, 3.1761489296914971, 0.30283852221366497, -0.8469776212334873},
+    {2457150.3, 0.77573923031283487, 0.29470968107753692, 1.8999988005313857, 5.2933502821424447, 0.050511495252813288},
+    {2460000.25, 5.8931451206390655, -0.16333269085206653, 1.5132242618812257, 4.7493076586104612, -0.20134609088248984},
+    {2462502.75, 4.9183206993746618, -0.40127310017895435, 4.6973963053583905, 1.9009239879228934, -0.28500023995732804},
+  };
+  predict_observer_t observer;
+
+  printf("Sun position..                          ");
+  predict_create_observer(&observer, "Trondheim", 63.42*M_PI/180.0, 10.39*M_PI/180.0, 0);
+  for(size_t i = 0; i < sizeof(expected)/sizeof(expected[0]); i++)
+  {
+    struct predict_observation obs;
+    double time = expected[i][0];
+    predict_observe_sun(&observer, time, &obs);
+    if((fabs(predict_sun_ra(time) - expected[i][1]) > 1e-10) || (fabs(predict_sun_declination(time) - expected[i][2]) > 1e-10)
+      || (fabs(predict_sun_gha(time) - expected[i][3]) > 1e-10) || (fabs(obs.azimuth - expected[i][4]) > 1e-10) || (fabs(obs.elevation - expected[i][5]) > 1e-10))
+    {
+      printf(TXT_RED"Mismatch!"TXT_NORM"\n");
+      exit(1);
+    }
+  }
+  printf(TXT_GRN"OK"TXT_NORM"\n");
+}
+
+
+/* Check that the functions taking a time context give the same results as those calculating */
+/* the sidereal time, sun and moon themselves */
+static void test_time_context(void)
+{
+  const char *tles[] = {sample_tles[0], sample_tles[1], sample_tles[2], sample_tles[3], resonant_tles[0], resonant_tles[1]};
+  predict_observer_t observer;
+
+  printf("Time context..                          ");
+  predict_create_observer(&observer, "Trondheim", 63.42*M_PI/180.0, 10.39*M_PI/180.0, 0);
+  for(int i = 0; i < 3; i++)
+  {
+    predict_orbital_elements_t elements;
+    struct predict_sgp4 sgp;
+    struct predict_sdp4 sdp;
+    if(!predict_parse_tle(&elements, tles[2*i], tles[2*i+1], &sgp, &sdp))
+    {
+      printf(TXT_RED"Error!"TXT_NORM"\n");
+      exit(1);
+    }
+    double epoch = Julian_Date_of_Epoch((1000.0*elements.epoch_year) + elements.epoch_day);
+    for(int j = 0; j < 10; j++)
+    {
+      double time = epoch + 0.37*j;
+      predict_time_context_t context;
+      predict_create_time_context(&context, time, (j % 2) == 0);
+
+      struct predict_position orbit, context_orbit;
+      struct predict_observation obs, context_obs, sun, context_sun, moon, context_moon;
+      predict_orbit(&elements, &orbit, time);
+      predict_orbit_context(&elements, PREDICT_ORBIT_ALL, &context, &context_orbit);
+      predict_observe_orbit(&observer, &orbit, &obs);
+      predict_observe_orbit_context(&observer, &context_orbit, &context, &context_obs);
+      predict_observe_sun(&observer, time, &sun);
+      predict_observe_sun_context(&observer, &context, &context_sun);
+      predict_observe_moon(&observer, time, &moon);
+      predict_observe_moon_context(&observer, &context, &context_moon);
+      if((memcmp(orbit.position, context_orbit.position, sizeof(orbit.position)) != 0) || (orbit.latitude != context_orbit.latitude)
+        || (orbit.longitude != context_orbit.longitude) || (orbit.eclipse_depth != context_orbit.eclipse_depth) || (orbit.eclipsed != context_orbit.eclipsed)
+        || (obs.azimuth != context_obs.azimuth) || (obs.elevation != context_obs.elevation) || (obs.range_rate != context_obs.range_rate) || (obs.visible != context_obs.visible)
+        || (sun.azimuth != context_sun.azimuth) || (sun.elevation != context_sun.elevation)
+        || (moon.azimuth != context_moon.azimuth) || (moon.elevation != context_moon.elevation) || (moon.range_rate != context_moon.range_rate))
       {
-        // 0
-        .position = { 2328.97048951,  -5995.22076416,   1719.97067261 },
-        .velocity = { 2.91207230,     -0.98341546,      -7.09081703 }
-      },
+        printf(TXT_RED"Mismatch!"TXT_NORM"\n");
+        exit(1);
+      }
+    }
+  }
+  printf(TXT_GRN"OK"TXT_NORM"\n");
+}
+
+
+/* Check that observations from a prepared observer agree with predict_observe_orbit() */
+static void test_prepared_observer(void)
+{
+  const char *tles[] = {sample_tles[0], sample_tles[1], sample_tles[2], sample_tles[3], resonant_tles[0], resonant_tles[1]};
+  const double coordinates[3][3] = {{63.42, 10.39, 0}, {-33.9, 18.4, 1500}, {0.1, -178.5, 0}};
+
+  printf("Prepared observer..                     ");
+  for(int k = 0; k < 3; k++)
+  {
+    predict_observer_t observer;
+    predict_prepared_observer_t prepared;
+    predict_create_observer(&observer, "Observer", coordinates[k][0]*M_PI/180.0, coordinates[k][1]*M_PI/180.0, coordinates[k][2]);
+    predict_prepare_observer(&prepared, &observer);
+    for(int i = 0; i < 3; i++)
+    {
+      predict_orbital_elements_t elements;
+      struct predict_sgp4 sgp;
+      struct predict_sdp4 sdp;
+      if(!predict_parse_tle(&elements, tles[2*i], tles[2*i+1], &sgp, &sdp))
       {
-        // 360
-        .position = { 2456.10705566,  -6071.93853760,   1222.89727783 },
-        .velocity = { 2.67938992,     -0.44829041,      -7.22879231 }
-      },
+        printf(TXT_RED"Error!"TXT_NORM"\n");
+        exit(1);
+      }
+      double epoch = Julian_Date_of_Epoch((1000.0*elements.epoch_year) + elements.epoch_day);
+      for(int j = 0; j < 50; j++)
       {
-        // 720
-        .position = { 2567.56195068,  -6112.50384522,    713.96397400 },
-        .velocity = { 2.44024599,      0.09810869,      -7.31995916 }
-      },
+        struct predict_position orbit;
+        struct predict_observation obs, prepared_obs, context_obs;
+        predict_time_context_t context;
+        predict_orbit(&elements, &orbit, epoch + 0.0731*j);
+        predict_create_time_context(&context, orbit.time, false);
+        predict_observe_orbit(&observer, &orbit, &obs);
+        predict_observe_orbit_prepared(&prepared, &orbit, NULL, &prepared_obs);
+        predict_observe_orbit_prepared(&prepared, &orbit, &context, &context_obs);
+        double azimuth_difference = fabs(remainder(obs.azimuth - prepared_obs.azimuth, 2.0*M_PI));
+        if((azimuth_difference > 1e-9) || (fabs(obs.elevation - prepared_obs.elevation) > 1e-9) || (fabs(obs.range - prepared_obs.range) > 1e-6)
+          || (fabs(obs.range_rate - prepared_obs.range_rate) > 1e-8) || (fabs(obs.elevation_rate - prepared_obs.elevation_rate) > 1e-8)
+          || (fabs(obs.azimuth_rate - prepared_obs.azimuth_rate) > 1e-8*fmax(1.0, fabs(obs.azimuth_rate)))
+          || (fabs(obs.range_x - prepared_obs.range_x) > 1e-6) || (fabs(obs.range_y - prepared_obs.range_y) > 1e-6) || (fabs(obs.range_z - prepared_obs.range_z) > 1e-6)
+          || (obs.visible != prepared_obs.visible) || (obs.time != prepared_obs.time)
+          || (prepared_obs.azimuth != context_obs.azimuth) || (prepared_obs.elevation != context_obs.elevation) || (prepared_obs.range != context_obs.range)
+          || (prepared_obs.range_rate != context_obs.range_rate) || (prepared_obs.azimuth_rate != context_obs.azimuth_rate) || (prepared_obs.elevation_rate != context_obs.elevation_rate)
+          || (prepared_obs.range_x != context_obs.range_x) || (prepared_obs.range_y != context_obs.range_y) || (prepared_obs.range_z != context_obs.range_z)
+          || (prepared_obs.visible != context_obs.visible))
+        {
+          printf(TXT_RED"Mismatch!"TXT_NORM"\n");
+          exit(1);
+        }
+      }
+    }
+  }
+  printf(TXT_GRN"OK"TXT_NORM"\n");
+}
+
+
+/* Check that predict_eclipse_events() finds the umbra crossings of one-second sampling of predict_orbit(), */
+/* and penumbra crossings where the eclipse depth is minus the apparent diameter of the sun */
+static void test_eclipse_events(void)
+{
+  const char *tles[] = {"1 25544U 98067A   15129.86961041  .00015753  00000-0  23097-3 0  9998",
+                        "2 25544  51.6459 275.1962 0006103 329.4680 153.4522 15.55705328942633",
+                        sample_tles[0], sample_tles[1], sample_tles[2], sample_tles[3], resonant_tles[2], resonant_tles[3]};
+
+  printf("Eclipse events..                        ");
+  for(int i = 0; i < 4; i++)
+  {
+    predict_orbital_elements_t elements;
+    struct predict_sgp4 sgp;
+    struct predict_sdp4 sdp;
+    predict_eclipse_events_t events;
+    double epoch = 0;
+    if(predict_parse_tle(&elements, tles[2*i], tles[2*i+1], &sgp, &sdp))
+      epoch = Julian_Date_of_Epoch((1000.0*elements.epoch_year) + elements.epoch_day);
+    if((epoch == 0) || !predict_eclipse_events(&elements, epoch, epoch + 1.0, &events) || (events.num_events == 0))
+    {
+      printf(TXT_RED"Error!"TXT_NORM"\n");
+      exit(1);
+    }
+
+    /* umbra crossings by sampling, each between two samples a second apart */
+    struct predict_position orbit;
+    predict_orbit(&elements, &orbit, epoch);
+    int eclipsed = orbit.eclipsed;
+    size_t num_umbra = 0;
+    for(int j = 1; j <= 86400; j++)
+    {
+      predict_orbit(&elements, &orbit, epoch + j/86400.0);
+      if(orbit.eclipsed == eclipsed)
+        continue;
+      eclipsed = orbit.eclipsed;
+      size_t k = 0;
+      for(size_t umbra = 0; k < events.num_events; k++)
       {
-        // 1080
-        .position = { 2663.09078980,  -6115.48229980,    196.39640427 },
-        .velocity = { 2.19611958,      0.65241995,      -7.36282432 }
-      },
+        if((events.events[k].type == PREDICT_UMBRA_ENTRY) || (events.events[k].type == PREDICT_UMBRA_EXIT))
+          if(umbra++ == num_umbra)
+            break;
+      }
+      if((k == events.num_events) || (events.events[k].type != (eclipsed ? PREDICT_UMBRA_ENTRY : PREDICT_UMBRA_EXIT))
+        || (events.events[k].time < epoch + (j - 1.01)/86400.0) || (events.events[k].time > epoch + (j + 0.01)/86400.0))
       {
-        // 1440
-        .position = { 2742.55133057,  -6079.67144775,   -326.38095856 },
-        .velocity = { 1.94850229,      1.21106251,      -7.35619372 }
+        printf(TXT_RED"Mismatch!"TXT_NORM"\n");
+        exit(1);
       }
+      num_umbra++;
     }
-  },
 
-  /* SDP4 Results */
-  {
-    .tsince = {
+    /* events in order, entering the penumbra before the umbra and leaving it after */
+    const enum predict_eclipse_event_type next[] = {PREDICT_UMBRA_ENTRY, PREDICT_UMBRA_EXIT, PREDICT_PENUMBRA_EXIT, PREDICT_PENUMBRA_ENTRY};
+    for(size_t k = 0; k < events.num_events; k++)
+    {
+      const struct predict_eclipse_event *event = &events.events[k];
+      bool ordered = (k == 0) || ((event->time > events.events[k-1].time)
+        && ((event->type == next[events.events[k-1].type]) || ((events.events[k-1].type == PREDICT_PENUMBRA_ENTRY) && (event->type == PREDICT_PENUMBRA_EXIT))));
+      bool umbra = (event->type == PREDICT_UMBRA_ENTRY) || (event->type == PREDICT_UMBRA_EXIT);
+      predict_orbit(&elements, &orbit, event->time);
+      bool at_boundary = umbra || ((orbit.eclipse_depth > -0.0096) && (orbit.eclipse_depth < -0.0090));
+      if(umbra)
+        num_umbra--;
+      if(!ordered || !at_boundary)
       {
-        // 0
-        .position = { 7473.37066650,    428.95261765,   5828.74786377 },
-        .velocity = { 5.10715413,      6.44468284,      -0.18613096 }
-      },
+        printf(TXT_RED"Mismatch!"TXT_NORM"\n");
+        exit(1);
+      }
+    }
+    if(num_umbra != 0)
+    {
+      printf(TXT_RED"Mismatch!"TXT_NORM"\n");
+      exit(1);
+    }
+    predict_destroy_eclipse_events(&events);
+  }
+  printf(TXT_GRN"OK"TXT_NORM"\n");
+}
+
+
+/* Check that time contexts from a sun and moon table agree with predict_create_time_context() */
+static void test_ephemeris(void)
+{
+  const double start = 2457150.3, end = start + 9.5;
+  predict_ephemeris_t ephemeris;
+
+  printf("Sun and moon table..                    ");
+  if(!predict_create_ephemeris(&ephemeris, start, end, 1e-9) || (ephemeris.max_sun_error > 1e-9) || (ephemeris.max_moon_error > 1e-9))
+  {
+    printf(TXT_RED"Error!"TXT_NORM"\n");
+    exit(1);
+  }
+  for(double time = start - 0.5; time <= end + 0.5; time += 0.00731)
+  {
+    predict_time_context_t context, table_context;
+    predict_create_time_context(&context, time, true);
+    predict_create_time_context_ephemeris(&table_context, &ephemeris, time, true);
+    double sun_difference = 0.0, sun_distance = 0.0;
+    for(int i = 0; i < 3; i++)
+    {
+      sun_difference += pow(table_context.sun_position[i] - context.sun_position[i], 2);
+      sun_distance += pow(context.sun_position[i], 2);
+    }
+    bool outside = (time < start) || (time > end);
+    if((outside && ((sun_difference != 0.0) || (table_context.moon_right_ascension != context.moon_right_ascension)
+      || (table_context.moon_declination != context.moon_declination) || (table_context.moon_range != context.moon_range)))
+      || (table_context.time != context.time) || (table_context.gmst != context.gmst) || !table_context.has_moon
+      || (table_context.moon_sidereal_time != context.moon_sidereal_time) || (sqrt(sun_difference/sun_distance) > 2e-9)
+      || (fabs(remainder(table_context.moon_right_ascension - context.moon_right_ascension, 2.0*M_PI))*cos(context.moon_declination) > 2e-9)
+      || (fabs(table_context.moon_declination - context.moon_declination) > 2e-9) || (fabs(table_context.moon_range/context.moon_range - 1.0) > 2e-9))
+    {
+      printf(TXT_RED"Mismatch!"TXT_NORM"\n");
+      exit(1);
+    }
+  }
+  predict_destroy_ephemeris(&ephemeris);
+  printf(TXT_GRN"OK"TXT_NORM"\n");
+}
+
+
+/* Check that a doppler profile over a pass agrees with predict_doppler_shift() within its tolerance, */
+/* and that its range rate derivative agrees with the difference of the range rate */
+#define DOPPLER_NUM_FREQUENCIES 2
+static void test_doppler_profile(void)
+{
+  const char *tle[2] = {"1 25544U 98067A   15129.86961041  .00015753  00000-0  23097-3 0  9998",
+                        "2 25544  51.6459 275.1962 0006103 329.4680 153.4522 15.55705328942633"};
+  const double frequencies[DOPPLER_NUM_FREQUENCIES] = {145.8e6, 437.8e6};
+  const double tolerance = 1.0;
+  predict_orbital_elements_t elements;
+  struct predict_sgp4 sgp;
+  predict_observer_t observer;
+  predict_passes_t passes;
+  predict_doppler_profile_t profile;
+
+  printf("Doppler profile..                       ");
+  predict_create_observer(&observer, "Trondheim", 63.42*M_PI/180.0, 10.39*M_PI/180.0, 0);
+  double epoch = 0;
+  if(predict_parse_tle(&elements, tle[0], tle[1], &sgp, NULL))
+    epoch = Julian_Date_of_Epoch((1000.0*elements.epoch_year) + elements.epoch_day);
+  if((epoch == 0) || !predict_passes(&observer, &elements, epoch, epoch + 1.0, &passes) || (passes.num_passes < 2))
+  {
+    printf(TXT_RED"Error!"TXT_NORM"\n");
+    exit(1);
+  }
+  const struct predict_pass *pass = &passes.passes[1];
+  if(!predict_create_doppler_profile(&profile, &observer, &elements, pass->aos.time, pass->los.time, 0.01, frequencies, DOPPLER_NUM_FREQUENCIES, tolerance)
+    || (profile.max_error > tolerance) || (profile.num_samples != (size_t)floor((pass->los.time - pass->aos.time)*86400.0/0.01) + 1) || (profile.num_knots > 100))
+  {
+    printf(TXT_RED"Error!"TXT_NORM"\n");
+    exit(1);
+  }
+  for(size_t i = 0; i < profile.num_samples; i += 37)
+  {
+    struct predict_position orbit;
+    struct predict_observation obs;
+    predict_orbit(&elements, &orbit, profile.start_time + i*profile.time_step/86400.0);
+    predict_observe_orbit(&observer, &orbit, &obs);
+    bool mismatch = (i + 100 < profile.num_samples)
+      && (fabs(profile.range_rate_derivative[i] - (profile.range_rate[i + 100] - profile.range_rate[i])/1.0) > 1e-4);
+    for(int j = 0; j < DOPPLER_NUM_FREQUENCIES; j++)
+      mismatch = mismatch || (fabs(profile.doppler_shift[i*DOPPLER_NUM_FREQUENCIES + j] - predict_doppler_shift(&obs, frequencies[j])) > 1.5*tolerance);
+    if(mismatch)
+    {
+      printf(TXT_RED"Mismatch!"TXT_NORM"\n");
+      exit(1);
+    }
+  }
+  predict_destroy_doppler_profile(&profile);
+  predict_destroy_passes(&passes);
+  printf(TXT_GRN"OK"TXT_NORM"\n");
+}
+
+
+/* Observe from a tracker, waiting up to a second for the producer thread */
+static bool tracker_wait(predict_tracker_t *tracker, double time, struct predict_observation *obs)
+{
+  const struct timespec sleep = {0, 1000000};
+  for(int i = 0; i < 1000; i++)
+  {
+    if(predict_tracker_observe(tracker, time, obs) == 0)
+      return true;
+    nanosleep(&sleep, NULL);
+  }
+  return false;
+}
+
+/* Check that a tracker interpolates predict_observe_orbit() through a pass, and catches up */
+/* when the consumer skips ahead to a later pass */
+static void test_tracker(void)
+{
+  const char *tle[2] = {"1 25544U 98067A   15129.86961041  .00015753  00000-0  23097-3 0  9998",
+                        "2 25544  51.6459 275.1962 0006103 329.4680 153.4522 15.55705328942633"};
+  predict_orbital_elements_t elements;
+  struct predict_sgp4 sgp;
+  predict_observer_t observer;
+  predict_passes_t passes;
+  predict_tracker_t tracker;
+
+  printf("Antenna tracker..                       ");
+  predict_create_observer(&observer, "Trondheim", 63.42*M_PI/180.0, 10.39*M_PI/180.0, 0);
+  double epoch = 0;
+  if(predict_parse_tle(&elements, tle[0], tle[1], &sgp, NULL))
+    epoch = Julian_Date_of_Epoch((1000.0*elements.epoch_year) + elements.epoch_day);
+  if((epoch == 0) || !predict_passes(&observer, &elements, epoch, epoch + 1.0, &passes) || (passes.num_passes < 4)
+    || !predict_create_tracker(&tracker, &observer, &elements, passes.passes[1].aos.time, 1.0, 10.0))
+  {
+    printf(TXT_RED"Error!"TXT_NORM"\n");
+    exit(1);
+  }
+  for(size_t i = 1; i < passes.num_passes; i += 2)
+  {
+    const struct predict_pass *pass = &passes.passes[i];
+    for(double time = pass->aos.time; time < pass->los.time; time += 0.13/86400.0)
+    {
+      struct predict_position orbit;
+      struct predict_observation obs, tracked;
+      predict_orbit(&elements, &orbit, time);
+      predict_observe_orbit(&observer, &orbit, &obs);
+      if(!tracker_wait(&tracker, time, &tracked))
       {
-        // 360
-        .position = { -3305.22537232,  32410.86328125, -24697.1767581 },
-        .velocity = { -1.30113538,     -1.15131518,      -0.28333528 }
-      },
+        printf(TXT_RED"Error!"TXT_NORM"\n");
+        exit(1);
+      }
+      if((tracked.time != time) || (fabs(remainder(tracked.azimuth - obs.azimuth, 2.0*M_PI)) > 1e-5) || (fabs(tracked.elevation - obs.elevation) > 1e-6)
+        || (fabs(tracked.azimuth_rate - obs.azimuth_rate) > 1e-5) || (fabs(tracked.elevation_rate - obs.elevation_rate) > 1e-6)
+        || (fabs(tracked.range - obs.range) > 1e-3) || (fabs(tracked.range_rate - obs.range_rate) > 1e-4))
       {
-        // 720
-        .position = { 14271.28759766,  24110.46411133,  -4725.76837158 },
-        .velocity = { -0.32050445,      2.67984074,      -2.08405289 }
-      },
+        printf(TXT_RED"Mismatch!"TXT_NORM"\n");
+        exit(1);
+      }
+    }
+  }
+  predict_destroy_tracker(&tracker);
+  predict_destroy_passes(&passes);
+
+  /* a minute long time step should not hold up destroying a tracker whose ring is full */
+  struct predict_observation tracked;
+  struct timespec fill = {0, 50000000}, start, end;
+  if(!predict_create_tracker(&tracker, &observer, &elements, epoch, 60.0, 120.0) || !tracker_wait(&tracker, epoch, &tracked))
+  {
+    printf(TXT_RED"Error!"TXT_NORM"\n");
+    exit(1);
+  }
+  nanosleep(&fill, NULL);
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  predict_destroy_tracker(&tracker);
+  clock_gettime(CLOCK_MONOTONIC, &end);
+  if((end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec)*1e-9 > 1.0)
+  {
+    printf(TXT_RED"Mismatch!"TXT_NORM"\n");
+    exit(1);
+  }
+  printf(TXT_GRN"OK"TXT_NORM"\n");
+}
+
+
+/* Check that predict_orbit_fields() calculates the requested fields as predict_orbit() does, */
+/* and leaves the others alone */
+static void test_fields(void)
+{
+  predict_orbital_elements_t elements;
+  struct predict_sgp4 sgp;
+  struct predict_position full, partial;
+
+  printf("Orbit field selection..                 ");
+  if(!predict_parse_tle(&elements, sample_tles[0], sample_tles[1], &sgp, NULL))
+  {
+    printf(TXT_RED"Error!"TXT_NORM"\n");
+    exit(1);
+  }
+
+  double time = Julian_Date_of_Epoch((1000.0*elements.epoch_year) + elements.epoch_day) + 0.3;
+  predict_orbit(&elements, &full, time);
+
+  memset(&partial, 0, sizeof(partial));
+  predict_orbit_fields(&elements, PREDICT_ORBIT_ECI, &partial, time);
+  bool eci_ok = (memcmp(partial.position, full.position, sizeof(full.position)) == 0)
+    && (memcmp(partial.velocity, full.velocity, sizeof(full.velocity)) == 0)
+    && (partial.latitude == 0.0) && (partial.footprint == 0.0) && (partial.eclipse_depth == 0.0) && (partial.revolutions == 0);
+
+  memset(&partial, 0, sizeof(partial));
+  predict_orbit_fields(&elements, PREDICT_ORBIT_FOOTPRINT | PREDICT_ORBIT_ECLIPSE, &partial, time);
+  bool derived_ok = (partial.latitude == full.latitude) && (partial.altitude == full.altitude)
+    && (partial.footprint == full.footprint) && (partial.eclipsed == full.eclipsed)
+    && (partial.eclipse_depth == full.eclipse_depth) && (partial.revolutions == 0);
+
+  if(!eci_ok || !derived_ok)
+  {
+    printf(TXT_RED"Mismatch!"TXT_NORM"\n");
+    exit(1);
+  }
+  printf(TXT_GRN"OK"TXT_NORM"\n");
+}
+
+
+/* Check that predict_orbit_resonant() matches predict_orbit() for resonant deep-space orbits, */
+/* both moving away from and towards epoch */
+static void test_resonant(void)
+{
+  printf("Resonant propagation..                  ");
+  for(int i = 0; i < 2; i++)
+  {
+    predict_orbital_elements_t elements;
+    struct predict_sdp4 sdp;
+    if(!predict_parse_tle(&elements, resonant_tles[2*i], resonant_tles[2*i+1], NULL, &sdp) || !sdp.resonanceFlag)
+    {
+      printf(TXT_RED"Error!"TXT_NORM"\n");
+      exit(1);
+    }
+
+    struct predict_sdp4_resonance state = {0};
+    double epoch = Julian_Date_of_Epoch((1000.0*elements.epoch_year) + elements.epoch_day);
+    double times[] = {epoch - 3.0, epoch - 2.7, epoch + 0.1, epoch + 12.3, epoch + 12.31, epoch + 30.0, epoch + 20.0, epoch - 10.0, epoch - 20.0};
+    for(size_t j = 0; j < sizeof(times)/sizeof(times[0]); j++)
+    {
+      struct predict_position resonant_position, orbit_position;
+      predict_orbit_resonant(&elements, &state, &resonant_position, times[j]);
+      predict_orbit(&elements, &orbit_position, times[j]);
+      if(memcmp(resonant_position.position, orbit_position.position, sizeof(orbit_position.position)) != 0
+        || memcmp(resonant_position.velocity, orbit_position.velocity, sizeof(orbit_position.velocity)) != 0)
       {
-        // 1080
-        .position = { -9990.05883789,  22717.35522461, -23616.89062501 },
-        .velocity = { -1.01667246,     -2.29026759,       0.72892364 }
-      },
+        printf(TXT_RED"Mismatch!"TXT_NORM"\n");
+        exit(1);
+      }
+    }
+  }
+  printf(TXT_GRN"OK"TXT_NORM"\n");
+}
+
+
+/* Check that predict_orbit_series() matches repeated predict_orbit() calls */
+static void test_series(void)
+{
+  predict_orbital_elements_t elements;
+  struct predict_sgp4 sgp;
+  struct predict_sdp4 sdp;
+  struct predict_position series[10];
+  struct predict_position orbit_position;
+
+  printf("Series propagation..                    ");
+  for(int t = 0; t < 2; t++)
+  {
+    if(!predict_parse_tle(&elements, sample_tles[2*t], sample_tles[2*t+1], &sgp, &sdp))
+    {
+      printf(TXT_RED"Error!"TXT_NORM"\n");
+      exit(1);
+    }
+
+    double start = Julian_Date_of_Epoch((1000.0*elements.epoch_year) + elements.epoch_day);
+    double step = 0.1;
+    if(predict_orbit_series(&elements, start, step, 10, series) != 0)
+    {
+      printf(TXT_RED"Error!"TXT_NORM"\n");
+      exit(1);
+    }
+
+    for(int i = 0; i < 10; i++)
+    {
+      predict_orbit(&elements, &orbit_position, start + i*step);
+      if(memcmp(orbit_position.position, series[i].position, sizeof(orbit_position.position)) != 0
+        || orbit_position.latitude != series[i].latitude || orbit_position.revolutions != series[i].revolutions
+        || orbit_position.eclipse_depth != series[i].eclipse_depth || orbit_position.decayed != series[i].decayed)
       {
-        // 1440
-        .position = { 9787.86975097,  33753.34667969, -15030.81176758 },
-        .velocity = { -1.09425066,      0.92358845,      -1.52230928 }
+        printf(TXT_RED"Mismatch!"TXT_NORM"\n");
+        exit(1);
       }
     }
-  }        
-};
+  }
+  printf(TXT_GRN"OK"TXT_NORM"\n");
+}
 
 
 int main(void)
@@ -232,5 +1595,30 @@ int main(void)
     printf("\n ======================== \n");
   }
 
+  test_batch();
+  test_series();
+  test_resonant();
+  test_fields();
+  test_decay();
+  test_parallel();
+  test_catalog();
+  test_catalog_file();
+  test_tle_decode();
+  test_catalog_binary();
+  test_float();
+  test_chebyshev();
+  test_conjunctions();
+  test_passes();
+  test_passes_observers();
+  test_access_matrix();
+  test_sun();
+  test_moon_right_ascension();
+  test_time_context();
+  test_prepared_observer();
+  test_eclipse_events();
+  test_ephemeris();
+  test_doppler_profile();
+  test_tracker();
+
   return 0;
 }
\ No newline at end of file
@@ -0,0 +1,363 @@
+#include <stddef.h>
+
+#include "predict.h"
+
+predict_julian_date_t orbit_decay_time(const predict_orbital_elements_t *orbital_elements);
+
+//columns of a TLE line, including the checksum
+#define TLE_LINE_LENGTH 69
+
+/**
+ * How the characters of a TLE field are decoded.
+ **/
+enum tle_field_type {
+	///Integer with optional sign, stored as int
+	TLE_FIELD_INT,
+	///Integer with optional sign, stored as long
+	TLE_FIELD_LONG,
+	///Satellite number, five digits or Alpha-5 (letter and four digits), stored as int
+	TLE_FIELD_SATELLITE_NUMBER,
+	///Decimal number with optional sign and decimal point, stored as double
+	TLE_FIELD_DECIMAL,
+	///Digits with a leading decimal point implied, stored as double
+	TLE_FIELD_IMPLIED_DECIMAL,
+	///Sign, five digits with a leading decimal point implied, and a signed power of ten exponent, stored as double
+	TLE_FIELD_EXPONENT,
+	///Text with spaces removed, stored as a terminated string
+	TLE_FIELD_TEXT
+};
+
+/**
+ * Location and type of a field of a TLE line.
+ **/
+struct tle_field_spec {
+	///First column, starting at 1
+	int first;
+	///Last column
+	int last;
+	enum tle_field_type type;
+	enum predict_tle_field field;
+	///Offset of the decoded value in predict_orbital_elements_t
+	size_t offset;
+};
+
+static const struct tle_field_spec tle_line_1_fields[] = {
+	{3, 7, TLE_FIELD_SATELLITE_NUMBER, PREDICT_TLE_FIELD_SATELLITE_NUMBER, offsetof(predict_orbital_elements_t, satellite_number)},
+	{10, 17, TLE_FIELD_TEXT, PREDICT_TLE_FIELD_DESIGNATOR, offsetof(predict_orbital_elements_t, designator)},
+	{19, 20, TLE_FIELD_INT, PREDICT_TLE_FIELD_EPOCH_YEAR, offsetof(predict_orbital_elements_t, epoch_year)},
+	{21, 32, TLE_FIELD_DECIMAL, PREDICT_TLE_FIELD_EPOCH_DAY, offsetof(predict_orbital_elements_t, epoch_day)},
+	{34, 43, TLE_FIELD_DECIMAL, PREDICT_TLE_FIELD_DERIVATIVE_MEAN_MOTION, offsetof(predict_orbital_elements_t, derivative_mean_motion)},
+	{45, 52, TLE_FIELD_EXPONENT, PREDICT_TLE_FIELD_SECOND_DERIVATIVE_MEAN_MOTION, offsetof(predict_orbital_elements_t, second_derivative_mean_motion)},
+	{54, 61, TLE_FIELD_EXPONENT, PREDICT_TLE_FIELD_BSTAR_DRAG_TERM, offsetof(predict_orbital_elements_t, bstar_drag_term)},
+	{65, 68, TLE_FIELD_LONG, PREDICT_TLE_FIELD_ELEMENT_NUMBER, offsetof(predict_orbital_elements_t, element_number)},
+};
+
+static const struct tle_field_spec tle_line_2_fields[] = {
+	{3, 7, TLE_FIELD_SATELLITE_NUMBER, PREDICT_TLE_FIELD_SATELLITE_NUMBER, offsetof(predict_orbital_elements_t, satellite_number)},
+	{9, 16, TLE_FIELD_DECIMAL, PREDICT_TLE_FIELD_INCLINATION, offsetof(predict_orbital_elements_t, inclination)},
+	{18, 25, TLE_FIELD_DECIMAL, PREDICT_TLE_FIELD_RIGHT_ASCENSION, offsetof(predict_orbital_elements_t, right_ascension)},
+	{27, 33, TLE_FIELD_IMPLIED_DECIMAL, PREDICT_TLE_FIELD_ECCENTRICITY, offsetof(predict_orbital_elements_t, eccentricity)},
+	{35, 42, TLE_FIELD_DECIMAL, PREDICT_TLE_FIELD_ARGUMENT_OF_PERIGEE, offsetof(predict_orbital_elements_t, argument_of_perigee)},
+	{44, 51, TLE_FIELD_DECIMAL, PREDICT_TLE_FIELD_MEAN_ANOMALY, offsetof(predict_orbital_elements_t, mean_anomaly)},
+	{53, 63, TLE_FIELD_DECIMAL, PREDICT_TLE_FIELD_MEAN_MOTION, offsetof(predict_orbital_elements_t, mean_motion)},
+	{64, 68, TLE_FIELD_INT, PREDICT_TLE_FIELD_REVOLUTIONS_AT_EPOCH, offsetof(predict_orbital_elements_t, revolutions_at_epoch)},
+};
+
+//powers of ten that are exact in double precision
+static const double tle_powers_of_ten[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+
+/**
+ * Position in a TLE line. Every character is read once, and added to the checksum as it is read.
+ **/
+struct tle_cursor {
+	const char *line;
+	///Column of the next character, starting at 1
+	int column;
+	///Sum of digits, with '-' counting as 1
+	int checksum;
+};
+
+/**
+ * Read the next character of the line and add it to the checksum.
+ *
+ * \return Character, or '\0' at end of line
+ **/
+static char tle_read(struct tle_cursor *cursor)
+{
+	char c = cursor->line[cursor->column - 1];
+	if (c == '\0') {
+		return c;
+	}
+	if ((c >= '0') && (c <= '9')) {
+		cursor->checksum += c - '0';
+	} else if (c == '-') {
+		cursor->checksum += 1;
+	}
+	cursor->column++;
+	return c;
+}
+
+static bool tle_is_digit(char c)
+{
+	return (c >= '0') && (c <= '9');
+}
+
+/**
+ * Read characters up to and including the given column.
+ *
+ * \return false if the line ended before
+ **/
+static bool tle_skip(struct tle_cursor *cursor, int last)
+{
+	while (cursor->column <= last) {
+		if (tle_read(cursor) == '\0') {
+			return false;
+		}
+	}
+	return true;
+}
+
+/**
+ * Decode a number of the form [spaces][sign][digits][.digits][spaces], up to and including the given column.
+ *
+ * \param cursor Cursor at the first column of the field
+ * \param last Last column of the field
+ * \param mantissa Returned digits as integer, with sign
+ * \param decimals Returned number of digits after the decimal point
+ * \param error_column Returned column of an invalid character
+ * \return PREDICT_TLE_OK, PREDICT_TLE_FORMAT_ERROR if the line ended or PREDICT_TLE_FIELD_ERROR
+ **/
+static enum predict_tle_status tle_decode_number(struct tle_cursor *cursor, int last, long long *mantissa, int *decimals, int *error_column)
+{
+	enum {LEADING, SIGN, DIGITS, TRAILING} state = LEADING;
+	bool negative = false;
+	bool point = false;
+	long long value = 0;
+	int num_decimals = 0;
+	int num_digits = 0;
+
+	while (cursor->column <= last) {
+		*error_column = cursor->column;
+		char c = tle_read(cursor);
+		if (c == '\0') {
+			return PREDICT_TLE_FORMAT_ERROR;
+		}
+
+		if (c == ' ') {
+			if (state != LEADING) {
+				state = TRAILING;
+			}
+		} else if (state == TRAILING) {
+			return PREDICT_TLE_FIELD_ERROR;
+		} else if (((c == '-') || (c == '+')) && (state == LEADING)) {
+			negative = (c == '-');
+			state = SIGN;
+		} else if ((c == '.') && !point) {
+			point = true;
+			state = DIGITS;
+		} else if (tle_is_digit(c) && (num_digits < 18)) {
+			value = value*10 + (c - '0');
+			num_digits++;
+			if (point) {
+				num_decimals++;
+			}
+			state = DIGITS;
+		} else {
+			return PREDICT_TLE_FIELD_ERROR;
+		}
+	}
+
+	*mantissa = negative ? -value : value;
+	*decimals = num_decimals;
+	return PREDICT_TLE_OK;
+}
+
+/**
+ * Decode a satellite number, either five digits or an Alpha-5 letter followed by four digits.
+ **/
+static enum predict_tle_status tle_decode_satellite_number(struct tle_cursor *cursor, int last, int *number, int *error_column)
+{
+	*error_column = cursor->column;
+	char c = cursor->line[cursor->column - 1];
+	int alpha = 0;
+	if ((c >= 'A') && (c <= 'Z') && (c != 'I') && (c != 'O')) {
+		//A=10, ..., H=17, J=18, ..., N=22, P=23, ..., Z=33
+		alpha = 10 + (c - 'A') - (c > 'I') - (c > 'O');
+		tle_read(cursor);
+	}
+
+	long long mantissa;
+	int decimals;
+	enum predict_tle_status status = tle_decode_number(cursor, last, &mantissa, &decimals, error_column);
+	if ((status == PREDICT_TLE_OK) && ((decimals > 0) || (mantissa < 0))) {
+		status = PREDICT_TLE_FIELD_ERROR;
+	}
+	*number = alpha*10000 + mantissa;
+	return status;
+}
+
+/**
+ * Decode a number in the form [sign]ddddd[sign]d, meaning [sign]0.ddddd*10^([sign]d).
+ **/
+static enum predict_tle_status tle_decode_exponent(struct tle_cursor *cursor, int last, double *value, int *error_column)
+{
+	long long mantissa;
+	int decimals;
+	enum predict_tle_status status = tle_decode_number(cursor, last - 2, &mantissa, &decimals, error_column);
+	if (status != PREDICT_TLE_OK) {
+		return status;
+	}
+
+	*error_column = cursor->column;
+	char sign = tle_read(cursor);
+	if (sign == '\0') {
+		return PREDICT_TLE_FORMAT_ERROR;
+	}
+	if ((sign != '-') && (sign != '+') && (sign != ' ')) {
+		return PREDICT_TLE_FIELD_ERROR;
+	}
+
+	*error_column = cursor->column;
+	char digit = tle_read(cursor);
+	if (digit == '\0') {
+		return PREDICT_TLE_FORMAT_ERROR;
+	}
+	if (digit == ' ') {
+		digit = '0';
+	}
+	if (!tle_is_digit(digit) || (decimals > 0)) {
+		return PREDICT_TLE_FIELD_ERROR;
+	}
+
+	double scaled = 1.0e-5*mantissa;
+	*value = (sign == '+') ? scaled*tle_powers_of_ten[digit - '0'] : scaled/tle_powers_of_ten[digit - '0'];
+	return PREDICT_TLE_OK;
+}
+
+/**
+ * Decode one TLE line according to its table of fields, and verify its line number and checksum.
+ *
+ * \param elements Output elements
+ * \param line TLE line
+ * \param line_number Expected line number, 1 or 2
+ * \param fields Fields of the line, ordered by column
+ * \param num_fields Number of fields
+ * \param error Returned location of an error
+ * \return Status
+ **/
+static enum predict_tle_status tle_decode_line(predict_orbital_elements_t *elements, const char *line, int line_number, const struct tle_field_spec *fields, size_t num_fields, struct predict_tle_error *error)
+{
+	struct tle_cursor cursor = {line, 1, 0};
+	error->tle_line = line_number;
+	error->column = 1;
+
+	error->field = PREDICT_TLE_FIELD_LINE_NUMBER;
+	char number = tle_read(&cursor);
+	if (number != '0' + line_number) {
+		return PREDICT_TLE_FORMAT_ERROR;
+	}
+
+	for (size_t i=0; i < num_fields; i++) {
+		const struct tle_field_spec *spec = &fields[i];
+		unsigned char *destination = (unsigned char*)elements + spec->offset;
+		error->field = spec->field;
+
+		if (!tle_skip(&cursor, spec->first - 1)) {
+			error->column = cursor.column;
+			return PREDICT_TLE_FORMAT_ERROR;
+		}
+
+		enum predict_tle_status status = PREDICT_TLE_OK;
+		long long mantissa = 0;
+		int decimals = 0;
+		switch (spec->type) {
+			case TLE_FIELD_INT:
+			case TLE_FIELD_LONG:
+			case TLE_FIELD_DECIMAL:
+			case TLE_FIELD_IMPLIED_DECIMAL:
+				status = tle_decode_number(&cursor, spec->last, &mantissa, &decimals, &error->column);
+				if ((status == PREDICT_TLE_OK) && (spec->type != TLE_FIELD_DECIMAL) && (decimals > 0)) {
+					status = PREDICT_TLE_FIELD_ERROR;
+				}
+				if (status != PREDICT_TLE_OK) {
+					break;
+				}
+
+				if (spec->type == TLE_FIELD_INT) {
+					*(int*)destination = mantissa;
+				} else if (spec->type == TLE_FIELD_LONG) {
+					*(long*)destination = mantissa;
+				} else if (spec->type == TLE_FIELD_DECIMAL) {
+					//exact integer over exact power of ten gives the correctly rounded value
+					*(double*)destination = mantissa/tle_powers_of_ten[decimals];
+				} else {
+					*(double*)destination = mantissa*(1.0/tle_powers_of_ten[spec->last - spec->first + 1]);
+				}
+				break;
+			case TLE_FIELD_SATELLITE_NUMBER:
+				status = tle_decode_satellite_number(&cursor, spec->last, (int*)destination, &error->column);
+				break;
+			case TLE_FIELD_EXPONENT:
+				status = tle_decode_exponent(&cursor, spec->last, (double*)destination, &error->column);
+				break;
+			case TLE_FIELD_TEXT: {
+				char *text = (char*)destination;
+				int length = 0;
+				while (cursor.column <= spec->last) {
+					error->column = cursor.column;
+					char c = tle_read(&cursor);
+					if (c == '\0') {
+						status = PREDICT_TLE_FORMAT_ERROR;
+						break;
+					}
+					if (c != ' ') {
+						text[length++] = c;
+					}
+				}
+				text[length] = '\0';
+				break;
+			}
+		}
+		if (status != PREDICT_TLE_OK) {
+			return status;
+		}
+	}
+
+	error->field = PREDICT_TLE_FIELD_CHECKSUM;
+	if (!tle_skip(&cursor, TLE_LINE_LENGTH - 1)) {
+		error->column = cursor.column;
+		return PREDICT_TLE_FORMAT_ERROR;
+	}
+	error->column = TLE_LINE_LENGTH;
+	char checksum = line[TLE_LINE_LENGTH - 1];
+	if (checksum == '\0') {
+		return PREDICT_TLE_FORMAT_ERROR;
+	}
+	if (checksum != '0' + cursor.checksum % 10) {
+		return PREDICT_TLE_CHECKSUM_ERROR;
+	}
+	return PREDICT_TLE_OK;
+}
+
+enum predict_tle_status predict_tle_decode(predict_orbital_elements_t *elements, const char *tle_line_1, const char *tle_line_2, struct predict_tle_error *error)
+{
+	struct predict_tle_error local_error;
+	if (error == NULL) {
+		error = &local_error;
+	}
+	error->line = 0;
+
+	enum predict_tle_status status = tle_decode_line(elements, tle_line_1, 1, tle_line_1_fields, sizeof(tle_line_1_fields)/sizeof(tle_line_1_fields[0]), error);
+	if (status == PREDICT_TLE_OK) {
+		status = tle_decode_line(elements, tle_line_2, 2, tle_line_2_fields, sizeof(tle_line_2_fields)/sizeof(tle_line_2_fields[0]), error);
+	}
+
+	error->status = status;
+	if (status == PREDICT_TLE_OK) {
+		elements->decay_time = orbit_decay_time(elements);
+		error->tle_line = 0;
+		error->column = 0;
+		error->field = PREDICT_TLE_FIELD_NONE;
+	}
+	return status;
+}
@@ -0,0 +1,213 @@
+#include <errno.h>
+#include <math.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+
+#include "predict.h"
+#include "unsorted.h"
+#include "defs.h"
+
+//size of a cache line, to keep the indices of the producer and the consumer apart
+#define TRACKER_CACHE_LINE 64
+
+//longest gap between two observations that are interpolated between, in time steps
+#define TRACKER_MAX_GAP 1.5
+
+/**
+ * Ring of observations shared by the producer thread and the consumer.
+ * The producer writes at head and the consumer reads from tail; each index
+ * is only written by its own side. When the ring is full, the producer sets
+ * waiting and sleeps on the semaphore, which is posted by whichever of the
+ * consumer and predict_destroy_tracker() clears waiting first, so that
+ * neither of them takes a lock.
+ **/
+struct tracker_state {
+	///Number of observations written by the producer
+	_Alignas(TRACKER_CACHE_LINE) _Atomic size_t head;
+	///Number of observations released by the consumer
+	_Alignas(TRACKER_CACHE_LINE) _Atomic size_t tail;
+	///Latest time asked for by the consumer, for the producer to catch up with
+	_Alignas(TRACKER_CACHE_LINE) _Atomic double requested_time;
+	///Set by predict_destroy_tracker() to stop the producer
+	_Atomic bool stop;
+	///Set by the producer while it waits for the consumer, cleared by the side that posts wakeup
+	_Atomic bool waiting;
+	sem_t wakeup;
+
+	struct predict_observation *observations;
+	size_t capacity;
+	const predict_orbital_elements_t *orbital_elements;
+	predict_prepared_observer_t observer;
+	predict_julian_date_t start_time;
+	///Time step in days
+	double time_step;
+	pthread_t thread;
+};
+
+/**
+ * Wake the producer if it waits for room in the ring or for stop. Lock-free,
+ * as sem_post() is.
+ *
+ * \param state Tracker state
+ **/
+static void tracker_wake(struct tracker_state *state)
+{
+	if (atomic_exchange(&state->waiting, false)) {
+		sem_post(&state->wakeup);
+	}
+}
+
+/**
+ * Producer thread: observe the satellite at the time steps from the start
+ * time and keep the ring full. Stops when the orbit cannot be predicted.
+ *
+ * \param arg Tracker state
+ * \return NULL
+ **/
+static void *tracker_produce(void *arg)
+{
+	struct tracker_state *state = (struct tracker_state*)arg;
+	struct predict_sdp4_resonance resonance = {0};
+	size_t head = 0;
+	double step = 0.0;
+
+	while (!atomic_load_explicit(&state->stop, memory_order_relaxed)) {
+		//skip ahead when the consumer has got ahead of the ring, rather than observe times it has passed
+		double requested_time = atomic_load_explicit(&state->requested_time, memory_order_relaxed);
+		double requested_step = floor((requested_time - state->start_time)/state->time_step);
+		if (requested_step > step) {
+			step = requested_step;
+		}
+
+		size_t tail = atomic_load_explicit(&state->tail, memory_order_acquire);
+		if (head - tail >= state->capacity) {
+			//announce the wait before checking again, so that a release or stop after the check posts the semaphore.
+			//when there is room after all but another side has already cleared waiting, take its post
+			atomic_store(&state->waiting, true);
+			bool ready = (head - atomic_load(&state->tail) < state->capacity) || atomic_load(&state->stop);
+			if (!ready || !atomic_exchange(&state->waiting, false)) {
+				while ((sem_wait(&state->wakeup) != 0) && (errno == EINTR)) {
+				}
+			}
+			continue;
+		}
+
+		struct predict_position orbit;
+		struct predict_observation *obs = &state->observations[head % state->capacity];
+		if (predict_orbit_resonant(state->orbital_elements, &resonance, &orbit, state->start_time + step*state->time_step) != 0) {
+			break;
+		}
+		predict_observe_orbit_prepared(&state->observer, &orbit, NULL, obs);
+		atomic_store_explicit(&state->head, ++head, memory_order_release);
+		step += 1.0;
+	}
+	return NULL;
+}
+
+bool predict_create_tracker(predict_tracker_t *tracker, const predict_observer_t *observer, const predict_orbital_elements_t *orbital_elements, predict_julian_date_t start_time, double time_step, double lookahead)
+{
+	tracker->state = NULL;
+	tracker->time_step = time_step;
+	tracker->capacity = 0;
+	if (!(time_step > 0.0) || !(lookahead >= 0.0)) {
+		return false;
+	}
+
+	struct tracker_state *state = aligned_alloc(TRACKER_CACHE_LINE, sizeof(struct tracker_state));
+	//one more than the lookahead, for the observation before the current time
+	size_t capacity = (size_t)ceil(lookahead/time_step) + 2;
+	struct predict_observation *observations = malloc(capacity*sizeof(struct predict_observation));
+	if ((state == NULL) || (observations == NULL)) {
+		free(state);
+		free(observations);
+		return false;
+	}
+
+	atomic_init(&state->head, 0);
+	atomic_init(&state->tail, 0);
+	atomic_init(&state->requested_time, start_time);
+	atomic_init(&state->stop, false);
+	atomic_init(&state->waiting, false);
+	state->observations = observations;
+	state->capacity = capacity;
+	state->orbital_elements = orbital_elements;
+	predict_prepare_observer(&state->observer, observer);
+	state->start_time = start_time;
+	state->time_step = time_step/SECONDS_PER_DAY;
+	if (sem_init(&state->wakeup, 0, 0) != 0) {
+		free(state);
+		free(observations);
+		return false;
+	}
+	if (pthread_create(&state->thread, NULL, tracker_produce, state) != 0) {
+		sem_destroy(&state->wakeup);
+		free(state);
+		free(observations);
+		return false;
+	}
+
+	tracker->state = state;
+	tracker->capacity = capacity;
+	return true;
+}
+
+int predict_tracker_observe(predict_tracker_t *tracker, predict_julian_date_t time, struct predict_observation *obs)
+{
+	struct tracker_state *state = tracker->state;
+	atomic_store_explicit(&state->requested_time, time, memory_order_relaxed);
+
+	//release the observations before the one preceding the time
+	size_t head = atomic_load_explicit(&state->head, memory_order_acquire);
+	size_t released = atomic_load_explicit(&state->tail, memory_order_relaxed);
+	size_t tail = released;
+	while ((tail + 1 < head) && (state->observations[(tail + 1) % state->capacity].time <= time)) {
+		tail++;
+	}
+	if (tail != released) {
+		atomic_store(&state->tail, tail);
+		tracker_wake(state);
+	}
+	if (tail + 1 >= head) {
+		return -1;
+	}
+
+	const struct predict_observation *lower = &state->observations[tail % state->capacity];
+	const struct predict_observation *upper = &state->observations[(tail + 1) % state->capacity];
+	double h = (upper->time - lower->time)*SECONDS_PER_DAY;
+	if ((time < lower->time) || (h > TRACKER_MAX_GAP*tracker->time_step)) {
+		return -1;
+	}
+
+	//azimuth continued across north, in the direction it turns
+	double s = (time - lower->time)*SECONDS_PER_DAY/h;
+	double upper_azimuth = lower->azimuth + remainder(upper->azimuth - lower->azimuth, 2.0*M_PI);
+	double azimuth = hermite_interpolate(s, h, lower->azimuth, lower->azimuth_rate, upper_azimuth, upper->azimuth_rate, &obs->azimuth_rate);
+	obs->azimuth = azimuth - 2.0*M_PI*floor(azimuth/(2.0*M_PI));
+	obs->elevation = hermite_interpolate(s, h, lower->elevation, lower->elevation_rate, upper->elevation, upper->elevation_rate, &obs->elevation_rate);
+	double range_rate;
+	obs->range = hermite_interpolate(s, h, lower->range, lower->range_rate, upper->range, upper->range_rate, &range_rate);
+	obs->range_rate = range_rate;
+	obs->range_x = lower->range_x + s*(upper->range_x - lower->range_x);
+	obs->range_y = lower->range_y + s*(upper->range_y - lower->range_y);
+	obs->range_z = lower->range_z + s*(upper->range_z - lower->range_z);
+	obs->visible = (s < 0.5) ? lower->visible : upper->visible;
+	obs->time = time;
+	return 0;
+}
+
+void predict_destroy_tracker(predict_tracker_t *tracker)
+{
+	struct tracker_state *state = tracker->state;
+	if (state == NULL) {
+		return;
+	}
+	atomic_store(&state->stop, true);
+	tracker_wake(state);
+	pthread_join(state->thread, NULL);
+	sem_destroy(&state->wakeup);
+	free(state->observations);
+	free(state);
+	tracker->state = NULL;
+}
@@ -1,5 +1,7 @@
 #include "unsorted.h"
 
+#include <float.h>
+
 #include "defs.h"
 
 void vec3_set(double v[3], double x, double y, double z)
@@ -125,10 +127,10 @@ double ThetaG_JD(double jd)
 	return (2*M_PI*GMST/SECONDS_PER_DAY);
 }
 
-void Calculate_User_PosVel(double time, geodetic_t *geodetic, double obs_pos[3], double obs_vel[3])
+void Calculate_User_PosVel_gmst(double gmst, geodetic_t *geodetic, double obs_pos[3], double obs_vel[3])
 {
-	/* Calculate_User_PosVel() passes the user's geodetic position
-	   and the time of interest and returns the ECI position and
+	/* Calculate_User_PosVel_gmst() passes the user's geodetic position
+	   and the sidereal time of interest and returns the ECI position and
 	   velocity of the observer.  The velocity calculation assumes
 	   the geodetic position is stationary relative to the earth's
 	   surface. */
@@ -137,7 +139,7 @@ void Calculate_User_PosVel(double time, geodetic_t *geodetic, double obs_pos[3],
 
 	double c, sq, achcp;
 
-	geodetic->theta=FMod2p(ThetaG_JD(time)+geodetic->lon); /* LMST */
+	geodetic->theta=FMod2p(gmst+geodetic->lon); /* LMST */
 	c=1/sqrt(1+FLATTENING_FACTOR*(FLATTENING_FACTOR-2)*Sqr(sin(geodetic->lat)));
 	sq=Sqr(1-FLATTENING_FACTOR)*c;
 	achcp=(EARTH_RADIUS_KM_WGS84*c+geodetic->alt)*cos(geodetic->lat);
@@ -149,6 +151,11 @@ void Calculate_User_PosVel(double time, geodetic_t *geodetic, double obs_pos[3],
 	obs_vel[2] = (0);
 }
 
+void Calculate_User_PosVel(double time, geodetic_t *geodetic, double obs_pos[3], double obs_vel[3])
+{
+	Calculate_User_PosVel_gmst(ThetaG_JD(time), geodetic, obs_pos, obs_vel);
+}
+
 long DayNum(int m, int d, int y)
 {
 
@@ -171,10 +178,11 @@ long DayNum(int m, int d, int y)
 }
 
 
-void Calculate_LatLonAlt(predict_julian_date_t time, const double pos[3],  geodetic_t *geodetic)
+void Calculate_LatLonAlt_gmst(double gmst, const double pos[3],  geodetic_t *geodetic)
 {
-	/* Procedure Calculate_LatLonAlt will calculate the geodetic  */
-	/* position of an object given its ECI position pos and time. */
+	/* Procedure Calculate_LatLonAlt_gmst will calculate the geodetic  */
+	/* position of an object given its ECI position pos and the    */
+	/* Greenwich mean sidereal time gmst, from ThetaG_JD().       */
 	/* It is intended to be used to determine the ground track of */
 	/* a satellite.  The calculations  assume the earth to be an  */
 	/* oblate spheroid as defined in WGS '72.                     */
@@ -184,7 +192,7 @@ void Calculate_LatLonAlt(predict_julian_date_t time, const double pos[3],  geode
 	double r, e2, phi, c;
 
 	geodetic->theta = atan2(pos[1], pos[0]); /* radians */
-	geodetic->lon = FMod2p(geodetic->theta-ThetaG_JD(time)); /* radians */
+	geodetic->lon = FMod2p(geodetic->theta-gmst); /* radians */
 	r = sqrt(Sqr(pos[0])+Sqr(pos[1]));
 	e2 = FLATTENING_FACTOR*(2-FLATTENING_FACTOR);
 	geodetic->lat=atan2(pos[2],r); /* radians */
@@ -203,11 +211,17 @@ void Calculate_LatLonAlt(predict_julian_date_t time, const double pos[3],  geode
 		geodetic->lat-= 2*M_PI;
 }
 
-void Calculate_Obs(double time, const double pos[3], const double vel[3], geodetic_t *geodetic, vector_t *obs_set)
+void Calculate_LatLonAlt(double time, const double pos[3],  geodetic_t *geodetic)
+{
+	Calculate_LatLonAlt_gmst(ThetaG_JD(time), pos, geodetic);
+}
+
+void Calculate_Obs_gmst(double gmst, const double pos[3], const double vel[3], geodetic_t *geodetic, vector_t *obs_set)
 {
-	/* The procedures Calculate_Obs and Calculate_RADec calculate         */
-	/* the *topocentric* coordinates of the object with ECI position,     */
-	/* {pos}, and velocity, {vel}, from location {geodetic} at {time}.    */
+	/* The procedures Calculate_Obs_gmst and Calculate_RADec_gmst         */
+	/* calculate the *topocentric* coordinates of the object with ECI     */
+	/* position, {pos}, and velocity, {vel}, from location {geodetic} at  */
+	/* Greenwich mean sidereal time {gmst}.                               */
 	/* The {obs_set} returned for Calculate_Obs consists of azimuth,      */
 	/* elevation, range, and range rate (in that order) with units of     */
 	/* radians, radians, kilometers, and kilometers/second, respectively. */
@@ -228,7 +242,7 @@ void Calculate_Obs(double time, const double pos[3], const double vel[3], geodet
 	double range[3];
 	double rgvel[3];
 
-	Calculate_User_PosVel(time, geodetic, obs_pos, obs_vel);
+	Calculate_User_PosVel_gmst(gmst, geodetic, obs_pos, obs_vel);
 
 	vec3_sub(pos, obs_pos, range);
 	vec3_sub(vel, obs_vel, rgvel);
@@ -265,7 +279,12 @@ void Calculate_Obs(double time, const double pos[3], const double vel[3], geodet
 		obs_set->y=el;  /* Reset to true elevation */
 }
 
-void Calculate_RADec(double time, const double pos[3], const double vel[3], geodetic_t *geodetic, vector_t *obs_set)
+void Calculate_Obs(double time, const double pos[3], const double vel[3], geodetic_t *geodetic, vector_t *obs_set)
+{
+	Calculate_Obs_gmst(ThetaG_JD(time), pos, vel, geodetic, obs_set);
+}
+
+void Calculate_RADec_gmst(double gmst, const double pos[3], const double vel[3], geodetic_t *geodetic, vector_t *obs_set)
 {
 	/* Reference:  Methods of Orbit Determination by  */
 	/*             Pedro Ramon Escobal, pp. 401-402   */
@@ -274,12 +293,12 @@ void Calculate_RADec(double time, const double pos[3], const double vel[3], geod
 	Lxh, Lyh, Lzh, Sx, Ex, Zx, Sy, Ey, Zy, Sz, Ez, Zz, Lx, Ly,
 	Lz, cos_delta, sin_alpha, cos_alpha;
 
-	Calculate_Obs(time,pos,vel,geodetic,obs_set);
+	Calculate_Obs_gmst(gmst,pos,vel,geodetic,obs_set);
 
 	az=obs_set->x;
 	el=obs_set->y;
 	phi=geodetic->lat;
-	theta=FMod2p(ThetaG_JD(time)+geodetic->lon);
+	theta=FMod2p(gmst+geodetic->lon);
 	sin_theta=sin(theta);
 	cos_theta=cos(theta);
 	sin_phi=sin(phi);
@@ -307,6 +326,11 @@ void Calculate_RADec(double time, const double pos[3], const double vel[3], geod
 	obs_set->x=FMod2p(obs_set->x);
 }
 
+void Calculate_RADec(double time, const double pos[3], const double vel[3], geodetic_t *geodetic, vector_t *obs_set)
+{
+	Calculate_RADec_gmst(ThetaG_JD(time), pos, vel, geodetic, obs_set);
+}
+
 /* .... SGP4/SDP4 functions end .... */
 
 char *SubString(const char *string, int buffer_length, char *output_buffer, int start, int end)
@@ -351,4 +375,89 @@ double Sidereal_from_Julian(double jul_time)
 
 	// Modulus 2*Pi
 	return FMod2p(t);
-}
\ No newline at end of file
+}
+
+double brent_root(brent_func func, void *context, double lower, double upper, double f_lower, double f_upper, double tolerance)
+{
+	//b is the best estimate, a the previous one and c the other end of the bracket [b, c]
+	double a = lower, b = upper, c = lower;
+	double fa = f_lower, fb = f_upper, fc = f_lower;
+	double d = b - a, e = d;
+
+	for (int iteration=0; iteration < 100; iteration++) {
+		if ((fb > 0.0) == (fc > 0.0)) {
+			c = a;
+			fc = fa;
+			d = b - a;
+			e = d;
+		}
+		if (fabs(fc) < fabs(fb)) {
+			a = b;
+			b = c;
+			c = a;
+			fa = fb;
+			fb = fc;
+			fc = fa;
+		}
+
+		double tol = 2.0*DBL_EPSILON*fabs(b) + 0.5*tolerance;
+		double m = 0.5*(c - b);
+		if ((fabs(m) <= tol) || (fb == 0.0)) {
+			return b;
+		}
+
+		if ((fabs(e) >= tol) && (fabs(fa) > fabs(fb))) {
+			double p, q, r;
+			double s = fb/fa;
+			if (a == c) {
+				//secant
+				p = 2.0*m*s;
+				q = 1.0 - s;
+			} else {
+				//inverse quadratic interpolation
+				q = fa/fc;
+				r = fb/fc;
+				p = s*(2.0*m*q*(q - r) - (b - a)*(r - 1.0));
+				q = (q - 1.0)*(r - 1.0)*(s - 1.0);
+			}
+			if (p > 0.0) {
+				q = -q;
+			} else {
+				p = -p;
+			}
+
+			//accept the interpolation only if it falls well within the bracket and converges faster than bisection
+			if ((2.0*p < 3.0*m*q - fabs(tol*q)) && (p < fabs(0.5*e*q))) {
+				e = d;
+				d = p/q;
+			} else {
+				d = m;
+				e = m;
+			}
+		} else {
+			d = m;
+			e = m;
+		}
+
+		a = b;
+		fa = fb;
+		b += (fabs(d) > tol) ? d : ((m > 0.0) ? tol : -tol);
+		fb = func(b, context);
+	}
+	return b;
+}
+
+double perigee_radius_bound(const predict_orbital_elements_t *orbital_elements)
+{
+	return fmax(predict_perigee(orbital_elements) + EARTH_RADIUS_KM_WGS84 - PERIGEE_RADIUS_MARGIN, PERIGEE_RADIUS_MIN);
+}
+
+double hermite_interpolate(double s, double h, double p0, double m0, double p1, double m1, double *derivative)
+{
+	m0 *= h;
+	m1 *= h;
+	if (derivative != NULL) {
+		*derivative = ((6.0*s*s - 6.0*s)*(p0 - p1) + (3.0*s*s - 4.0*s + 1.0)*m0 + (3.0*s*s - 2.0*s)*m1)/h;
+	}
+	return ((2.0*s - 3.0)*s*s + 1.0)*p0 + ((s - 2.0)*s + 1.0)*s*m0 + (3.0 - 2.0*s)*s*s*p1 + (s - 1.0)*s*s*m1;
+}
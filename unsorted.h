@@ -142,6 +142,13 @@ long DayNum(int month, int day, int year);
  **/
 void Calculate_LatLonAlt(double time, const double pos[3], geodetic_t *geodetic);
 
+/**
+ * As Calculate_LatLonAlt(), at Greenwich mean sidereal time gmst, from ThetaG_JD(), instead of a Julian date.
+ *
+ * \copyright GPLv2+
+ **/
+void Calculate_LatLonAlt_gmst(double gmst, const double pos[3], geodetic_t *geodetic);
+
 /**
  * The procedures Calculate_Obs and Calculate_RADec calculate
  * the *topocentric* coordinates of the object with ECI position,
@@ -162,6 +169,13 @@ void Calculate_LatLonAlt(double time, const double pos[3], geodetic_t *geodetic)
  **/
 void Calculate_Obs(double time,  const double pos[3], const double vel[3], geodetic_t *geodetic, vector_t *obs_set);
 
+/**
+ * As Calculate_Obs(), at Greenwich mean sidereal time gmst, from ThetaG_JD(), instead of a Julian date.
+ *
+ * \copyright GPLv2+
+ **/
+void Calculate_Obs_gmst(double gmst,  const double pos[3], const double vel[3], geodetic_t *geodetic, vector_t *obs_set);
+
 /**
  * Reference:  Methods of Orbit Determination by Pedro Ramon Escobal, pp. 401-402
  *
@@ -170,11 +184,26 @@ void Calculate_Obs(double time,  const double pos[3], const double vel[3], geode
 void Calculate_RADec(double time, const double pos[3], const double vel[3], geodetic_t *geodetic, vector_t *obs_set);
 
 /**
+ * As Calculate_RADec(), at Greenwich mean sidereal time gmst, from ThetaG_JD(), instead of a Julian date.
+ *
+ * \copyright GPLv2+
+ **/
+void Calculate_RADec_gmst(double gmst, const double pos[3], const double vel[3], geodetic_t *geodetic, vector_t *obs_set);
+
+/**
+ * ECI position and velocity of an observer fixed on the surface of the Earth, at Julian date time.
  *
  * \copyright GPLv2+
  **/
 void Calculate_User_PosVel(double time, geodetic_t *geodetic, double obs_pos[3], double obs_vel[3]);
 
+/**
+ * As Calculate_User_PosVel(), at Greenwich mean sidereal time gmst, from ThetaG_JD(), instead of a Julian date.
+ *
+ * \copyright GPLv2+
+ **/
+void Calculate_User_PosVel_gmst(double gmst, geodetic_t *geodetic, double obs_pos[3], double obs_vel[3]);
+
 /**
  * Modified version of acos, where arguments above 1 or below -1 yield acos(-1 or +1).
  * Used for guarding against floating point inaccuracies.
@@ -202,4 +231,54 @@ double asin_(double arg);
  **/
 double Sidereal_from_Julian(double jul_time);
 
+/**
+ * Function of one variable, for brent_root().
+ *
+ * \param x Variable
+ * \param context Context passed to brent_root()
+ * \return Function value
+ **/
+typedef double (*brent_func)(double x, void *context);
+
+/**
+ * Find a root of a function within an interval where it changes sign, using
+ * Brent's method. Takes inverse quadratic interpolation or secant steps where
+ * they converge, and falls back to bisection where they do not, so it never
+ * needs more evaluations than bisection by more than a small factor.
+ *
+ * \param func Function
+ * \param context Passed to func
+ * \param lower Lower end of the interval
+ * \param upper Upper end of the interval
+ * \param f_lower Function value at the lower end
+ * \param f_upper Function value at the upper end, of opposite sign to f_lower or zero
+ * \param tolerance Absolute tolerance in x
+ * \return Root
+ **/
+double brent_root(brent_func func, void *context, double lower, double upper, double f_lower, double f_upper, double tolerance);
+
+/**
+ * Lower bound on the distance of a satellite from the centre of the earth: its
+ * perigee less a margin for the short-periodic terms of the models, kept clear
+ * of the surface so that speed bounds taken at this radius stay finite.
+ *
+ * \param orbital_elements Orbital elements of satellite
+ * \return Radius in km
+ **/
+double perigee_radius_bound(const predict_orbital_elements_t *orbital_elements);
+
+/**
+ * Cubic Hermite interpolation between two values with their derivatives.
+ *
+ * \param s Position between the values, 0 to 1
+ * \param h Length of the interval, in the unit the derivatives are per
+ * \param p0 Value at s = 0
+ * \param m0 Derivative at s = 0
+ * \param p1 Value at s = 1
+ * \param m1 Derivative at s = 1
+ * \param derivative Returned derivative of the interpolant. May be NULL
+ * \return Interpolated value
+ **/
+double hermite_interpolate(double s, double h, double p0, double m0, double p1, double m1, double *derivative);
+
 #endif